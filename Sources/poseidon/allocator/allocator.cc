@@ -2,8 +2,34 @@
 #include "poseidon/allocator/allocator.h"
 
 namespace poseidon{
+ class LocalAllocationBufferReleaser{
+  public:
+   LocalAllocationBufferReleaser() = default;
+   ~LocalAllocationBufferReleaser(){
+     Allocator::ReleaseLocalAllocationBuffer();
+   }
+ };
+
+ // releases the thread's buffer when the thread exits, only touched on the slow path.
+ static thread_local LocalAllocationBufferReleaser releaser;
+
  void Allocator::Initialize(){
    Heap::Initialize();
    LocalPage::Initialize();
  }
+
+ void Allocator::ReleaseLocalAllocationBuffer(){
+   if(tlab_.HasOwner())
+     tlab_.owner()->Release(&tlab_);
+ }
+
+ uword Allocator::AllocateSlow(int64_t size){
+   auto heap = Heap::GetCurrentThreadHeap();
+   PSDN_ASSERT(heap != nullptr);
+   if(!HasLocalAllocationBuffers())
+     return heap->TryAllocate(size);
+
+   (void)&releaser;
+   return heap->TryAllocate(&tlab_, size);
+ }
 }
\ No newline at end of file
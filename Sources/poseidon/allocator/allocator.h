@@ -4,10 +4,35 @@
 #include <glog/logging.h>
 
 #include "poseidon/heap/heap.h"
+#include "poseidon/collector/marker.h"
 
 namespace poseidon{
  class Allocator{
    friend class Scavenger;
+  private:
+   // the calling thread's buffer, constant-initialized so the fast path needs no thread-local guard.
+   static inline thread_local LocalAllocationBuffer tlab_;
+
+   static uword AllocateSlow(int64_t size);
+
+   // tags ptr w/ the ClassId of T so the collectors can trace its references, a no-op for types w/o references.
+   template<typename T>
+   static inline void
+   SetTypeOf(RawObject* ptr, bool clear){
+     auto type = TypeDescriptor::Of<T>();
+     if(type == nullptr)
+       return;
+     for(auto idx = 0; idx < type->GetNumberOfPointers(); idx++){
+       auto slot = (uword*)(ptr->GetObjectPointerAddress() + type->GetPointerOffset(idx));
+       if(clear){
+         (*slot) = 0;
+       } else if(!ptr->IsNew()){
+         // the copied fields of an object allocated straight into the old zone didn't go through the barrier.
+         Heap::GetCurrentThreadHeap()->RecordWrite(slot, *slot);
+       }
+     }
+     ptr->SetClassId(type->GetClassId());
+   }
   public:
    Allocator() = delete;
    Allocator(const Allocator& rhs) = delete;
@@ -15,11 +40,20 @@ namespace poseidon{
 
    static void Initialize();
 
+   /**
+    * Retires the calling thread's {@link LocalAllocationBuffer} & releases it from the {@link NewZone} it was carved from.
+    */
+   static void ReleaseLocalAllocationBuffer();
+
    static inline uword
    Allocate(int64_t size){
-     auto heap = Heap::GetCurrentThreadHeap();
-     PSDN_ASSERT(heap != nullptr);
-     return heap->TryAllocate(size);
+     if(size < kWordSize)
+       size = kWordSize;
+
+     uword address;
+     if((address = tlab_.TryAllocate(size)) != 0)
+       return address;
+     return AllocateSlow(size);
    }
 
    static inline void*
@@ -32,16 +66,35 @@ namespace poseidon{
    static inline T*
    New(){
      auto ptr = (RawObject*)Allocate(static_cast<int64_t>(sizeof(T)));
-     return ptr != nullptr ? (T*)ptr->GetPointer() : nullptr;
+     if(ptr == nullptr)
+       return nullptr;
+     SetTypeOf<T>(ptr, true);
+     return (T*)ptr->GetPointer();
    }
 
    template<typename T>
    static inline T*
    New(const T& value){
      auto ptr = (RawObject*)Allocate(static_cast<int64_t>(sizeof(T)));
-     if(ptr != nullptr)
-       *((T*)ptr->GetPointer()) = value;
-     return ptr != nullptr ? (T*)ptr->GetPointer() : nullptr;
+     if(ptr == nullptr)
+       return nullptr;
+     *((T*)ptr->GetPointer()) = value;
+     SetTypeOf<T>(ptr, false);
+     return (T*)ptr->GetPointer();
+   }
+
+   /**
+    * Stores value, a pointer returned by {@link New()}, into the reference field slot of a managed object.
+    *
+    * Reference fields of managed objects have to be written through here, otherwise the scavenger misses the
+    * references from old objects to new ones & a concurrent mark misses the objects the mutator moved around.
+    */
+   static inline void
+   StorePointer(uword* slot, uword value){
+     if(Marker::IsMarkingConcurrently())
+       Marker::RecordOverwrite(*slot);
+     (*slot) = value;
+     Heap::GetCurrentThreadHeap()->RecordWrite(slot, value);
    }
 
    Allocator& operator=(const Allocator& rhs) = delete;
@@ -62,7 +62,9 @@ namespace poseidon{
        CopyFrom(rhs);
      }
    }
-   ~BitSet() = default;
+   ~BitSet(){
+     free(words_);
+   }
 
    void Set(int64_t idx, bool val){
      PSDN_ASSERT(idx >= 0);
@@ -75,6 +77,28 @@ namespace poseidon{
      }
    }
 
+   /**
+    * Sets the bit at idx, several threads can set the bits of the same word.
+    */
+   void AtomicSet(int64_t idx){
+     PSDN_ASSERT(idx >= 0);
+     PSDN_ASSERT(idx < GetLengthInBits(size()));
+     uword mask = (static_cast<uword>(1) << (idx & (kBitsPerWord - 1)));
+     __atomic_fetch_or(&words_[idx >> kBitsPerWordLog2], mask, __ATOMIC_RELAXED);
+   }
+
+   /**
+    * Sets the bit at idx like {@link AtomicSet()}, telling the threads racing to set it apart.
+    *
+    * @return true if the bit was set by this call, false if it was already set
+    */
+   bool TryAtomicSet(int64_t idx){
+     PSDN_ASSERT(idx >= 0);
+     PSDN_ASSERT(idx < GetLengthInBits(size()));
+     uword mask = (static_cast<uword>(1) << (idx & (kBitsPerWord - 1)));
+     return (__atomic_fetch_or(&words_[idx >> kBitsPerWordLog2], mask, __ATOMIC_RELAXED) & mask) == 0;
+   }
+
    bool Test(int64_t idx) const{
      PSDN_ASSERT(idx >= 0);
      PSDN_ASSERT(idx <= GetLengthInBits(size()));
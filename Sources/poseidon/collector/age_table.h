@@ -0,0 +1,91 @@
+#ifndef POSEIDON_AGE_TABLE_H
+#define POSEIDON_AGE_TABLE_H
+
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/relaxed_atomic.h"
+
+namespace poseidon{
+ /**
+  * The number of bytes that survived a scavenge per age, the age of a survivor counts the scavenges it survived
+  * including the last one.
+  *
+  * Filled by the scavenger while it copies, so the workers add to it concurrently.
+  */
+ class AgeTable{
+   friend class AgeTableTest;
+  public:
+   static constexpr const int64_t kTableSize = ObjectTag::kMaxAge + 1;
+  private:
+   RelaxedAtomic<int64_t> sizes_[kTableSize];
+  public:
+   AgeTable():
+    sizes_(){
+   }
+   AgeTable(const AgeTable& rhs) = delete;
+   ~AgeTable() = default;
+
+   int64_t GetSize(int64_t age) const{
+     return (int64_t)sizes_[age];
+   }
+
+   int64_t GetTotalSize() const{
+     int64_t total = 0;
+     for(auto age = 0; age < kTableSize; age++)
+       total += GetSize(age);
+     return total;
+   }
+
+   void Add(int64_t age, int64_t size){
+     sizes_[age] += size;
+   }
+
+   void Clear(){
+     for(auto& size : sizes_)
+       size = 0;
+   }
+
+   /**
+    * Computes the age objects get promoted at, so the survivors younger than it fit into desired bytes.
+    *
+    * Adds up the survivors starting w/ the youngest, the first age at which the total exceeds desired becomes the
+    * threshold. The survivors that are older get promoted by the next scavenge, which makes room for the younger
+    * ones in the semispace.
+    *
+    * @param desired The number of bytes the survivors should fill
+    * @param max The max threshold
+    * @return The tenuring threshold, at most max
+    */
+   int64_t ComputeTenuringThreshold(int64_t desired, int64_t max) const{
+     int64_t total = 0;
+     int64_t age = 1;
+     while(age < kTableSize){
+       total += GetSize(age);
+       if(total > desired)
+         break;
+       age++;
+     }
+     return std::min(age, max);
+   }
+
+   AgeTable& operator=(const AgeTable& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const AgeTable& val){
+     stream << "AgeTable(";
+     auto first = true;
+     for(auto age = 1; age < kTableSize; age++){
+       if(val.GetSize(age) == 0)
+         continue;
+       stream << (first ? "" : ", ") << age << "=" << Bytes(val.GetSize(age));
+       first = false;
+     }
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_AGE_TABLE_H
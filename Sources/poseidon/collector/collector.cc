@@ -3,6 +3,7 @@
 #include "poseidon/utils.h"
 #include "poseidon/common.h"
 #include "poseidon/relaxed_atomic.h"
+#include "poseidon/heap/heap.h"
 
 #include "poseidon/collector/marker.h"
 #include "poseidon/collector/sweeper.h"
@@ -12,6 +13,7 @@
 
 namespace poseidon{
  static RelaxedAtomic<Collector::State> state(Collector::kIdle);
+ static PauseHistory pauses;
 
  Collector::State Collector::GetState(){
    return (Collector::State)state;
@@ -21,6 +23,77 @@ namespace poseidon{
    state = s;
  }
 
+ static inline void
+ LogHugePages(){
+   if(!HasHugePages())
+     return;
+   auto heap = Heap::GetCurrentThreadHeap();
+   GCLOG(10) << "huge pages: " << Bytes(heap->GetHugePageBackedSize()) << " of " << Bytes(heap->region()->size()) << " (" << GetHugePages() << ").";
+ }
+
+ const PauseHistory& Collector::GetPauseHistory(){
+   return pauses;
+ }
+
+ double Collector::GetMinimumMutatorUtilization(){
+   return pauses.GetMinimumMutatorUtilization(std::chrono::microseconds(GetMutatorUtilizationWindow()));
+ }
+
+ static inline void
+ RecordPause(const char* name, const Timestamp& start){
+   auto finish = Clock::now();
+   pauses.Record(start, finish);
+   GCLOG(3) << name << " paused for " << (finish - start) << ", mmu=" << Collector::GetMinimumMutatorUtilization() << ".";
+ }
+
+ // frees the unmarked objects, once the marking is done. The mark is finished by the mutator of the marked heap, so
+ // it's the heap of the current thread.
+ static inline void
+ SweepOldZone(){
+   auto old_zone = Heap::GetCurrentThreadHeap()->old_zone();
+   // the sweeper writes to the old zone, the pages the mutator wrote to stay dirty for the next scavenge.
+   auto watching = old_zone->IsWatchingWrites();
+   old_zone->StopWriteWatch();
+   Sweeper::Sweep();
+   //Compactor::SerialCompact();
+
+   auto decommitted = old_zone->Shrink();
+   DLOG_IF(INFO, decommitted > 0) << "decommitted " << Bytes(decommitted) << " of " << (*old_zone) << ".";
+   if(watching)
+     old_zone->StartWriteWatch();
+ }
+
+ // a concurrent or incremental mark starts once enough of the old zone is in use, so it's done before the old zone
+ // runs out.
+ static inline bool
+ ShouldStartMark(){
+   if((!IsConcurrentMarkEnabled() && !IsIncrementalMarkEnabled()) || Marker::IsMarking())
+     return false;
+   return Heap::GetCurrentThreadHeap()->old_zone()->GetOccupancy() >= GetConcurrentMarkThreshold();
+ }
+
+ // the initial mark pause, the workers mark concurrently if there are any, otherwise the mutator marks in steps.
+ static inline void
+ StartMark(){
+   auto start = Clock::now();
+   TIMED_SECTION("InitialMarkPause", {
+     if(IsConcurrentMarkEnabled()){
+       Marker::StartConcurrentMark();
+     } else{
+       Marker::StartIncrementalMark();
+     }
+   });
+   RecordPause("InitialMarkPause", start);
+ }
+
+ void Collector::FinishMark(){
+   TIMED_SECTION("RemarkPause", {
+     Marker::FinishConcurrentMark();
+     SweepOldZone();
+   });
+   LogHugePages();
+ }
+
  void Collector::MinorCollection(){
    if(IsMinorCollection()){
      LOG(ERROR) << "minor collection is already running, skipping new minor collection.";
@@ -32,9 +105,19 @@ namespace poseidon{
      return;
    }
 
+   // the scavenge would restart the workers of a terminated mark, it's finished first.
+   FinishMajorCollectionIfTerminated();
+
+   auto start = Clock::now();
    TIMED_SECTION("MinorCollection", {
      Scavenger::Scavenge();
    });
+   LogHugePages();
+   RecordPause("MinorCollection", start);
+
+   // the initial mark is a pause of its own, right after the scavenge.
+   if(ShouldStartMark())
+     StartMark();
  }
 
  void Collector::MajorCollection(){//TODO: decide between sweeper & compactor
@@ -48,11 +131,61 @@ namespace poseidon{
      return;
    }
 
+   // the running concurrent mark is finished instead of starting over.
+   if(Marker::IsMarkingConcurrently(Heap::GetCurrentThreadHeap())){
+     FinishMajorCollection();
+     return;
+   }
+
+   // the old zone of another heap is being marked, this one isn't & sweeping it would free every object.
+   if(Marker::IsMarking()){
+     LOG(WARNING) << "old zone of another heap is being marked, skipping new major collection.";
+     return;
+   }
+
+   auto start = Clock::now();
    TIMED_SECTION("MajorCollection", {
      Marker::MarkAllLiveObjects();
-
-     Sweeper::Sweep();
-     //Compactor::SerialCompact();
+     SweepOldZone();
    });
+   LogHugePages();
+   RecordPause("MajorCollection", start);
+ }
+
+ void Collector::StartMajorCollection(){
+   if(Marker::IsMarking()){
+     LOG(WARNING) << "old zone is already being marked, skipping new major collection.";
+     return;
+   }
+
+   StartMark();
+ }
+
+ void Collector::FinishMajorCollection(){
+   if(!Marker::IsMarkingConcurrently(Heap::GetCurrentThreadHeap())){
+     LOG(WARNING) << "old zone isn't being marked concurrently, skipping remark.";
+     return;
+   }
+
+   auto start = Clock::now();
+   FinishMark();
+   RecordPause("RemarkPause", start);
+ }
+
+ void Collector::FinishMajorCollectionIfTerminated(){
+   if(Marker::IsConcurrentMarkTerminated())
+     FinishMajorCollection();
+ }
+
+ void Collector::MarkStep(){
+   // the steps pop the mark stack of the marked heap, only its mutator takes them.
+   if(!Marker::IsMarkingIncrementally() || !Marker::IsMarkingConcurrently(Heap::GetCurrentThreadHeap()))
+     return;
+
+   auto start = Clock::now();
+   // the last step is followed by the remark, the steps left little for it to do.
+   if(Marker::MarkStep())
+     FinishMark();
+   RecordPause("MarkStep", start);
  }
-}
\ No newline at end of file
+}
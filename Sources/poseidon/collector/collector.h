@@ -3,6 +3,8 @@
 
 #include <ostream>
 
+#include "poseidon/collector/pause_history.h"
+
 namespace poseidon{
 #define FOR_EACH_COLLECTOR_STATE(V) \
  V(Idle)                            \
@@ -33,6 +35,8 @@ namespace poseidon{
    }
   private:
    static void SetState(State state);
+
+   static void FinishMark();
   public:
    Collector() = delete;
    Collector(const Collector& rhs) = delete;
@@ -43,6 +47,39 @@ namespace poseidon{
    static void MinorCollection();
    static void MajorCollection();
 
+   /**
+    * Starts a major collection w/ the initial mark pause, the old zone gets marked concurrently w/ the mutator until
+    * {@link FinishMajorCollection()}.
+    */
+   static void StartMajorCollection();
+
+   /**
+    * Finishes the concurrent major collection w/ the remark pause & sweeps.
+    */
+   static void FinishMajorCollection();
+
+   /**
+    * Finishes the concurrent major collection once its workers terminated, called by the mutator at a safepoint: the
+    * refill of an allocation buffer & the start of a minor collection.
+    */
+   static void FinishMajorCollectionIfTerminated();
+
+   /**
+    * Takes a step of the running incremental mark, called by the allocation slow path. The last step finishes the
+    * major collection.
+    */
+   static void MarkStep();
+
+   /**
+    * The pauses of the mutator, every collection, initial mark, remark & incremental mark step.
+    */
+   static const PauseHistory& GetPauseHistory();
+
+   /**
+    * Returns the minimum mutator utilization of the recent pauses, for windows of {@link GetMutatorUtilizationWindow()}.
+    */
+   static double GetMinimumMutatorUtilization();
+
 #define DEFINE_STATE_CHECK(Name) static inline bool Is##Name(){ return GetState() == State::k##Name; }
    FOR_EACH_COLLECTOR_STATE(DEFINE_STATE_CHECK)
 #undef DEFINE_STATE_CHECK
@@ -34,12 +34,17 @@ namespace poseidon{
 
  class SerialCompactor : public CompactorVisitorBase<false>{
   private:
+   OldZone* zone_;
    uword start_;
    int64_t size_;
 
    uword live_;
    uword free_;
 
+   inline OldZone* zone() const{
+     return zone_;
+   }
+
    inline uword GetStartingAddress() const{
      return start_;
    }
@@ -60,34 +65,34 @@ namespace poseidon{
      return (RawObject*)free_;
    }
 
-   inline int64_t Forward(RawObject* ptr){ //TODO: need to copy object over
+   // the forwarding address would overwrite the header & the size w/ it, which the copying pass still needs to walk
+   // the zone. objects slide down in address order, so the copying pass recomputes the same address instead.
+   inline int64_t Forward(RawObject* ptr){
      DLOG(INFO) << "forwarding " << ptr->ToString() << " to " << free_ptr();
-     ptr->SetForwardingAddress(free_ptr()->GetAddress());
      return ptr->GetTotalSize();
    }
 
    inline int64_t CopyObject(RawObject* src, RawObject* dst){
      DLOG(INFO) << "copying " << src->ToString() << " to " << dst->ToString();
+     // the header of dst may overlap src, so the size & class id are read before it gets written.
+     auto size = src->GetPointerSize();
+     auto class_id = src->GetClassId();
      new (dst)RawObject();
-     dst->SetPointerSize(src->GetPointerSize());
+     dst->SetPointerSize(size);
+     dst->SetClassId(class_id);
      dst->SetOldBit();
-
-#ifdef PSDN_DEBUG
-     assert(src->GetTotalSize() == dst->GetTotalSize());
-#endif//PSDN_DEBUG
-     memcpy(dst->GetPointer(), src->GetPointer(), src->GetPointerSize());
+     memmove(dst->GetPointer(), src->GetPointer(), size);
      return dst->GetTotalSize();
    }
 
-   inline int64_t Copy(RawObject* val){
-     auto next_address = val->GetForwardingAddress();
+   inline int64_t Copy(RawObject* val, uword next_address){
      return CopyObject(val, (RawObject*)next_address);
    }
 
    void ComputeForwardingAddressAndFinalizeObjects(){
      while(live_ < GetEndingAddress() && live_ptr()->GetPointerSize() > 0){
        auto ptr = live_ptr();
-       if(ptr->IsMarked()){
+       if(zone()->IsMarked(ptr)){
          free_ += Forward(ptr);
        }
        live_ += ptr->GetTotalSize();
@@ -104,12 +109,9 @@ namespace poseidon{
 
        auto length = current->GetTotalSize();
 
-       if(current->IsMarked()){
-#ifdef PSDN_DEBUG
-         assert(current->IsForwarding());
-#endif//PSDN_DEBUG
-         next_address += Copy(current);
-       } else{
+       if(zone()->IsMarked(current)){
+         next_address += Copy(current, next_address);
+       } else if(!current->IsFree()){
          Finalizer::Finalize(current);
        }
 
@@ -119,6 +121,7 @@ namespace poseidon{
    }
   public:
    explicit SerialCompactor(OldZone* zone):
+    zone_(zone),
     start_(zone->GetStartingAddress()),
     size_(zone->GetSize()),
     live_(zone->GetStartingAddress()),
@@ -156,9 +159,6 @@ namespace poseidon{
  }
 
  void Compactor::ParallelCompact(){
-   auto heap = Heap::GetCurrentThreadHeap();
-   auto old_zone = heap->old_zone();
-
    TIMED_SECTION("ParallelCompact", {
      NOT_IMPLEMENTED(ERROR);//TODO: implement
    });
@@ -0,0 +1,55 @@
+#include "poseidon/collector/copy_buffers.h"
+
+namespace poseidon{
+ uword CopyBuffers::TryAllocateNew(int64_t size){
+   if(IsTooLarge(size))
+     return tospace()->TryAllocate(size);
+
+   uword address;
+   if((address = lab_.TryAllocate(size)) != 0)
+     return address;
+
+   wasted_ += lab_.GetNumberOfBytesRemaining();
+   if(!tospace()->TryRefill(&lab_, buffer_size_))
+     return tospace()->TryAllocate(size); // the end of the to-space is too small for a buffer.
+   refills_++;
+   return lab_.TryAllocate(size);
+ }
+
+ uword CopyBuffers::TryAllocateOld(int64_t size){
+   if(IsTooLarge(size))
+     return old_zone()->TryAllocate(size);
+
+   uword address;
+   if((address = plab_.TryAllocate(size)) != 0)
+     return address;
+
+   wasted_ += old_zone()->Retire(&plab_);
+   if(!old_zone()->TryRefill(&plab_, buffer_size_))
+     return old_zone()->TryAllocate(size); // the old zone is too fragmented for a buffer.
+   refills_++;
+   return plab_.TryAllocate(size);
+ }
+
+ void CopyBuffers::Undo(RawObject* copy){
+   if(copy->IsOld()){
+     if(!plab_.TryRetract(copy))
+       old_zone()->Retract(copy);
+     return;
+   }
+
+   if(lab_.TryRetract(copy) || tospace()->TryRetract(copy))
+     return;
+   // other objects were copied after it, so it stays behind as a dead object w/o references.
+   copy->SetClassId(kInvalidClassId);
+   wasted_ += copy->GetTotalSize();
+ }
+
+ void CopyBuffers::Retire(){
+   wasted_ += lab_.GetNumberOfBytesRemaining();
+   lab_.Retire();
+   wasted_ += old_zone()->Retire(&plab_);
+   if(marks_ != nullptr)
+     marks_->Release();
+ }
+}
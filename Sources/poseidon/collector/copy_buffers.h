@@ -0,0 +1,133 @@
+#ifndef POSEIDON_COPY_BUFFERS_H
+#define POSEIDON_COPY_BUFFERS_H
+
+#include <ostream>
+
+#include "poseidon/flags.h"
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+#include "poseidon/heap/old_zone.h"
+#include "poseidon/heap/semispace.h"
+#include "poseidon/heap/local_allocation_buffer.h"
+#include "poseidon/heap/promotion_local_allocation_buffer.h"
+#include "poseidon/collector/mark_stack.h"
+
+namespace poseidon{
+ /**
+  * The buffers a scavenger worker copies objects into: a {@link LocalAllocationBuffer} carved out of the to-space &
+  * a {@link PromotionLocalAllocationBuffer} carved out of the old zone. Only their refills contend w/ the other
+  * workers.
+  *
+  * Objects larger than a quarter of a buffer are allocated directly, so a refill never wastes more than that. The
+  * buffers are retired at the end of the scavenge.
+  *
+  * During a concurrent mark the worker also gets a {@link MarkStack}, which the objects it promotes are shaded onto.
+  */
+ class CopyBuffers{
+  private:
+   Semispace* tospace_;
+   OldZone* old_zone_;
+   int64_t buffer_size_;
+   LocalAllocationBuffer lab_;
+   PromotionLocalAllocationBuffer plab_;
+   MarkStack* marks_;
+   int64_t refills_;
+   int64_t wasted_;
+
+   inline bool IsTooLarge(int64_t size) const{
+     return static_cast<int64_t>(sizeof(RawObject) + size) > (buffer_size_ / 4);
+   }
+  public:
+   CopyBuffers(Semispace* tospace, OldZone* old_zone, int64_t buffer_size = GetCollectorLocalAllocationBufferSize(),
+               MarkStackSegmentPool* marks = nullptr):
+    tospace_(tospace),
+    old_zone_(old_zone),
+    buffer_size_(std::min(buffer_size, GetOldPageSize())),
+    lab_(),
+    plab_(),
+    marks_(marks != nullptr ? new MarkStack(marks) : nullptr),
+    refills_(0),
+    wasted_(0){
+   }
+   CopyBuffers(const CopyBuffers& rhs) = delete;
+   ~CopyBuffers(){
+     delete marks_;
+   }
+
+   Semispace* tospace() const{
+     return tospace_;
+   }
+
+   OldZone* old_zone() const{
+     return old_zone_;
+   }
+
+   const LocalAllocationBuffer& lab() const{
+     return lab_;
+   }
+
+   const PromotionLocalAllocationBuffer& plab() const{
+     return plab_;
+   }
+
+   /**
+    * The mark stack of the concurrent mark, or nullptr if there's none.
+    */
+   MarkStack* marks() const{
+     return marks_;
+   }
+
+   /**
+    * The number of times the buffers were refilled.
+    */
+   int64_t refills() const{
+     return refills_;
+   }
+
+   /**
+    * The number of bytes the buffers left unused, the tails of the retired buffers & the copies that couldn't be
+    * taken back.
+    */
+   int64_t wasted() const{
+     return wasted_;
+   }
+
+   /**
+    * Allocates a new object of size bytes in the to-space.
+    *
+    * @return The address of the new object, or 0 if the to-space is exhausted
+    */
+   uword TryAllocateNew(int64_t size);
+
+   /**
+    * Allocates an old object of size bytes in the old zone.
+    *
+    * @return The address of the old object, or 0 if the old zone is exhausted
+    */
+   uword TryAllocateOld(int64_t size);
+
+   /**
+    * Takes back copy, the last object allocated by this {@link CopyBuffers} which was never used.
+    */
+   void Undo(RawObject* copy);
+
+   /**
+    * Retires both buffers & hands the shaded objects to the markers, called once the worker is done copying.
+    */
+   void Retire();
+
+   CopyBuffers& operator=(const CopyBuffers& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const CopyBuffers& val){
+     stream << "CopyBuffers(";
+     stream << "lab=" << val.lab() << ", ";
+     stream << "plab=" << val.plab() << ", ";
+     stream << "refills=" << val.refills() << ", ";
+     stream << "wasted=" << Bytes(val.wasted());
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_COPY_BUFFERS_H
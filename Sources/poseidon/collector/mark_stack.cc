@@ -0,0 +1,114 @@
+#include <algorithm>
+
+#include "poseidon/collector/mark_stack.h"
+
+namespace poseidon{
+ MarkStackSegment* MarkStackSegmentPool::TryAllocate(){
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto segment = PopFrom(&free_);
+   if(segment != nullptr)
+     return segment;
+   if(allocated_ >= max_segments_)
+     return nullptr;
+   allocated_++;
+   return new MarkStackSegment();
+ }
+
+ void MarkStackSegmentPool::Free(MarkStackSegment* segment){
+   PSDN_ASSERT(segment->IsEmpty());
+   std::lock_guard<std::mutex> guard(mutex_);
+   PushTo(&free_, segment);
+ }
+
+ void MarkStackSegmentPool::Publish(MarkStackSegment* segment){
+   PSDN_ASSERT(!segment->IsEmpty());
+   std::lock_guard<std::mutex> guard(mutex_);
+   PushTo(&published_, segment);
+   num_published_.fetch_add(1, std::memory_order_release);
+   total_published_ += 1;
+ }
+
+ MarkStackSegment* MarkStackSegmentPool::TryTake(){
+   if(IsEmpty())
+     return nullptr;
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto segment = PopFrom(&published_);
+   if(segment != nullptr)
+     num_published_.fetch_sub(1, std::memory_order_release);
+   return segment;
+ }
+
+ void MarkStackSegmentPool::VisitEntries(const std::function<void(uword*)>& vis){
+   MarkStackSegment* segment;
+   {
+     std::lock_guard<std::mutex> guard(mutex_);
+     segment = published_;
+   }
+   // the segments are only prepended, vis can push onto the pool.
+   for(; segment != nullptr; segment = segment->next_){
+     for(int64_t idx = 0; idx < segment->size(); idx++)
+       vis(&segment->data_[idx]);
+   }
+ }
+
+ void MarkStackSegmentPool::Clear(){
+   std::lock_guard<std::mutex> guard(mutex_);
+   MarkStackSegment* segment;
+   while((segment = PopFrom(&published_)) != nullptr)
+     delete segment;
+   while((segment = PopFrom(&free_)) != nullptr)
+     delete segment;
+   num_published_.store(0, std::memory_order_release);
+   allocated_ = 0;
+ }
+
+ bool MarkStack::Push(uword val){
+   if(segment_ == nullptr || segment_->IsFull()){
+     auto next = pool()->TryAllocate();
+     if(next == nullptr)
+       return false;
+     if(segment_ != nullptr)
+       pool()->Publish(segment_);
+     segment_ = next;
+   }
+   segment_->Push(val);
+   return true;
+ }
+
+ uword MarkStack::Pop(){
+   if(IsEmpty()){
+     Release();
+     if((segment_ = pool()->TryTake()) == nullptr)
+       return 0;
+   }
+   return segment_->Pop();
+ }
+
+ bool MarkStack::PublishSurplus(){
+   if(size() < (2 * kMinSurplus) || !pool()->IsEmpty())
+     return false;
+
+   auto surplus = pool()->TryAllocate();
+   if(surplus == nullptr)
+     return false;
+   // the oldest entries are published, they tend to lead to the larger parts of the graph.
+   auto num = segment_->size() / 2;
+   std::copy(segment_->data_, segment_->data_ + num, surplus->data_);
+   std::copy(segment_->data_ + num, segment_->data_ + segment_->size(), segment_->data_);
+   surplus->size_ = num;
+   segment_->size_ -= num;
+   pool()->Publish(surplus);
+   return true;
+ }
+
+ void MarkStack::Release(){
+   if(segment_ == nullptr)
+     return;
+   if(segment_->IsEmpty()){
+     pool()->Free(segment_);
+   } else{
+     pool()->Publish(segment_);
+   }
+   segment_ = nullptr;
+ }
+}
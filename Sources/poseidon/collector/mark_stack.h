@@ -0,0 +1,244 @@
+#ifndef POSEIDON_MARK_STACK_H
+#define POSEIDON_MARK_STACK_H
+
+#include <mutex>
+#include <algorithm>
+#include <ostream>
+#include <functional>
+
+#include "poseidon/flags.h"
+#include "poseidon/utils.h"
+#include "poseidon/relaxed_atomic.h"
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ /**
+  * A fixed-size chunk of a {@link MarkStack}, the unit of work the markers hand to each other.
+  */
+ class MarkStackSegment{
+   friend class MarkStack;
+   friend class MarkStackSegmentPool;
+  public:
+   static constexpr const int64_t kCapacity = 256;
+  private:
+   MarkStackSegment* next_;
+   int64_t size_;
+   uword data_[kCapacity];
+  public:
+   MarkStackSegment():
+    next_(nullptr),
+    size_(0),
+    data_(){
+   }
+   MarkStackSegment(const MarkStackSegment& rhs) = delete;
+   ~MarkStackSegment() = default;
+
+   int64_t size() const{
+     return size_;
+   }
+
+   bool IsEmpty() const{
+     return size_ == 0;
+   }
+
+   bool IsFull() const{
+     return size_ == kCapacity;
+   }
+
+   void Push(uword val){
+     PSDN_ASSERT(!IsFull());
+     data_[size_++] = val;
+   }
+
+   uword Pop(){
+     PSDN_ASSERT(!IsEmpty());
+     return data_[--size_];
+   }
+
+   MarkStackSegment& operator=(const MarkStackSegment& rhs) = delete;
+ };
+
+ /**
+  * The {@link MarkStackSegment}s shared by the markers: the published segments, which idle markers take, & the
+  * empty segments, which get reused.
+  *
+  * At most max_segments are allocated, a {@link MarkStack} that can't get another segment overflows.
+  */
+ class MarkStackSegmentPool{
+  private:
+   std::mutex mutex_;
+   MarkStackSegment* published_;
+   MarkStackSegment* free_;
+   int64_t max_segments_;
+   int64_t allocated_;
+   RelaxedAtomic<int64_t> num_published_;
+   RelaxedAtomic<int64_t> total_published_;
+
+   static inline MarkStackSegment*
+   PopFrom(MarkStackSegment** list){
+     auto segment = (*list);
+     if(segment != nullptr){
+       (*list) = segment->next_;
+       segment->next_ = nullptr;
+     }
+     return segment;
+   }
+
+   static inline void
+   PushTo(MarkStackSegment** list, MarkStackSegment* segment){
+     segment->next_ = (*list);
+     (*list) = segment;
+   }
+  public:
+   explicit MarkStackSegmentPool(int64_t max_segments = GetMarkStackSize() / static_cast<int64_t>(sizeof(MarkStackSegment))):
+    mutex_(),
+    published_(nullptr),
+    free_(nullptr),
+    max_segments_(std::max(max_segments, static_cast<int64_t>(1))),
+    allocated_(0),
+    num_published_(0),
+    total_published_(0){
+   }
+   MarkStackSegmentPool(const MarkStackSegmentPool& rhs) = delete;
+   ~MarkStackSegmentPool(){
+     Clear();
+   }
+
+   int64_t GetMaxNumberOfSegments() const{
+     return max_segments_;
+   }
+
+   /**
+    * The number of published segments waiting to be taken, the markers peek at it while offering to terminate.
+    */
+   int64_t GetNumberOfSegments() const{
+     return num_published_.load(std::memory_order_acquire);
+   }
+
+   bool IsEmpty() const{
+     return GetNumberOfSegments() == 0;
+   }
+
+   /**
+    * The number of segments published since the pool was created, for the stats.
+    */
+   int64_t GetTotalNumberOfSegmentsPublished() const{
+     return (int64_t)total_published_;
+   }
+
+   /**
+    * Returns an empty segment, reusing a freed one if possible.
+    *
+    * @return The segment, or nullptr if max segments are in use
+    */
+   MarkStackSegment* TryAllocate();
+
+   /**
+    * Returns the empty segment to the pool.
+    */
+   void Free(MarkStackSegment* segment);
+
+   /**
+    * Hands the segment over to the other markers.
+    */
+   void Publish(MarkStackSegment* segment);
+
+   /**
+    * Takes the most recently published segment.
+    *
+    * @return The segment, or nullptr if there are no published segments
+    */
+   MarkStackSegment* TryTake();
+
+   /**
+    * Visits the entries of the published segments, while nobody takes segments from the pool. The segments
+    * published while visiting aren't visited.
+    */
+   void VisitEntries(const std::function<void(uword*)>& vis);
+
+   /**
+    * Frees the memory of the segments, once the marking is done & no {@link MarkStack} holds a segment anymore. The
+    * published segments are dropped.
+    */
+   void Clear();
+
+   MarkStackSegmentPool& operator=(const MarkStackSegmentPool& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const MarkStackSegmentPool& val){
+     stream << "MarkStackSegmentPool(";
+     stream << "segments=" << val.GetNumberOfSegments() << ", ";
+     stream << "max_segments=" << val.GetMaxNumberOfSegments() << ", ";
+     stream << "published=" << val.GetTotalNumberOfSegmentsPublished();
+     stream << ")";
+     return stream;
+   }
+ };
+
+ /**
+  * The mark stack of a single marker, it holds a single {@link MarkStackSegment}.
+  *
+  * A full segment gets published to the {@link MarkStackSegmentPool} & an empty one gets refilled by taking a
+  * published segment, so the work spreads across the markers a segment at a time. A push fails once the pool is out
+  * of segments, the caller has to find the object again some other way.
+  */
+ class MarkStack{
+  public:
+   // the entries a marker keeps for itself when it publishes the surplus of its segment.
+   static constexpr const int64_t kMinSurplus = 32;
+  private:
+   MarkStackSegmentPool* pool_;
+   MarkStackSegment* segment_;
+  public:
+   explicit MarkStack(MarkStackSegmentPool* pool):
+    pool_(pool),
+    segment_(nullptr){
+   }
+   MarkStack(const MarkStack& rhs) = delete;
+   ~MarkStack(){
+     Release();
+   }
+
+   MarkStackSegmentPool* pool() const{
+     return pool_;
+   }
+
+   bool IsEmpty() const{
+     return segment_ == nullptr || segment_->IsEmpty();
+   }
+
+   int64_t size() const{
+     return segment_ != nullptr ? segment_->size() : 0;
+   }
+
+   /**
+    * Pushes val, publishing the current segment if it's full.
+    *
+    * @return false if the stack overflowed, val wasn't pushed
+    */
+   bool Push(uword val);
+
+   /**
+    * Pops the top entry, taking a published segment if the current one is empty.
+    *
+    * @return The entry, or 0 if the stack is empty & there are no published segments
+    */
+   uword Pop();
+
+   /**
+    * Publishes the older half of the current segment if the other markers ran out of work.
+    *
+    * @return true if entries were published
+    */
+   bool PublishSurplus();
+
+   /**
+    * Returns the current segment to the pool, called before the marker offers to terminate. A segment that still
+    * holds entries gets published, ex: the roots.
+    */
+   void Release();
+
+   MarkStack& operator=(const MarkStack& rhs) = delete;
+ };
+}
+
+#endif//POSEIDON_MARK_STACK_H
@@ -1,12 +1,24 @@
+#include <thread>
+#include <vector>
+#include <unordered_set>
+
 #include "poseidon/flags.h"
+#include "poseidon/bitset.h"
 #include "poseidon/local.h"
 #include "poseidon/runtime.h"
 #include "poseidon/task_pool.h"
+#include "poseidon/termination_barrier.h"
 #include "poseidon/raw_object.h"
+#include "poseidon/heap/heap.h"
 #include "poseidon/collector/marker.h"
+#include "poseidon/collector/mark_stack.h"
 
 namespace poseidon{
  static RelaxedAtomic<bool> marking(false);
+ static RelaxedAtomic<int64_t> last_mark_overflows(0);
+
+ RelaxedAtomic<bool> Marker::concurrent_(false);
+ RelaxedAtomic<bool> Marker::incremental_(false);
 
  bool Marker::IsMarking(){
    return (bool)marking;
@@ -20,6 +32,14 @@ namespace poseidon{
    marking = false;
  }
 
+ // old objects are marked in the bitmaps of their pages, large objects aren't paged & get marked in their headers.
+ static inline bool
+ TryMarkOld(OldZone* zone, RawObject* ptr){
+   if(zone->Contains(ptr->GetAddress()))
+     return zone->TryMark(ptr);
+   return ptr->TrySetMarkedBit();
+ }
+
  template<bool Parallel>
  class MarkerVisitorBase : public RawObjectPointerVisitor{
   protected:
@@ -34,6 +54,23 @@ namespace poseidon{
 
  class SerialMarkerVisitor : public MarkerVisitorBase<false>{
   protected:
+   OldZone* zone_;
+   // the reached objects whose fields haven't been scanned yet.
+   std::vector<RawObject*> work_;
+   // new objects aren't marked, they're traced through so the old objects they reference stay alive.
+   std::unordered_set<RawObject*> visited_;
+
+   inline void Mark(RawObject* ptr){
+     if(ptr->IsOld()){
+       if(!TryMarkOld(zone_, ptr))
+         return;
+       DLOG(INFO) << "marked " << ptr->ToString();
+     } else if(!visited_.insert(ptr).second){
+       return;
+     }
+     work_.push_back(ptr);
+   }
+
    void MarkRoots(){
      auto page = LocalPage::GetLocalPageForCurrentThread();
      while(page != nullptr){
@@ -41,65 +78,158 @@ namespace poseidon{
        page = page->GetNext();
      }
    }
+
+   void MarkReferences(){
+     while(!work_.empty()){
+       auto next = work_.back();
+       work_.pop_back();
+       next->VisitPointers([&](uword* slot){
+         Mark(RawObject::FromPointer(*slot));
+         return true;
+       });
+     }
+   }
   public:
-   SerialMarkerVisitor() = default;
+   explicit SerialMarkerVisitor(OldZone* zone):
+    MarkerVisitorBase<false>(),
+    zone_(zone),
+    work_(),
+    visited_(){
+   }
    ~SerialMarkerVisitor() override = default;
 
    bool Visit(RawObject** ptr) override{
-     auto old_val = (*ptr);
-     if(old_val->IsOld() && !old_val->IsMarked()){
-       old_val->SetMarkedBit();
-       DLOG(INFO) << "marked " << old_val->ToString();
-     }
-     //TODO: mark references?
+     Mark(*ptr);
      return true;
    }
 
    void MarkAll(){
      MarkRoots();
+     MarkReferences();
    }
  };
 
- class ParallelMarker;
- class ParallelMarkerTask : public Task{
-   friend class ParallelMarker;
+ class ParallelMarker : public MarkerVisitorBase<true>{
+   friend class ParallelMarkerTask;
   private:
-   WorkStealingQueue<uword>* work_;
+   Heap* heap_;
+   MarkStackSegmentPool* pool_;
+   TerminationBarrier* terminator_;
+   // new objects aren't marked, the reached ones are recorded by their word in the new zone.
+   BitSet visited_;
+   // the pages w/ a marked object that overflowed the mark stacks before its fields were scanned.
+   BitSet overflowed_;
+   // the new & large objects aren't paged, once one of them overflowed all of them are rescanned.
+   RelaxedAtomic<bool> overflowed_unpaged_;
+   RelaxedAtomic<int64_t> num_overflows_;
+   // the workers leave once it's set, so a scavenge can move the new objects.
+   RelaxedAtomic<bool> paused_;
+   MarkStack stack_;
 
-   inline WorkStealingQueue<uword>* work() const{
-     return work_;
+   inline NewZone* new_zone() const{
+     return heap_->new_zone();
    }
 
-   inline bool HasWork() const;
-   inline uword GetNext();
-  public:
-   explicit ParallelMarkerTask(WorkStealingQueue<uword>* work):
-    Task(),
-    work_(work){
+   inline OldZone* old_zone() const{
+     return heap_->old_zone();
    }
-   ~ParallelMarkerTask() override = default;
 
-   const char* name() const override{
-     return "ParallelMarkerTask";
+   inline int64_t GetVisitedIndex(RawObject* ptr) const{
+     return static_cast<int64_t>(ptr->GetAddress() - new_zone()->GetStartingAddress()) >> kWordSizeLog2;
    }
 
-   void Run() override{
-     do{
-       do{
-         uword next;
-         if((next = GetNext()) != 0){
-           auto ptr = (RawObject*)next;
-           ptr->SetMarkedBit();
-         }
-       } while(HasWork());
-     } while(Marker::IsMarking());
+   inline bool TryMark(RawObject* ptr){
+     if(ptr->IsNew())
+       return visited_.TryAtomicSet(GetVisitedIndex(ptr));
+     return TryMarkOld(old_zone(), ptr);
    }
- };
 
- class ParallelMarker : public MarkerVisitorBase<true>{
-   friend class ParallelMarkerTask;
-  private:
-   WorkStealingQueue<uword>* work_;
+   void Overflow(RawObject* ptr){
+     num_overflows_ += 1;
+     if(old_zone()->Contains(ptr->GetAddress())){
+       overflowed_.AtomicSet(old_zone()->GetPageIndexFor(ptr->GetAddress()));
+     } else{
+       overflowed_unpaged_ = true;
+     }
+   }
+
+   inline void Push(MarkStack* stack, RawObject* ptr){
+     if(!stack->Push(ptr->GetAddress()))
+       Overflow(ptr);
+   }
+
+   void MarkReferences(MarkStack* stack, RawObject* ptr){
+     ptr->VisitPointers([&](uword* slot){
+       auto val = RawObject::FromPointer(*slot);
+       if(TryMark(val))
+         Push(stack, val);
+       return true;
+     });
+   }
+
+   // marks everything reachable from the stack, stealing published segments once it's empty.
+   void Drain(MarkStack* stack){
+     uword next;
+     while(!IsPaused() && (next = stack->Pop()) != 0){
+       MarkReferences(stack, (RawObject*)next);
+       stack->PublishSurplus();
+     }
+   }
+
+   bool HasOverflowed() const{
+     if((bool)overflowed_unpaged_)
+       return true;
+     for(auto& word : overflowed_){
+       if(word != 0)
+         return true;
+     }
+     return false;
+   }
+
+   void RescanOverflowedPages(){
+     for(int64_t idx = 0; idx < old_zone()->GetNumberOfPages(); idx++){
+       if(!overflowed_.Test(idx))
+         continue;
+       overflowed_.Set(idx, false);
+       old_zone()->pages(idx)->VisitMarkedPointers([&](RawObject* ptr){
+         MarkReferences(&stack_, ptr);
+         Drain(&stack_);
+         return true;
+       });
+     }
+   }
+
+   void RescanUnpaged(){
+     overflowed_unpaged_ = false;
+     for(int64_t idx = 0; idx < visited_.size(); idx++){
+       auto bits = visited_[idx];
+       while(bits != 0){
+         auto bit = static_cast<int64_t>(__builtin_ctzl(bits));
+         bits &= (bits - 1);
+         auto ptr = (RawObject*)(new_zone()->GetStartingAddress() + (((idx << kBitsPerWordLog2) + bit) << kWordSizeLog2));
+         MarkReferences(&stack_, ptr);
+         Drain(&stack_);
+       }
+     }
+     heap_->large_object_space()->VisitPointers([&](RawObject* ptr){
+       if(ptr->IsMarked()){
+         MarkReferences(&stack_, ptr);
+         Drain(&stack_);
+       }
+       return true;
+     });
+   }
+
+   // the overflowed objects are marked but weren't scanned, they're found again by rescanning the marked objects.
+   void RescanOverflowed(){
+     TIMED_SECTION("RescanOverflowed", {
+       while(HasOverflowed()){
+         RescanOverflowedPages();
+         if((bool)overflowed_unpaged_)
+           RescanUnpaged();
+       }
+     });
+   }
 
    void MarkLocals(){
      TIMED_SECTION("MarkLocals", {
@@ -111,55 +241,286 @@ namespace poseidon{
      });
    }
 
-   void MarkRoots(){
-     TIMED_SECTION("MarkRoots", {
-       MarkLocals();
-
-       // wait for work to finish.
-       while(!work_->empty());//spin
-     });
-   }
+   // the roots are published, so this thread joins the workers until all of them terminated.
+   void MarkReferences();
   public:
-   explicit ParallelMarker(WorkStealingQueue<uword>* work):
+   ParallelMarker(Heap* heap, MarkStackSegmentPool* pool, TerminationBarrier* terminator):
     MarkerVisitorBase<true>(),
-    work_(work){
+    heap_(heap),
+    pool_(pool),
+    terminator_(terminator),
+    visited_(heap->new_zone()->GetSize() / kWordSize),
+    overflowed_(heap->old_zone()->GetNumberOfPages()),
+    overflowed_unpaged_(false),
+    num_overflows_(0),
+    paused_(false),
+    stack_(pool){
+     visited_.Reset();
+     overflowed_.Reset();
    }
    ~ParallelMarker() override = default;
 
+   MarkStackSegmentPool* pool() const{
+     return pool_;
+   }
+
+   TerminationBarrier* terminator() const{
+     return terminator_;
+   }
+
+   int64_t GetNumberOfOverflows() const{
+     return (int64_t)num_overflows_;
+   }
+
+   bool IsPaused() const{
+     return (bool)paused_;
+   }
+
    bool Visit(RawObject** ptr) override{
      auto old_val = (*ptr);
-     if(!old_val->IsMarked() && !old_val->IsForwarding())
-       work_->Push(old_val->GetAddress());
+     if(!old_val->IsForwarding() && TryMark(old_val))
+       Push(&stack_, old_val);
+     return true;
+   }
+
+   void MarkRoots(){
+     TIMED_SECTION("MarkRoots", {
+       MarkLocals();
+     });
+     // the workers are idle until the roots are published.
+     stack_.Release();
+   }
+
+   // marks an object the mutator overwrote a reference to, the full segments of the stack go to the workers. Only
+   // the mutator owning the heap pushes onto the stack.
+   void Shade(RawObject* ptr){
+     Shade(&stack_, ptr);
+   }
+
+   void Shade(MarkStack* stack, RawObject* ptr){
+     if(TryMark(ptr))
+       Push(stack, ptr);
+   }
+
+   // waits for the workers to leave, every entry ends up in the pool. The visited bits of the new objects don't
+   // survive the scavenge, the new objects are traced again if they're reached again.
+   void Pause(){
+     paused_ = true;
+     terminator()->WaitForExit();
+     paused_ = false;
+     // the overflowed new objects are only found by their visited bits, so they're rescanned first. It's rare.
+     if((bool)overflowed_unpaged_)
+       RescanOverflowed();
+     stack_.Release();
+     visited_.Reset();
+   }
+
+   void Resume(){
+     terminator()->Reset();
+   }
+
+   // traces the references on the stack until the budget is spent, the rest is left on the stack for the next step.
+   bool Step(int64_t max_bytes, int64_t max_micros){
+     static constexpr const int64_t kObjectsPerClockCheck = 16;
+     auto deadline = Clock::now() + std::chrono::microseconds(max_micros);
+     int64_t scanned = 0;
+     int64_t num_objects = 0;
+     uword next;
+     while((next = stack_.Pop()) != 0){
+       auto ptr = (RawObject*)next;
+       MarkReferences(&stack_, ptr);
+       scanned += ptr->GetTotalSize();
+       if(max_bytes > 0 && scanned >= max_bytes)
+         return stack_.IsEmpty() && pool_->IsEmpty();
+       if(max_micros > 0 && (++num_objects % kObjectsPerClockCheck) == 0 && Clock::now() >= deadline)
+         return stack_.IsEmpty() && pool_->IsEmpty();
+     }
      return true;
    }
 
+   // helps the workers until they terminated, then marks what they left behind: the references recorded after they
+   // terminated & the overflowed objects.
+   void Remark(){
+     TIMED_SECTION("Remark", {
+       while(!terminator()->IsTerminated()){
+         Drain(&stack_);
+         std::this_thread::yield();
+       }
+       terminator()->WaitForExit();
+       Drain(&stack_);
+       RescanOverflowed();
+     });
+     GCLOG(3) << "terminated concurrent marking: " << (*terminator_) << ", " << (*pool_);
+   }
+
    void MarkAll(){
      MarkRoots();
+     MarkReferences();
+     RescanOverflowed();
    }
  };
 
- uword ParallelMarkerTask::GetNext(){
-   return work()->Steal();
- }
+ class ParallelMarkerTask : public Task{
+  private:
+   ParallelMarker* marker_;
+   MarkStackSegmentPool* pool_;
+   TerminationBarrier* terminator_;
+   MarkStack stack_;
+
+   inline TerminationBarrier* terminator() const{
+     return terminator_;
+   }
+
+   inline bool HasWork() const{
+     return !pool_->IsEmpty() && !marker_->IsPaused();
+   }
+  public:
+   explicit ParallelMarkerTask(ParallelMarker* marker):
+    Task(),
+    marker_(marker),
+    pool_(marker->pool()),
+    terminator_(marker->terminator()),
+    stack_(marker->pool()){
+   }
+   ~ParallelMarkerTask() override = default;
+
+   const char* name() const override{
+     return "ParallelMarkerTask";
+   }
+
+   void Run() override{
+     do{
+       marker_->Drain(&stack_);
+       stack_.Release();
+     } while(!terminator()->OfferTermination([this](){ return HasWork(); }));
+     terminator()->Exit();
+   }
+ };
 
- bool ParallelMarkerTask::HasWork() const{
-   return !work()->empty();
+ void ParallelMarker::MarkReferences(){
+   TIMED_SECTION("MarkReferences", {
+     ParallelMarkerTask task(this);
+     task.Run();
+   });
+   // the workers are done w/ the pool once they exited, it can be freed afterwards.
+   terminator_->WaitForExit();
+   GCLOG(3) << "terminated marking: " << (*terminator_) << ", " << (*pool_);
  }
 
  void Marker::SerialMark(){
-   SerialMarkerVisitor marker;
+   SerialMarkerVisitor marker(Heap::GetCurrentThreadHeap()->old_zone());
    TIMED_SECTION("SerialMark", {
      marker.MarkAll();
    });
  }
 
  void Marker::ParallelMark(){
-   auto wrk = new WorkStealingQueue<uword>(2048);
-   ParallelMarker marker(wrk);
-   Runtime::GetTaskPool()->SubmitToAll<ParallelMarkerTask>(wrk);
+   MarkStackSegmentPool pool;
+   TerminationBarrier terminator(Runtime::GetTaskPool()->GetNumberOfWorkers() + 1);
+   ParallelMarker marker(Heap::GetCurrentThreadHeap(), &pool, &terminator);
+   Runtime::GetTaskPool()->SubmitToAll<ParallelMarkerTask>(&marker);
    TIMED_SECTION("ParallelMark", {
      marker.MarkAll();
    });
+   last_mark_overflows = marker.GetNumberOfOverflows();
+ }
+
+ int64_t Marker::GetNumberOfOverflowsLastMark(){
+   return (int64_t)last_mark_overflows;
+ }
+
+ // the heap of the running concurrent mark, the mark belongs to the mutator of this heap.
+ static RelaxedAtomic<Heap*> marked_heap(nullptr);
+ // the marker of the running concurrent mark, only the mutator of the marked heap uses & frees it. The other
+ // mutators never read it, so it's freed w/o waiting for them.
+ static ParallelMarker* concurrent_marker = nullptr;
+
+ bool Marker::IsMarkingConcurrently(Heap* heap){
+   return IsMarkingConcurrently() && heap != nullptr && (Heap*)marked_heap == heap;
+ }
+
+ static inline bool
+ IsMarkingCurrentHeap(){
+   return Marker::IsMarkingConcurrently(Heap::GetCurrentThreadHeap());
+ }
+
+ void Marker::RecordOverwrite(uword value){
+   // the heaps of the other mutators aren't part of the snapshot.
+   if(value == 0 || !IsMarkingCurrentHeap())
+     return;
+   concurrent_marker->Shade(RawObject::FromPointer(value));
+ }
+
+ void Marker::StartMark(bool incremental){
+   if(IsMarking()){
+     DLOG(WARNING) << "already marking.";
+     return;
+   }
+
+   SetMarking();
+   auto epoch = MarkEpoch::Flip();
+   GCLOG(3) << (incremental ? "incrementally" : "concurrently") << " marking epoch " << epoch << ".";
+   // the mutator isn't one of the markers, so the workers terminate by themselves once they traced everything they
+   // can reach. An incremental mark has no workers.
+   auto num_workers = incremental ? 0 : Runtime::GetTaskPool()->GetNumberOfWorkers();
+   auto pool = new MarkStackSegmentPool();
+   auto terminator = new TerminationBarrier(num_workers);
+   auto heap = Heap::GetCurrentThreadHeap();
+   concurrent_marker = new ParallelMarker(heap, pool, terminator);
+   TIMED_SECTION("InitialMark", {
+     concurrent_marker->MarkRoots();
+   });
+   // the roots are the snapshot, from here on the mutator has to record what it overwrites.
+   marked_heap = heap;
+   concurrent_ = true;
+   incremental_ = incremental;
+   if(num_workers > 0)
+     Runtime::GetTaskPool()->SubmitToAll<ParallelMarkerTask>(concurrent_marker);
+ }
+
+ void Marker::StartConcurrentMark(){
+   StartMark(false);
+ }
+
+ void Marker::StartIncrementalMark(){
+   StartMark(true);
+ }
+
+ bool Marker::MarkStep(){
+   if(!IsMarkingIncrementally() || !IsMarkingCurrentHeap()){
+     DLOG(WARNING) << "not marking the heap of this thread incrementally.";
+     return true;
+   }
+   return concurrent_marker->Step(GetMarkStepSize(), GetMarkStepTime());
+ }
+
+ void Marker::FinishConcurrentMark(){
+   if(!IsMarkingCurrentHeap()){
+     DLOG(WARNING) << "not marking the heap of this thread concurrently.";
+     return;
+   }
+
+   // the mutator is paused, it doesn't overwrite anything until the remark is done.
+   concurrent_ = false;
+   incremental_ = false;
+   marked_heap = nullptr;
+   auto marker = concurrent_marker;
+   concurrent_marker = nullptr;
+   marker->Remark();
+   last_mark_overflows = marker->GetNumberOfOverflows();
+   // the workers exited during the remark, nothing references the pool or the barrier anymore.
+   auto pool = marker->pool();
+   auto terminator = marker->terminator();
+   delete marker;
+   delete terminator;
+   delete pool;
+   ClearMarking();
+ }
+
+ bool Marker::IsConcurrentMarkTerminated(){
+   if(!IsMarkingCurrentHeap() || IsMarkingIncrementally())
+     return false;
+   return concurrent_marker->terminator()->IsTerminated();
  }
 
  void Marker::MarkAllLiveObjects(){
@@ -169,6 +530,9 @@ namespace poseidon{
    }
 
    SetMarking();
+   // unmarks every object, the marks of the last collection belong to the previous epoch.
+   auto epoch = MarkEpoch::Flip();
+   GCLOG(3) << "marking epoch " << epoch << ".";
    if(HasWorkers()){
      ParallelMark();
    } else{
@@ -176,4 +540,35 @@ namespace poseidon{
    }
    ClearMarking();
  }
-}
\ No newline at end of file
+
+ void Marker::PauseConcurrentMark(){
+   if(!IsMarkingCurrentHeap())
+     return;
+   TIMED_SECTION("PauseConcurrentMark", {
+     concurrent_marker->Pause();
+   });
+ }
+
+ void Marker::ResumeConcurrentMark(){
+   if(!IsMarkingCurrentHeap())
+     return;
+   concurrent_marker->Resume();
+   if(!IsMarkingIncrementally())
+     Runtime::GetTaskPool()->SubmitToAll<ParallelMarkerTask>(concurrent_marker);
+ }
+
+ void Marker::VisitMarkStack(const std::function<void(uword*)>& vis){
+   if(!IsMarkingCurrentHeap())
+     return;
+   concurrent_marker->pool()->VisitEntries(vis);
+ }
+
+ MarkStackSegmentPool* Marker::GetMarkStackPool(){
+   return IsMarkingCurrentHeap() ? concurrent_marker->pool() : nullptr;
+ }
+
+ void Marker::Shade(MarkStack* stack, RawObject* ptr){
+   PSDN_ASSERT(concurrent_marker != nullptr);
+   concurrent_marker->Shade(stack, ptr);
+ }
+}
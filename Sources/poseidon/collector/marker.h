@@ -1,24 +1,130 @@
 #ifndef POSEIDON_MARKER_H
 #define POSEIDON_MARKER_H
 
+#include <functional>
+
 #include "poseidon/flags.h"
+#include "poseidon/relaxed_atomic.h"
 
 namespace poseidon{
+ class Heap;
+ class RawObject;
+ class MarkStack;
+ class MarkStackSegmentPool;
  class Marker{
   private:
+   static RelaxedAtomic<bool> concurrent_;
+   static RelaxedAtomic<bool> incremental_;
+
    static void SetMarking();
    static void ClearMarking();
 
    static void SerialMark();
    static void ParallelMark();
+   static void StartMark(bool incremental);
   public:
    Marker() = delete;
    Marker(const Marker& rhs) = delete;
    ~Marker() = delete;
 
    static bool IsMarking();
+
+   /**
+    * The number of objects that overflowed the mark stacks during the last parallel mark, they were found again by
+    * rescanning the marked objects.
+    */
+   static int64_t GetNumberOfOverflowsLastMark();
    static void MarkAllLiveObjects();
 
+   /**
+    * Returns true from {@link StartConcurrentMark()} or {@link StartIncrementalMark()} until
+    * {@link FinishConcurrentMark()}, while the write barrier has to record the references the mutator overwrites.
+    */
+   static inline bool
+   IsMarkingConcurrently(){
+     return (bool)concurrent_;
+   }
+
+   /**
+    * Returns true while the old zone of heap is being marked concurrently or incrementally. The mark belongs to the
+    * heap of the mutator that started it, the mark is only stepped, paused & finished by that mutator. On the other
+    * mutators those calls do nothing.
+    */
+   static bool IsMarkingConcurrently(Heap* heap);
+
+   /**
+    * The snapshot-at-the-beginning write barrier, called w/ the old value of a reference field before the mutator
+    * overwrites it during a concurrent mark. The object was reachable when the mark started, so it gets marked &
+    * traced even if the mutator drops the last reference to it.
+    *
+    * The mark belongs to the heap of the mutator that started it, the barrier does nothing on the other mutators.
+    *
+    * @param value The overwritten reference, a pointer returned by {@link Allocator::New()} or 0
+    */
+   static void RecordOverwrite(uword value);
+
+   /**
+    * The initial mark pause, unmarks every object & marks the roots. The references are traced by the
+    * {@link TaskPool} workers while the mutator keeps running.
+    */
+   static void StartConcurrentMark();
+
+   static inline bool
+   IsMarkingIncrementally(){
+     return (bool)incremental_;
+   }
+
+   /**
+    * The initial mark pause of an incremental mark, like {@link StartConcurrentMark()} but the references are traced
+    * by the mutator in {@link MarkStep()}s instead of by the workers.
+    */
+   static void StartIncrementalMark();
+
+   /**
+    * Traces the references left over from the last step, until {@link GetMarkStepSize()} bytes of objects were
+    * scanned or {@link GetMarkStepTime()} microseconds passed.
+    *
+    * @return true if everything reachable was traced, the mark can be finished
+    */
+   static bool MarkStep();
+
+   /**
+    * The remark pause, waits for the workers to trace everything they can reach & marks the references recorded by
+    * the write barrier since. Finishes an incremental mark too, tracing whatever the steps left over.
+    */
+   static void FinishConcurrentMark();
+
+   /**
+    * Returns true once the workers of a concurrent mark traced everything they can reach, the mark can be finished
+    * w/ {@link FinishConcurrentMark()} at the next safepoint. An incremental mark is finished by its last
+    * {@link MarkStep()}.
+    */
+   static bool IsConcurrentMarkTerminated();
+
+   /**
+    * Stops the workers of a concurrent mark before a scavenge moves the new objects they trace. The mark goes on
+    * once the scavenge is done & {@link ResumeConcurrentMark()} is called.
+    */
+   static void PauseConcurrentMark();
+   static void ResumeConcurrentMark();
+
+   /**
+    * Visits the entries of the mark stacks of the paused concurrent mark, the scavenger copies the new objects on
+    * them & updates the entries.
+    */
+   static void VisitMarkStack(const std::function<void(uword*)>& vis);
+
+   /**
+    * Returns the pool of the mark stacks of the concurrent mark, or nullptr if there's none.
+    */
+   static MarkStackSegmentPool* GetMarkStackPool();
+
+   /**
+    * Marks ptr & pushes it onto stack, so its fields get traced once the concurrent mark resumes. Called by the
+    * scavenger for the objects it promotes during a concurrent mark.
+    */
+   static void Shade(MarkStack* stack, RawObject* ptr);
+
    Marker& operator=(const Marker& rhs) = delete;
  };
 }
@@ -0,0 +1,49 @@
+#include <algorithm>
+
+#include "poseidon/collector/pause_history.h"
+
+namespace poseidon{
+ void PauseHistory::Record(Timestamp start, Timestamp finish){
+   PSDN_ASSERT(start <= finish);
+   std::lock_guard<std::mutex> guard(mutex_);
+   pauses_[num_pauses_ % kMaxNumberOfPauses] = { start, finish };
+   num_pauses_++;
+   total_ += (finish - start);
+   max_ = std::max(max_, finish - start);
+ }
+
+ Duration PauseHistory::GetPausedTime(Timestamp start, Timestamp finish) const{
+   auto paused = Duration::zero();
+   for(int64_t idx = 0; idx < GetNumberOfRecentPauses(); idx++){
+     auto& pause = pauses_[idx];
+     auto overlap_start = std::max(start, pause.start);
+     auto overlap_finish = std::min(finish, pause.finish);
+     if(overlap_start < overlap_finish)
+       paused += (overlap_finish - overlap_start);
+   }
+   return paused;
+ }
+
+ double PauseHistory::GetMinimumMutatorUtilization(Duration window, Timestamp now) const{
+   PSDN_ASSERT(window > Duration::zero());
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto max_paused = Duration::zero();
+   for(int64_t idx = 0; idx < GetNumberOfRecentPauses(); idx++){
+     auto& pause = pauses_[idx];
+     // the window starting w/ the pause, or the last window if it would end after now.
+     auto start = std::min(pause.start, now - window);
+     max_paused = std::max(max_paused, GetPausedTime(start, start + window));
+     // the window ending w/ the pause.
+     max_paused = std::max(max_paused, GetPausedTime(pause.finish - window, pause.finish));
+   }
+   auto utilization = 1.0 - (static_cast<double>(max_paused.count()) / static_cast<double>(window.count()));
+   return std::max(0.0, utilization);
+ }
+
+ void PauseHistory::Clear(){
+   std::lock_guard<std::mutex> guard(mutex_);
+   num_pauses_ = 0;
+   total_ = Duration::zero();
+   max_ = Duration::zero();
+ }
+}
@@ -0,0 +1,98 @@
+#ifndef POSEIDON_PAUSE_HISTORY_H
+#define POSEIDON_PAUSE_HISTORY_H
+
+#include <mutex>
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+
+namespace poseidon{
+ /**
+  * The most recent pauses of the mutator, for its minimum mutator utilization (MMU): the smallest fraction of any
+  * window of a given length that the mutator got to run in.
+  *
+  * Unlike the longest pause, the MMU also catches short pauses that come in bursts, ex: the steps of an incremental
+  * mark. Only the last kMaxNumberOfPauses pauses are kept.
+  */
+ class PauseHistory{
+  public:
+   static constexpr const int64_t kMaxNumberOfPauses = 256;
+  private:
+   struct Pause{
+     Timestamp start;
+     Timestamp finish;
+   };
+
+   mutable std::mutex mutex_;
+   Pause pauses_[kMaxNumberOfPauses];
+   int64_t num_pauses_;
+   Duration total_;
+   Duration max_;
+
+   inline int64_t GetNumberOfRecentPauses() const{
+     return std::min(num_pauses_, kMaxNumberOfPauses);
+   }
+
+   // the time the recent pauses took in [start, finish).
+   Duration GetPausedTime(Timestamp start, Timestamp finish) const;
+  public:
+   PauseHistory():
+    mutex_(),
+    pauses_(),
+    num_pauses_(0),
+    total_(Duration::zero()),
+    max_(Duration::zero()){
+   }
+   PauseHistory(const PauseHistory& rhs) = delete;
+   ~PauseHistory() = default;
+
+   /**
+    * The number of pauses recorded, including the ones that aren't kept anymore.
+    */
+   int64_t GetNumberOfPauses() const{
+     std::lock_guard<std::mutex> guard(mutex_);
+     return num_pauses_;
+   }
+
+   Duration GetTotalPauseTime() const{
+     std::lock_guard<std::mutex> guard(mutex_);
+     return total_;
+   }
+
+   Duration GetMaxPause() const{
+     std::lock_guard<std::mutex> guard(mutex_);
+     return max_;
+   }
+
+   void Record(Timestamp start, Timestamp finish);
+
+   /**
+    * Returns the minimum mutator utilization of the windows of the given length that end by now, the mutator ran
+    * the whole time if there are no pauses.
+    *
+    * The windows that matter start at the start of a pause or end at the end of one, so a window per pause end is
+    * checked.
+    *
+    * @param window The length of the windows, has to be positive
+    * @param now The end of the last window
+    * @return The utilization, between 0 & 1
+    */
+   double GetMinimumMutatorUtilization(Duration window, Timestamp now = Clock::now()) const;
+
+   void Clear();
+
+   PauseHistory& operator=(const PauseHistory& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const PauseHistory& val){
+     stream << "PauseHistory(";
+     stream << "pauses=" << val.GetNumberOfPauses() << ", ";
+     stream << "total=" << val.GetTotalPauseTime() << ", ";
+     stream << "max=" << val.GetMaxPause();
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_PAUSE_HISTORY_H
@@ -0,0 +1,91 @@
+#include <vector>
+#include <glog/logging.h>
+
+#include "poseidon/flags.h"
+#include "poseidon/runtime.h"
+#include "poseidon/task_pool.h"
+#include "poseidon/heap/heap.h"
+#include "poseidon/collector/refiner.h"
+
+namespace poseidon{
+ static RelaxedAtomic<int64_t> refined_(0);
+ static RelaxedAtomic<int64_t> last_refined_concurrently_(0);
+ static RelaxedAtomic<int64_t> last_refined_in_pause_(0);
+ static RelaxedAtomic<int64_t> last_cards_scanned_(0);
+
+ class RefinementTask : public Task{
+  private:
+   Heap* heap_;
+  public:
+   explicit RefinementTask(Heap* heap):
+    Task(),
+    heap_(heap){
+   }
+   ~RefinementTask() override = default;
+
+   const char* name() const override{
+     return "RefinementTask";
+   }
+
+   void Run() override{
+     refined_ += Refiner::Refine(heap_, GetRefinementBudget());
+     heap_->old_zone()->FinishRefinement();
+   }
+ };
+
+ int64_t Refiner::Refine(Heap* heap, int64_t budget){
+   auto buffer = heap->old_zone()->store_buffer();
+   std::vector<uword> slots;
+   int64_t refined = 0;
+   uword slot;
+   while(refined < budget && buffer->Pop(&slot)){
+     refined++;
+     // the mutator stores into the field before it's buffered, a store after this read gets buffered again.
+     if(heap->new_zone()->Contains(*((uword*)slot)))
+       slots.push_back(slot);
+   }
+   heap->old_zone()->RememberSlots(slots);
+   return refined;
+ }
+
+ void Refiner::ScheduleRefinement(Heap* heap){
+   if(!IsConcurrentRefinementEnabled() || !heap->old_zone()->TryStartRefinement())
+     return;
+   Runtime::GetTaskPool()->Submit(new RefinementTask(heap));
+ }
+
+ void Refiner::StopRefinement(Heap* heap){
+   heap->old_zone()->WaitForRefinement();
+   last_refined_concurrently_ = (int64_t)refined_;
+   refined_ = 0;
+ }
+
+ void Refiner::VisitRememberedSet(Heap* heap, const std::function<void(uword*)>& vis){
+   auto old_zone = heap->old_zone();
+   // fields can be overwritten after they were remembered, only the ones still referencing new objects are visited.
+   auto visit = [&](uword* slot){
+     if(heap->new_zone()->Contains(*slot))
+       vis(slot);
+   };
+
+   int64_t refined = 0;
+   uword slot;
+   while(old_zone->store_buffer()->Pop(&slot)){
+     refined++;
+     visit((uword*)slot);
+   }
+   old_zone->VisitRememberedSlots(visit);
+   auto cards = old_zone->VisitDirtyCards(visit);
+   heap->large_object_space()->VisitRememberedSlots(visit);
+
+   last_refined_in_pause_ = refined;
+   last_cards_scanned_ = cards;
+   DLOG(INFO) << "refinement stats: " << GetStats();
+ }
+
+ RefinerStats Refiner::GetStats(){
+   return { (int64_t)last_refined_concurrently_,
+            (int64_t)last_refined_in_pause_,
+            (int64_t)last_cards_scanned_ };
+ }
+}
@@ -0,0 +1,115 @@
+#ifndef POSEIDON_REFINER_H
+#define POSEIDON_REFINER_H
+
+#include <ostream>
+#include <functional>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+
+namespace poseidon{
+ class RefinerStats{
+   friend class Refiner;
+  private:
+   int64_t refined_concurrently_;
+   int64_t refined_in_pause_;
+   int64_t cards_scanned_;
+
+   RefinerStats(int64_t refined_concurrently, int64_t refined_in_pause, int64_t cards_scanned):
+    refined_concurrently_(refined_concurrently),
+    refined_in_pause_(refined_in_pause),
+    cards_scanned_(cards_scanned){
+   }
+  public:
+   RefinerStats():
+    refined_concurrently_(0),
+    refined_in_pause_(0),
+    cards_scanned_(0){
+   }
+   RefinerStats(const RefinerStats& rhs) = default;
+   ~RefinerStats() = default;
+
+   /**
+    * The number of buffered stores refined by the workers between the last two scavenges.
+    */
+   int64_t refined_concurrently() const{
+     return refined_concurrently_;
+   }
+
+   /**
+    * The number of buffered stores left for the last scavenge pause.
+    */
+   int64_t refined_in_pause() const{
+     return refined_in_pause_;
+   }
+
+   /**
+    * The number of dirty cards scanned in the last scavenge pause, stores only dirty cards once the buffer is full.
+    */
+   int64_t cards_scanned() const{
+     return cards_scanned_;
+   }
+
+   RefinerStats& operator=(const RefinerStats& rhs) = default;
+
+   friend std::ostream& operator<<(std::ostream& stream, const RefinerStats& val){
+     stream << "RefinerStats(";
+     stream << "refined_concurrently=" << val.refined_concurrently() << ", ";
+     stream << "refined_in_pause=" << val.refined_in_pause() << ", ";
+     stream << "cards_scanned=" << val.cards_scanned();
+     stream << ")";
+     return stream;
+   }
+ };
+
+ class Heap;
+ /**
+  * Moves the stores buffered by the write barrier into the remembered sets of the old pages while the mutator runs,
+  * so the scavenge pause only has to deal w/ the stores since the last refinement.
+  *
+  * A refinement is started on the {@link TaskPool} once {@link GetRefinementBudget()} stores are buffered & refines
+  * at most that many, the scavenger stops it & drains whatever is left.
+  */
+ class Refiner{
+   friend class RefinementTask;
+  public:
+   Refiner() = delete;
+   Refiner(const Refiner& rhs) = delete;
+   ~Refiner() = delete;
+
+   /**
+    * Refines up to budget of the stores buffered in the old zone of heap, the stores of fields that don't reference
+    * a new object anymore are dropped.
+    *
+    * Only called by the owner of the refinement.
+    *
+    * @return The number of stores refined
+    */
+   static int64_t Refine(Heap* heap, int64_t budget);
+
+   /**
+    * Starts a concurrent refinement for heap, unless one is already running.
+    */
+   static void ScheduleRefinement(Heap* heap);
+
+   /**
+    * Waits for the concurrent refinement of heap to finish, called before a scavenge.
+    */
+   static void StopRefinement(Heap* heap);
+
+   /**
+    * Visits the remembered fields of heap in the scavenge pause: the stores the refinement didn't get to, the
+    * remembered sets of the old pages, the dirty cards & the remembered set of the large object space.
+    *
+    * The remembered fields are forgotten before they're visited, vis has to remember the fields that still
+    * reference new objects again.
+    */
+   static void VisitRememberedSet(Heap* heap, const std::function<void(uword*)>& vis);
+
+   static RefinerStats GetStats();
+
+   Refiner& operator=(const Refiner& rhs) = delete;
+ };
+}
+
+#endif//POSEIDON_REFINER_H
@@ -1,11 +1,16 @@
 #include <deque>
+#include <vector>
 #include <glog/logging.h>
 
 #include "poseidon/utils.h"
 #include "poseidon/local.h"
 #include "poseidon/runtime.h"
 #include "poseidon/task_pool.h"
+#include "poseidon/termination_barrier.h"
 
+#include "poseidon/collector/marker.h"
+#include "poseidon/collector/refiner.h"
+#include "poseidon/collector/age_table.h"
 #include "poseidon/collector/scavenger.h"
 #include "poseidon/collector/finalizer.h"
 #include "poseidon/heap/new_zone.h"
@@ -13,12 +18,16 @@
 
 namespace poseidon{
  static RelaxedAtomic<bool> scavenging(false);
- static RelaxedAtomic<int64_t> processing(0);
 
  static AtomicTimestamp last_scavenge_ts;
  static AtomicLong last_scavenge_duration_ms;
  static AtomicPointerCounter last_scavenge_scavenged_;
  static AtomicPointerCounter last_scavenge_promoted_;
+ static RelaxedAtomic<int64_t> last_scavenge_refills_(0);
+ static RelaxedAtomic<int64_t> last_scavenge_wasted_(0);
+
+ static AgeTable survivors_;
+ static RelaxedAtomic<int64_t> tenuring_threshold_(ObjectTag::kMaxAge);
 
  bool Scavenger::IsScavenging(){
    return (bool)scavenging;
@@ -30,6 +39,9 @@ namespace poseidon{
      scavenging = true;
      last_scavenge_promoted_ = 0;
      last_scavenge_scavenged_ = 0;
+     last_scavenge_refills_ = 0;
+     last_scavenge_wasted_ = 0;
+     survivors_.Clear();
    } else{
      scavenging = false;
      last_scavenge_duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - GetLastScavengeTimestamp()).count();
@@ -68,55 +80,157 @@ namespace poseidon{
    return (int64_t)last_scavenge_promoted_.bytes;
  }
 
- uword Scavenger::ScavengeObject(Semispace* tospace, RawObject* ptr){
+ int64_t Scavenger::GetNumberOfBufferRefillsLastScavenge(){
+   return (int64_t)last_scavenge_refills_;
+ }
+
+ int64_t Scavenger::GetNumberOfBytesWastedLastScavenge(){
+   return (int64_t)last_scavenge_wasted_;
+ }
+
+ // the buffers are retired before the survivors are handed to the mutator, which allocates after them.
+ static inline void
+ RetireBuffers(CopyBuffers* buffers){
+   buffers->Retire();
+   last_scavenge_refills_ += buffers->refills();
+   last_scavenge_wasted_ += buffers->wasted();
+ }
+
+ const AgeTable& Scavenger::GetAgeTable(){
+   return survivors_;
+ }
+
+ int64_t Scavenger::GetTenuringThreshold(){
+   auto max = std::min(GetMaxTenuringThreshold(), ObjectTag::kMaxAge);
+   return std::min((int64_t)tenuring_threshold_, max);
+ }
+
+ void Scavenger::ResetTenuringThreshold(){
+   tenuring_threshold_ = ObjectTag::kMaxAge;
+ }
+
+ void Scavenger::UpdateTenuringThreshold(Heap* heap){
+   auto desired = (heap->new_zone()->semisize() * GetTargetSurvivorRatio()) / 100;
+   auto max = std::min(GetMaxTenuringThreshold(), ObjectTag::kMaxAge);
+   tenuring_threshold_ = survivors_.ComputeTenuringThreshold(desired, max);
+   GCLOG(3) << "tenuring threshold: " << GetTenuringThreshold() << " (max " << max << "), survivors: " << survivors_;
+ }
+
+ uword Scavenger::ScavengeObject(CopyBuffers* buffers, RawObject* ptr, const ObjectTag& tag){
    DLOG(INFO) << "scavenging " << ptr->ToString();
-   auto new_ptr = (RawObject*)tospace->TryAllocate(ptr->GetPointerSize());
-   new_ptr->SetPointerSize(ptr->GetPointerSize());
-   CopyObject(ptr, new_ptr);
-   last_scavenge_scavenged_ += ptr;
+   auto new_ptr = (RawObject*)buffers->TryAllocateNew(tag.GetSize());
+   if(new_ptr == nullptr)
+     return 0;
+   CopyObject(ptr, tag, new_ptr);
+   auto age = std::min(static_cast<int64_t>(tag.GetAge()) + 1, ObjectTag::kMaxAge);
+   new_ptr->SetAge(static_cast<uint8_t>(age));
    return new_ptr->GetAddress();
  }
 
- uword Scavenger::PromoteObject(OldZone* zone, RawObject* ptr){
+ uword Scavenger::PromoteObject(CopyBuffers* buffers, RawObject* ptr, const ObjectTag& tag){
    DLOG(INFO) << "promoting " << ptr->ToString() << " to new zone.";
-   auto new_ptr = (RawObject*)zone->TryAllocate(ptr->GetPointerSize());
-   CopyObject(ptr, new_ptr);
-   last_scavenge_promoted_ += ptr;
+   auto new_ptr = (RawObject*)buffers->TryAllocateOld(tag.GetSize());
+   if(new_ptr == nullptr)
+     return 0;
+   CopyObject(ptr, tag, new_ptr);
    return new_ptr->GetAddress();
  }
 
- uword Scavenger::ProcessObject(Semispace* tospace, OldZone* old_zone, RawObject* ptr){
-   DLOG(INFO) << "processing " << ptr->ToString();
-   if(!ptr->IsForwarding()){
-     if(ptr->IsRemembered()){
-       auto new_address = PromoteObject(old_zone, ptr);
-       ForwardObject(ptr, new_address);
-     } else{
-       auto new_address = ScavengeObject(tospace, ptr);
-       ForwardObject(ptr, new_address);
-     }
+ uword Scavenger::ProcessObject(CopyBuffers* buffers, RawObject* ptr, bool* copied){
+   auto header = ptr->GetHeader();
+   if(ObjectTag::ForwardingBit::Decode(header))
+     return ptr->GetForwardingAddress();
+
+   // the object is copied before it's claimed, when several workers copy it the one that forwards it first wins.
+   ObjectTag tag(header);
+   DLOG(INFO) << "processing " << tag;
+   auto promote = tag.GetAge() >= GetTenuringThreshold();
+   RawObject* new_ptr = nullptr;
+   // the survivors that don't fit in the to-space anymore are promoted early.
+   if(!promote && (new_ptr = (RawObject*)ScavengeObject(buffers, ptr, tag)) == nullptr)
+     promote = true;
+   if(promote && (new_ptr = (RawObject*)PromoteObject(buffers, ptr, tag)) == nullptr){
+     PSDN_CANT_ALLOCATE(FATAL, static_cast<int64_t>(sizeof(RawObject)) + tag.GetSize(), (*buffers->old_zone()));
+     return 0;
+   }
+   if(!ptr->TryForwardTo(header, new_ptr->GetAddress())){
+     buffers->Undo(new_ptr);
+     return ptr->GetForwardingAddress();
    }
 
-   PSDN_ASSERT(ptr->IsForwarding());
-   auto new_ptr = (RawObject*)ptr->GetForwardingAddress();
-   new_ptr->SetRememberedBit();
+   if(promote){
+     last_scavenge_promoted_ += new_ptr;
+     // allocated black like the other old objects of a concurrent mark, but it can be part of the snapshot so its
+     // fields are traced too.
+     if(buffers->marks() != nullptr)
+       Marker::Shade(buffers->marks(), new_ptr);
+   } else{
+     survivors_.Add(new_ptr->GetAge(), new_ptr->GetTotalSize());
+     last_scavenge_scavenged_ += new_ptr;
+   }
+   if(copied != nullptr)
+     (*copied) = true;
    return new_ptr->GetAddress();
  }
 
- void Scavenger::ForwardObject(RawObject* obj, uword forwarding_address){
-   DLOG(INFO) << "forwarding " << obj->ToString() << " to " << ((RawObject*) forwarding_address)->ToString();
-   obj->SetForwardingAddress(forwarding_address);
-   PSDN_ASSERT(obj->GetForwardingAddress() == forwarding_address);
+ void Scavenger::CopyObject(RawObject* src, const ObjectTag& tag, RawObject* dst){
+   memcpy(dst->GetPointer(), src->GetPointer(), tag.GetSize());
+   dst->SetClassId(tag.GetClassId());
  }
 
- void Scavenger::CopyObject(RawObject* src, RawObject* dst){//TODO: create a better copy
-   //   PSDN_ASSERT(src->GetTotalSize() == dst->GetTotalSize());
-   memcpy(dst->GetPointer(), src->GetPointer(), src->GetPointerSize());
+ RawObject* Scavenger::ProcessSlot(CopyBuffers* buffers, uword* slot, WorkStealingQueue<uword>* work){
+   auto tospace = buffers->tospace();
+   auto old_val = RawObject::FromPointer(*slot);
+   // already copied, Section::Contains includes the ending address which is the start of the other semispace.
+   if(old_val->GetAddress() >= tospace->GetStartingAddress() && old_val->GetAddress() < tospace->GetEndingAddress())
+     return old_val;
+   // the header is read once, a worker can forward the object in between.
+   auto header = old_val->GetHeader();
+   if(!ObjectTag::ForwardingBit::Decode(header) && !ObjectTag::NewBit::Decode(header))
+     return nullptr;
+
+   auto copied = false;
+   auto new_val = (RawObject*)ProcessObject(buffers, old_val, &copied);
+   (*slot) = new_val->GetObjectPointerAddress();
+   if(copied)
+     work->Push(new_val->GetAddress());
+   return new_val;
  }
 
+ void Scavenger::ProcessReferences(CopyBuffers* buffers, RawObject* ptr, WorkStealingQueue<uword>* work){
+   auto promoted = ptr->IsOld();
+   ptr->VisitPointers([&](uword* slot){
+     auto new_val = ProcessSlot(buffers, slot, work);
+     // a promoted object still referencing a new one is an old to new reference for the next scavenge.
+     if(promoted && new_val != nullptr && new_val->IsNew())
+       buffers->old_zone()->RememberSlot(slot);
+     return true;
+   });
+ }
+
+ class ClearToSpaceTask : public Task{
+  private:
+   NewZone* zone_;
+  public:
+   explicit ClearToSpaceTask(NewZone* zone):
+    Task(),
+    zone_(zone){
+   }
+   ~ClearToSpaceTask() override = default;
+
+   const char* name() const override{
+     return "ClearToSpaceTask";
+   }
+
+   void Run() override{
+     zone_->ClearToSpace();
+   }
+ };
+
  template<bool Parallel>
  class ScavengerVisitorBase : public RawObjectPointerVisitor{
   protected:
+   Heap* heap_;
    NewZone* zone_;
    Semispace from_;
    Semispace to_;
@@ -124,18 +238,43 @@ namespace poseidon{
 
    explicit ScavengerVisitorBase(Heap* heap):
     RawObjectPointerVisitor(),
+    heap_(heap),
     zone_(heap->new_zone()),
     from_(heap->new_zone()->fromspace(), heap->new_zone()->semisize()),
     to_(heap->new_zone()->tospace(), heap->new_zone()->semisize()),
     promotion_(heap->old_zone()){
    }
 
+   inline Heap* heap() const{
+     return heap_;
+   }
+
+   // the fields of the old objects that referenced new objects since the last scavenge, see Refiner.
+   inline void VisitRememberedSet(const std::function<void(uword*)>& vis){
+     Refiner::VisitRememberedSet(heap(), vis);
+   }
+
    inline void SwapSpaces(){
      GCLOG(3) << "swapping spaces.";
      return zone_->SwapSpaces();
    }
 
+   // mutators continue allocating after the survivors in the new from-space.
+   inline void ResumeAllocation(){
+     zone_->SetCurrentAddress(to_.GetCurrentAddress());
+   }
+
+   // the evacuated space is returned to the OS every so often, otherwise it's zeroed in place. When there are
+   // workers the zeroing is handed off to them & the next scavenge waits for it before copying into the space.
    inline void ClearFromSpace(){
+     if(zone_->ReleaseToSpace())
+       return;
+
+     if(IsParallel()){
+       zone_->SetClearingToSpace();
+       Runtime::GetTaskPool()->Submit(new ClearToSpaceTask(zone_));
+       return;
+     }
      from_.Clear();
    }
 
@@ -158,13 +297,18 @@ namespace poseidon{
 
  class SerialScavenger : public ScavengerVisitorBase<false>{
   private:
+   CopyBuffers buffers_;
+   // the copied objects whose fields haven't been scanned yet, scavenged & promoted alike.
+   WorkStealingQueue<uword> work_;
+
    void ProcessLocals(){
      TIMED_SECTION("ProcessLocals", {
        auto locals = LocalPage::GetLocalPageForCurrentThread();
        locals->VisitPointers([&](RawObject** ptr){
          auto old_val = (*ptr);
          if(old_val->IsNew() && !old_val->IsForwarding()){
-           auto new_val = (RawObject*)Scavenger::ProcessObject(&to_, promotion_, old_val);
+           auto new_val = (RawObject*)Scavenger::ProcessObject(&buffers_, old_val);
+           work_.Push(new_val->GetAddress());
            (*ptr) = new_val;
          }
          return true;
@@ -172,20 +316,48 @@ namespace poseidon{
      });
    }
 
+   void ProcessRememberedSet(){
+     TIMED_SECTION("ProcessRememberedSet", {
+       VisitRememberedSet([&](uword* slot){
+         auto new_val = Scavenger::ProcessSlot(&buffers_, slot, &work_);
+         if(new_val != nullptr && new_val->IsNew())
+           heap()->RememberSlot(slot);
+       });
+     });
+   }
+
+   // the new objects on the mark stacks of a paused concurrent mark are roots, the entries follow their copies.
+   void ProcessMarkStack(){
+     TIMED_SECTION("ProcessMarkStack", {
+       Marker::VisitMarkStack([&](uword* entry){
+         auto old_val = (RawObject*)(*entry);
+         if(old_val->IsForwarding()){
+           (*entry) = old_val->GetForwardingAddress();
+         } else if(old_val->IsNew()){
+           auto new_val = Scavenger::ProcessObject(&buffers_, old_val);
+           work_.Push(new_val);
+           (*entry) = new_val;
+         }
+       });
+     });
+   }
+
    void ProcessRoots() override{
      TIMED_SECTION("ProcessRoots", {
+       // the remembered set goes first, so no object has been promoted into the walked cards yet.
+       ProcessRememberedSet();
        ProcessLocals();
-       //TODO: process old to new references
+       ProcessMarkStack();
      });
    }
 
    void ProcessToSpace() override{
      TIMED_SECTION("ProcessToSpace", {
-       to_.VisitPointers([&](RawObject* val){
-         DLOG(INFO) << "scavenged: " << val->ToString();
-         //TODO: process references
-         return true;
-       });
+       uword next;
+       while((next = work_.Pop()) != 0){
+         DLOG(INFO) << "scavenged: " << ((RawObject*)next)->ToString();
+         Scavenger::ProcessReferences(&buffers_, (RawObject*)next, &work_);
+       }
      });
    }
 
@@ -199,7 +371,7 @@ namespace poseidon{
        auto locals = LocalPage::GetLocalPageForCurrentThread();
        locals->VisitPointers([&](RawObject** ptr){
          auto old_val = (*ptr);
-         if(old_val->IsNew() && old_val->IsForwarding()){
+         if(old_val->IsForwarding()){
            (*ptr) = (RawObject*)old_val->GetForwardingAddress();
          }
          return true;
@@ -208,7 +380,9 @@ namespace poseidon{
    }
   public:
    explicit SerialScavenger(Heap* heap):
-     ScavengerVisitorBase<false>(heap){
+     ScavengerVisitorBase<false>(heap),
+     buffers_(&to_, promotion_, GetCollectorLocalAllocationBufferSize(), Marker::GetMarkStackPool()),
+     work_(){
    }
    ~SerialScavenger() override = default;
 
@@ -220,7 +394,9 @@ namespace poseidon{
      SwapSpaces();
 
      ProcessAll();
+     RetireBuffers(&buffers_);
      NotifyLocals();
+     ResumeAllocation();
 
      ClearFromSpace();//TODO: Change to finalizer
    }
@@ -231,14 +407,24 @@ namespace poseidon{
    friend class ParallelScavenger;
   private:
    ParallelScavenger* scavenger_;
-   WorkStealingQueue<uword>* work_;
+   PartitionedWorkStealingQueue<uword>* work_;
+   // the copies this worker has to scan, only this worker pushes onto it & the others steal from it.
+   WorkStealingQueue<uword>* queue_;
+   TerminationBarrier* terminator_;
+   CopyBuffers* buffers_;
 
-   inline WorkStealingQueue<uword>* work() const{
+   inline PartitionedWorkStealingQueue<uword>* work() const{
      return work_;
    }
 
+   inline TerminationBarrier* terminator() const{
+     return terminator_;
+   }
+
    uword GetNext();
-   uword ProcessObject(RawObject* raw);
+   uword ProcessObject(RawObject* raw, bool* copied);
+   void ProcessReferences(RawObject* raw);
+   void Drain();
   public:
    explicit ParallelScavengerTask(ParallelScavenger* scavenger);
    ~ParallelScavengerTask() override = default;
@@ -251,31 +437,73 @@ namespace poseidon{
 
    void Run() override{
      do{
-       do{
-         uword next;
-         if((next = GetNext()) != 0){
-           processing += 1;
-           auto old_val = (RawObject*)next;
-           auto new_val = (RawObject*)ProcessObject(old_val);
-           new_val->SetRememberedBit();
-           processing -= 1;
-         }
-       } while(HasWork());
-     } while(Scavenger::IsScavenging());
+       uword next;
+       while((next = GetNext()) != 0){
+         ProcessReferences((RawObject*)next);
+         Drain();
+       }
+     } while(!terminator()->OfferTermination([this](){ return HasWork(); }));
+     terminator()->Exit();
    }
  };
 
  class ParallelScavenger : public ScavengerVisitorBase<true>{
    friend class ParallelScavengerTask;
   protected:
-   WorkStealingQueue<uword>* work_;
-
-   inline WorkStealingQueue<uword>* work() const{
+   PartitionedWorkStealingQueue<uword>* work_;
+   // the workers & the thread that scavenges the roots, which helps them once the roots are pushed.
+   TerminationBarrier terminator_;
+   // the queues of the workers, created up front so the workers can steal from the queues of the others.
+   std::vector<WorkStealingQueue<uword>*> queues_;
+   int64_t num_queues_;
+   std::vector<uword*> remembered_;
+   // the buffers of the workers, owned by the scavenger so they can be retired once the workers terminated.
+   std::vector<CopyBuffers*> buffers_;
+
+   inline PartitionedWorkStealingQueue<uword>* work() const{
      return work_;
    }
 
-   inline bool HasWork() const{
-     return !work_->empty() || processing > 0;
+   inline TerminationBarrier* terminator(){
+     return &terminator_;
+   }
+
+   // called on the thread that submits the workers, once per worker.
+   WorkStealingQueue<uword>* CreateQueue(){
+     PSDN_ASSERT(num_queues_ < static_cast<int64_t>(queues_.size()));
+     return queues_[num_queues_++];
+   }
+
+   bool HasWork() const{
+     if(!work_->empty())
+       return true;
+     for(auto& queue : queues_){
+       if(!queue->empty())
+         return true;
+     }
+     return false;
+   }
+
+   // steals a copy to scan from the queue of another worker.
+   uword Steal(WorkStealingQueue<uword>* thief) const{
+     for(auto& queue : queues_){
+       uword next;
+       if(queue != thief && !queue->empty() && (next = queue->Steal()) != 0)
+         return next;
+     }
+     return 0;
+   }
+
+   // called on the thread that submits the workers, once per worker.
+   CopyBuffers* CreateBuffers(){
+     auto buffers = new CopyBuffers(&to_, promotion_, GetCollectorLocalAllocationBufferSize(), Marker::GetMarkStackPool());
+     buffers_.push_back(buffers);
+     return buffers;
+   }
+
+   void RetireAllBuffers(){
+     for(auto& buffers : buffers_)
+       RetireBuffers(buffers);
    }
 
    void ProcessLocals(){
@@ -284,39 +512,46 @@ namespace poseidon{
        locals->VisitPointers([&](RawObject** ptr){
          auto old_val = (*ptr);
          if(old_val->IsNew() && !old_val->IsForwarding())
-           work_->Push(old_val->GetAddress());
+           work_->Push(heap()->GetNumaNodeFor(old_val->GetAddress()), old_val->GetAddress());
          return true;
        });
      });
    }
 
-   void ProcessRoots() override{
-     DTIMED_SECTION("ProcessRoots", {
-       ProcessLocals();
-       //TODO: process old to new references
-
-       // wait for work to finish.
-       while(HasWork());//spin
+   void ProcessRememberedSet(){
+     DTIMED_SECTION("ProcessRememberedSet", {
+       VisitRememberedSet([&](uword* slot){
+         auto old_val = RawObject::FromPointer(*slot);
+         if(!old_val->IsNew() && !old_val->IsForwarding())
+           return;
+         remembered_.push_back(slot);
+         if(!old_val->IsForwarding())
+           work_->Push(heap()->GetNumaNodeFor(old_val->GetAddress()), old_val->GetAddress());
+       });
      });
    }
 
-   void ProcessToSpace() override{
-     DTIMED_SECTION("ProcessToSpace", {
-       auto address = to_.GetStartingAddress();
-       while(address < to_.GetEndingAddress() && ((RawObject*)address)->IsNew()){
-         auto ptr = (RawObject*)address;
-         if(ptr->IsRemembered()){
-           DLOG(INFO) << "processing " << ptr->ToString();
-           //TODO: process references from ptr
-         }
-         address += ptr->GetTotalSize();
-       }
+   void ProcessMarkStack(){
+     DTIMED_SECTION("ProcessMarkStack", {
+       Marker::VisitMarkStack([&](uword* entry){
+         auto old_val = (RawObject*)(*entry);
+         if(old_val->IsNew() && !old_val->IsForwarding())
+           work_->Push(heap()->GetNumaNodeFor(old_val->GetAddress()), old_val->GetAddress());
+       });
+     });
+   }
 
-       // wait for work to finish.
-       while(HasWork());//spin
+   void ProcessRoots() override{
+     DTIMED_SECTION("ProcessRoots", {
+       ProcessRememberedSet();
+       ProcessLocals();
+       ProcessMarkStack();
      });
    }
 
+   // the roots are pushed, so this thread joins the workers until all of them terminated.
+   void ProcessToSpace() override;
+
    inline void ProcessAll(){
      ProcessRoots();
      ProcessToSpace();
@@ -327,26 +562,63 @@ namespace poseidon{
        auto locals = LocalPage::GetLocalPageForCurrentThread();
        locals->VisitPointers([&](RawObject** ptr){
          auto old_val = (*ptr);
-         if(old_val->IsNew() && old_val->IsForwarding()){
+         if(old_val->IsForwarding()){
            (*ptr) = (RawObject*)old_val->GetForwardingAddress();
          }
          return true;
        });
      });
    }
+
+   void NotifyMarkStack(){
+     DTIMED_SECTION("NotifyMarkStack", {
+       Marker::VisitMarkStack([&](uword* entry){
+         auto old_val = (RawObject*)(*entry);
+         if(old_val->IsForwarding())
+           (*entry) = old_val->GetForwardingAddress();
+       });
+     });
+   }
+
+   // the remembered fields are updated once their objects were copied, the ones still referencing new objects
+   // are remembered again.
+   void NotifyRememberedSet(){
+     DTIMED_SECTION("NotifyRememberedSet", {
+       for(auto& slot : remembered_){
+         auto old_val = RawObject::FromPointer(*slot);
+         if(old_val->IsForwarding())
+           (*slot) = ((RawObject*)old_val->GetForwardingAddress())->GetObjectPointerAddress();
+         if(RawObject::FromPointer(*slot)->IsNew())
+           heap()->RememberSlot(slot);
+       }
+       remembered_.clear();
+     });
+   }
   public:
    explicit ParallelScavenger(Heap* heap):
      ScavengerVisitorBase<true>(heap),
-     work_(new WorkStealingQueue<uword>(1024)){
+     work_(new PartitionedWorkStealingQueue<uword>(IsNumaEnabled() ? GetNumberOfNumaNodes() : 1, 1024)),
+     terminator_(Runtime::GetTaskPool()->GetNumberOfWorkers() + 1),
+     queues_(),
+     num_queues_(0),
+     remembered_(),
+     buffers_(){
+     for(auto idx = 0; idx < terminator_.GetNumberOfThreads(); idx++)
+       queues_.push_back(new WorkStealingQueue<uword>(1024));
    }
    ~ParallelScavenger() override{
      delete work_;
+     for(auto& queue : queues_)
+       delete queue;
+     for(auto& buffers : buffers_)
+       delete buffers;
    }
 
+   // the object is pushed like the other roots, the queue only holds objects.
    bool Visit(RawObject** ptr) override{
      auto old_val = (*ptr);
-     if(old_val != nullptr)
-       work_->Push((uword) ptr);
+     if(old_val != nullptr && old_val->IsNew() && !old_val->IsForwarding())
+       work_->Push(heap()->GetNumaNodeFor(old_val->GetAddress()), old_val->GetAddress());
      return true;
    }
 
@@ -354,7 +626,11 @@ namespace poseidon{
      SwapSpaces();
 
      ProcessAll();
+     RetireAllBuffers();
      NotifyLocals();
+     NotifyMarkStack();
+     NotifyRememberedSet();
+     ResumeAllocation();
 
      ClearFromSpace();
    }
@@ -362,20 +638,51 @@ namespace poseidon{
 
  ParallelScavengerTask::ParallelScavengerTask(ParallelScavenger* scavenger):
    Task(),
+   scavenger_(scavenger),
    work_(scavenger->work()),
-   scavenger_(scavenger){
+   queue_(scavenger->CreateQueue()),
+   terminator_(scavenger->terminator()),
+   buffers_(scavenger->CreateBuffers()){
+ }
+
+ void ParallelScavenger::ProcessToSpace(){
+   DTIMED_SECTION("ProcessToSpace", {
+     ParallelScavengerTask task(this);
+     task.Run();
+   });
+   // the workers are done w/ the queue & their buffers once they exited, the scavenger can be freed afterwards.
+   terminator_.WaitForExit();
+   GCLOG(3) << "terminated scavenge: " << terminator_;
  }
 
  bool ParallelScavengerTask::HasWork(){
-   return !work()->empty();
+   return scavenger_->HasWork();
  }
 
  uword ParallelScavengerTask::GetNext(){
-   return work()->Steal();
+   // the worker is bound to its node, so the roots of that node are copied first.
+   uword next;
+   while((next = work()->Steal(GetCurrentNumaNode())) != 0){
+     auto copied = false;
+     auto new_val = ProcessObject((RawObject*)next, &copied);
+     if(copied)
+       return new_val;
+   }
+   return scavenger_->Steal(queue_);
+ }
+
+ uword ParallelScavengerTask::ProcessObject(RawObject* raw, bool* copied){
+   return Scavenger::ProcessObject(buffers_, raw, copied);
+ }
+
+ void ParallelScavengerTask::ProcessReferences(RawObject* raw){
+   Scavenger::ProcessReferences(buffers_, raw, queue_);
  }
 
- uword ParallelScavengerTask::ProcessObject(RawObject* raw){//TODO: refactor ->zone_ & ->promotion_
-   return Scavenger::ProcessObject(&scavenger_->to_, scavenger_->promotion_, raw);
+ void ParallelScavengerTask::Drain(){
+   uword next;
+   while((next = queue_->Pop()) != 0)
+     ProcessReferences((RawObject*)next);
  }
 
  void Scavenger::SerialScavenge(Heap* heap){
@@ -386,10 +693,12 @@ namespace poseidon{
  }
 
  void Scavenger::ParallelScavenge(Heap* heap){
-   auto scavenger = new ParallelScavenger(heap);
-   Runtime::GetTaskPool()->SubmitToAll<ParallelScavengerTask>(scavenger);
+   // the workers are occupied until the scavenge finishes, so the clearing of the previous scavenge has to finish first.
+   heap->new_zone()->WaitForToSpace();
+   ParallelScavenger scavenger(heap);
+   Runtime::GetTaskPool()->SubmitToAll<ParallelScavengerTask>(&scavenger);
    DTIMED_SECTION("ParallelScavenge", {
-     scavenger->ScavengeMemory();
+     scavenger.ScavengeMemory();
    });
  }
 
@@ -400,6 +709,14 @@ namespace poseidon{
    }
 
    DLOG(INFO) << "scavenger stats (before): " << GetStats();
+   // the refinement consumes the store buffer the scavenger drains, & it needs a worker that the parallel scavenge
+   // would occupy.
+   Refiner::StopRefinement(heap);
+   // the scavenger moves the new objects a concurrent mark is tracing, the mark goes on after the scavenge.
+   Marker::PauseConcurrentMark();
+   // the collector writes to the old zone, the pages the mutator wrote to become dirty cards.
+   auto watching = heap->old_zone()->IsWatchingWrites();
+   heap->old_zone()->StopWriteWatch();
    SetScavenging();
    if(parallel){
      ParallelScavenge(heap);
@@ -407,6 +724,10 @@ namespace poseidon{
      SerialScavenge(heap);
    }
    ClearScavenging();
+   Marker::ResumeConcurrentMark();
+   UpdateTenuringThreshold(heap);
+   if(watching)
+     heap->old_zone()->StartWriteWatch();
    DLOG(INFO) << "scavenger stats (after): " << GetStats();
  }
 }
\ No newline at end of file
@@ -1,10 +1,15 @@
 #ifndef POSEIDON_SCAVENGER_H
 #define POSEIDON_SCAVENGER_H
 
+#include <vector>
+
 #include "poseidon/heap/zone.h"
 #include "poseidon/heap/heap.h"
+#include "poseidon/wsq.h"
 #include "poseidon/utils.h"
 #include "poseidon/task_pool.h"
+#include "poseidon/collector/age_table.h"
+#include "poseidon/collector/copy_buffers.h"
 
 namespace poseidon{
  class ScavengerStats{
@@ -78,6 +83,7 @@ namespace poseidon{
    friend class SerialScavenger;
 
    friend class ScavengerTest;
+   friend class ConcurrentMarkerTest;
   private:
    static void SetScavenging(bool active=true);
 
@@ -86,11 +92,39 @@ namespace poseidon{
      return SetScavenging(false);
    }
 
-   static void CopyObject(RawObject* src, RawObject* dst);
-   static void ForwardObject(RawObject* ptr, uword forwarding_address);
-   static uword PromoteObject(OldZone* zone, RawObject* ptr);
-   static uword ScavengeObject(Semispace* zone, RawObject* ptr);
-   static uword ProcessObject(Semispace* tospace, OldZone* old_zone, RawObject* ptr);
+   static void ResetTenuringThreshold();
+   // computes the tenuring threshold of the next scavenge from the ages of the survivors, see AgeTable.
+   static void UpdateTenuringThreshold(Heap* heap);
+
+   // the copies are made from tag, the header ptr had before it was copied. The header of ptr may already be
+   // replaced by the forwarding address of another worker's copy.
+   static void CopyObject(RawObject* src, const ObjectTag& tag, RawObject* dst);
+   static uword PromoteObject(CopyBuffers* buffers, RawObject* ptr, const ObjectTag& tag);
+   static uword ScavengeObject(CopyBuffers* buffers, RawObject* ptr, const ObjectTag& tag);
+   /**
+    * Copies ptr into the to-space & ages it, or promotes it into the old zone once its age reached the
+    * {@link GetTenuringThreshold()} or the to-space is exhausted. Objects that were already copied aren't copied
+    * again. Running out of the old zone as well is fatal.
+    *
+    * Workers can process the same object concurrently, each copies it into its own {@link CopyBuffers} & installs
+    * the forwarding address w/ a CAS. The copies of the losing workers are undone.
+    *
+    * @param copied Set to true if the copy of this call got installed, so the caller has to scan it
+    * @return The new location of ptr
+    */
+   static uword ProcessObject(CopyBuffers* buffers, RawObject* ptr, bool* copied = nullptr);
+   /**
+    * Copies the new object referenced by slot & updates slot, the copy is pushed onto work if it still has to be
+    * scanned.
+    *
+    * @return The new location of the referenced object, or nullptr if slot doesn't reference a new object
+    */
+   static RawObject* ProcessSlot(CopyBuffers* buffers, uword* slot, WorkStealingQueue<uword>* work);
+   /**
+    * Copies the new objects referenced by the fields of ptr & updates the fields, the copies that still have to be
+    * scanned are pushed onto work.
+    */
+   static void ProcessReferences(CopyBuffers* buffers, RawObject* ptr, WorkStealingQueue<uword>* work);
   public:
    Scavenger() = delete;
    Scavenger(const Scavenger& rhs) = delete;
@@ -111,6 +145,27 @@ namespace poseidon{
    static int64_t GetNumberOfObjectsPromotedLastScavenge();
    static int64_t GetNumberOfBytesPromotedLastScavenge();
 
+   /**
+    * Returns the number of times the workers refilled their {@link CopyBuffers} in the last scavenge.
+    */
+   static int64_t GetNumberOfBufferRefillsLastScavenge();
+
+   /**
+    * Returns the number of bytes the {@link CopyBuffers} of the workers left unused in the last scavenge.
+    */
+   static int64_t GetNumberOfBytesWastedLastScavenge();
+
+   /**
+    * Returns the number of bytes per age that survived the last scavenge.
+    */
+   static const AgeTable& GetAgeTable();
+
+   /**
+    * Returns the age at which the next scavenge promotes new objects, adapted after every scavenge so the survivors
+    * fill {@link GetTargetSurvivorRatio()} percent of a semispace. It's never above {@link GetMaxTenuringThreshold()}.
+    */
+   static int64_t GetTenuringThreshold();
+
    Scavenger& operator=(const Scavenger& rhs) = delete;
  };
 }
@@ -1,6 +1,7 @@
 #include "poseidon/wsq.h"
 #include "poseidon/runtime.h"
 #include "poseidon/task_pool.h"
+#include "poseidon/termination_barrier.h"
 #include "poseidon/heap/heap.h"
 #include "poseidon/heap/old_zone.h"
 #include "poseidon/collector/sweeper.h"
@@ -14,21 +15,40 @@ namespace poseidon{
  static RelaxedAtomic<int64_t> last_sweep_num(0);
  static RelaxedAtomic<int64_t> last_sweep_bytes(0);
 
- void Sweeper::SweepObject(FreeList* free_list, RawObject* ptr){
-   if(ptr->IsMarked())
+ void Sweeper::SweepRange(FreeList* free_list, uword start, uword end){
+   auto size = static_cast<int64_t>(end - start);
+   // too small for a free block, the dead object stays behind & keeps the page walkable.
+   if(size < FreeList::kMinimumBlockSize)
      return;
 
-   DLOG(INFO) << "sweeping " << ptr->ToString();
-   free_list->Add(ptr->GetAddress(), ptr->GetTotalSize());
+   DLOG(INFO) << "sweeping " << Bytes(size) << " @" << ((void*)start);
 #ifdef PSDN_DEBUG
-   memset(ptr->GetPointer(), 0, ptr->GetPointerSize());
+   memset((void*)start, 0, size);
 #endif//PSDN_DEBUG
-   //TODO: update ptr ObjectTag
+   free_list->Add(start, size);
 
    last_sweep_num += 1;
-   last_sweep_bytes += ptr->GetTotalSize();
+   last_sweep_bytes += size;
+ }
+
+ void Sweeper::SweepPage(FreeList* free_list, OldPage* page){
+   // an empty page is left to the zone, which either adds it as a single block or returns it to the OS.
+   if(page->marks().FindNextMarked(page->GetStartingAddress()) >= page->GetEndingAddress()){
+     page->SetEmpty();
+     return;
+   }
 
-   ptr->SetPointerSize(0);
+   page->SetEmpty(false);
+   // only the headers of the marked objects are read, everything between them is freed as a single block.
+   auto current = page->GetStartingAddress();
+   while(current < page->GetEndingAddress()){
+     auto next = page->marks().FindNextMarked(current);
+     if(next > current)
+       SweepRange(free_list, current, next);
+     if(next >= page->GetEndingAddress())
+       return;
+     current = next + ((RawObject*)next)->GetTotalSize();
+   }
  }
 
  bool Sweeper::IsSweeping(){
@@ -59,7 +79,7 @@ namespace poseidon{
    return (double)last_sweep_frag_perc;
  }
 
- int64_t Sweeper::GetNumberOfObjectsLastSweep(){
+ int64_t Sweeper::GetNumberOfBlocksLastSweep(){
    return (int64_t)last_sweep_num;
  }
 
@@ -71,14 +91,21 @@ namespace poseidon{
    friend class ParallelSweeperTask;
   protected:
    WorkStealingQueue<uword>* work_;
+   // the workers & the thread that pushes the pages, which helps them once every page was pushed.
+   TerminationBarrier* terminator_;
    FreeList* free_list_;
   public:
    explicit ParallelSweeper(OldZone* zone):
     SweeperVisitorBase<true>(zone),
     work_(new WorkStealingQueue<uword>(1024)),
+    terminator_(new TerminationBarrier(Runtime::GetTaskPool()->GetNumberOfWorkers() + 1)),
     free_list_(zone->free_list()){
    }
-   ~ParallelSweeper() override = default;//TODO: free work_
+   ParallelSweeper(const ParallelSweeper& rhs) = delete;
+   ~ParallelSweeper() override{
+     delete work_;
+     delete terminator_;
+   }
 
    inline FreeList* free_list() const{
      return free_list_;
@@ -88,30 +115,28 @@ namespace poseidon{
      return work_;
    }
 
-   bool Visit(RawObject* ptr) override{
-     if(!ptr->IsMarked())
-       work()->Push(ptr->GetAddress());
-     return true;
+   TerminationBarrier* terminator() const{
+     return terminator_;
    }
 
-   void Sweep() override{
-     zone()->VisitPages([&](OldPage* page){
-       page->VisitPointers(this);
-       return true;
-     });
-   }
+   void Sweep() override;
  };
 
  class ParallelSweeperTask : public Task{
    friend class ParallelSweeperTask;
   private:
    WorkStealingQueue<uword>* work_;
+   TerminationBarrier* terminator_;
    FreeList* free_list_;
 
    inline FreeList* free_list() const{
      return free_list_;
    }
 
+   inline TerminationBarrier* terminator() const{
+     return terminator_;
+   }
+
    inline bool HasWork(){
      return !work_->empty();
    }
@@ -120,10 +145,11 @@ namespace poseidon{
      return work_->Steal();
    }
   public:
-   explicit ParallelSweeperTask(ParallelSweeper& sweeper):
+   explicit ParallelSweeperTask(ParallelSweeper* sweeper):
     Task(),
-    work_(sweeper.work()),
-    free_list_(sweeper.free_list()){
+    work_(sweeper->work()),
+    terminator_(sweeper->terminator()),
+    free_list_(sweeper->free_list()){
    }
    ~ParallelSweeperTask() override = default;
 
@@ -133,16 +159,42 @@ namespace poseidon{
 
    void Run() override{
      do{
-       do{
-         uword next;
-         if((next = GetNext()) != 0){
-           Sweeper::SweepObject(free_list(), (RawObject*)next);
-         }
-       } while(HasWork());
-     } while(Sweeper::IsSweeping());
+       uword next;
+       while((next = GetNext()) != 0)
+         Sweeper::SweepPage(free_list(), (OldPage*)next);
+     } while(!terminator()->OfferTermination([this](){ return HasWork(); }));
+     terminator()->Exit();
    }
  };
 
+ void SerialSweeper::Sweep(){
+   // the free list is rebuilt from the marks, every byte that isn't part of a marked object ends up in a block.
+   free_list()->Clear();
+   TIMED_SECTION("SweepingPages", {
+     zone()->VisitPages([&](OldPage* page){
+       if(zone()->IsCommitted(page))
+         Sweeper::SweepPage(free_list(), page);
+       return true;
+     });
+   });
+ }
+
+ void ParallelSweeper::Sweep(){
+   free_list()->Clear();
+   zone()->VisitPages([&](OldPage* page){
+     if(zone()->IsCommitted(page))
+       work()->Push((uword)page);
+     return true;
+   });
+
+   // the sweep is done once the workers swept every page pushed, this thread helps them.
+   ParallelSweeperTask task(this);
+   task.Run();
+   // the workers are done w/ the queue once they exited, the sweeper can be freed afterwards.
+   terminator_->WaitForExit();
+   GCLOG(3) << "terminated sweep: " << (*terminator_);
+ }
+
  static inline double
  GetPercentageFreeInFreeList(OldZone* zone){
    return GetPercentageOf(zone->free_list()->GetTotalBytesFree(), zone->GetSize());
@@ -157,12 +209,21 @@ namespace poseidon{
 
  void Sweeper::ParallelSweep(OldZone* old_zone){
    ParallelSweeper sweeper(old_zone);
-   Runtime::GetTaskPool()->SubmitToAll<ParallelSweeperTask>(sweeper);
+   Runtime::GetTaskPool()->SubmitToAll<ParallelSweeperTask>(&sweeper);
    TIMED_SECTION("ParallelSweep", {
      sweeper.Sweep();
    });
  }
 
+ void Sweeper::SweepLargeObjects(LargeObjectSpace* space){
+   TIMED_SECTION("SweepLargeObjects", {
+     int64_t num_freed = 0;
+     auto bytes_freed = space->Sweep(&num_freed);
+     last_sweep_num += num_freed;
+     last_sweep_bytes += bytes_freed;
+   });
+ }
+
  void Sweeper::Sweep(){
    if(IsSweeping()){
      DLOG(WARNING) << "already sweeping.";
@@ -181,17 +242,11 @@ namespace poseidon{
    } else{
      SerialSweep(old_zone);
    }
+   SweepLargeObjects(heap->large_object_space());
+   old_zone->ForgetFreeSlots();
    ClearSweeping();
    double perc_free_after = GetPercentageFreeInFreeList(old_zone);
    last_sweep_frag_perc = perc_free_after - perc_free_before;
    DLOG(INFO) << "sweeper stats (after): " << GetStats();
  }
-
- bool SerialSweeper::Visit(RawObject* ptr){
-   DLOG(INFO) << "checking: " << ptr->ToString();
-   if(ptr->IsMarked())
-     return true; // don't sweep marked objects
-   Sweeper::SweepObject(free_list(), ptr);
-   return true;
- }
 }
@@ -5,6 +5,7 @@
 #include "poseidon/common.h"
 #include "poseidon/freelist.h"
 #include "poseidon/heap/old_zone.h"
+#include "poseidon/heap/large_object_space.h"
 
 namespace poseidon{
  class SweeperStats{
@@ -12,28 +13,28 @@ namespace poseidon{
   private:
    Timestamp start_ts_;
    int64_t duration_ms_;
-   int64_t num_finalized_;
-   int64_t bytes_finalized_;
+   int64_t num_blocks_;
+   int64_t bytes_freed_;
    double frag_perc_;
 
    SweeperStats(Timestamp ts,
                 int64_t duration_ms,
                 double frag_percentage,
-                int64_t num_finalized,
-                int64_t bytes_finalized):
+                int64_t num_blocks,
+                int64_t bytes_freed):
      start_ts_(ts),
      duration_ms_(duration_ms),
      frag_perc_(frag_percentage),
-     num_finalized_(num_finalized),
-     bytes_finalized_(bytes_finalized){
+     num_blocks_(num_blocks),
+     bytes_freed_(bytes_freed){
    }
   public:
    SweeperStats():
      start_ts_(Clock::now()),
      duration_ms_(0),
      frag_perc_(0),
-     num_finalized_(0),
-     bytes_finalized_(0){
+     num_blocks_(0),
+     bytes_freed_(0){
    }
    SweeperStats(const SweeperStats& rhs) = default;
    ~SweeperStats() = default;
@@ -46,12 +47,12 @@ namespace poseidon{
      return duration_ms_;
    }
 
-   int64_t num_finalized() const{
-     return num_finalized_;
+   int64_t num_blocks() const{
+     return num_blocks_;
    }
 
-   int64_t bytes_finalized() const{
-     return bytes_finalized_;
+   int64_t bytes_freed() const{
+     return bytes_freed_;
    }
 
    double fragmentation_perc() const{
@@ -63,7 +64,7 @@ namespace poseidon{
    friend std::ostream& operator<<(std::ostream& stream, const SweeperStats& val){
      stream << "SweeperStats(";//TODO: add start_ts
      stream << "duration=" << val.duration_ms() << "ms, ";
-     stream << "finalized=" << val.num_finalized() << " (" << Bytes(val.bytes_finalized()) << "), ";
+     stream << "freed=" << val.num_blocks() << " blocks (" << Bytes(val.bytes_freed()) << "), ";
      stream << "fragmentation=" << PrettyPrintPercentage(val.fragmentation_perc());
      stream << ")";
      return stream;
@@ -71,12 +72,11 @@ namespace poseidon{
  };
 
  template<bool Parallel>
- class SweeperVisitorBase : public RawObjectVisitor{
+ class SweeperVisitorBase{
   protected:
    OldZone* zone_;
 
    explicit SweeperVisitorBase(OldZone* zone):
-    RawObjectVisitor(),
     zone_(zone){
    }
 
@@ -84,7 +84,7 @@ namespace poseidon{
      return zone_;
    }
   public:
-   ~SweeperVisitorBase() override = default;
+   virtual ~SweeperVisitorBase() = default;
 
    inline bool IsParallel() const{
      return Parallel;
@@ -108,31 +108,7 @@ namespace poseidon{
    }
    ~SerialSweeper() override = default;
 
-   bool Visit(RawObject* ptr) override;
-
-   void SweepPage(OldPage* page){
-     TIMED_SECTION("SweepingPage", {
-       auto current = page->GetStartingAddress();
-       while(current < page->GetEndingAddress() && ((RawObject*)current)->GetPointerSize() > 0){
-         auto ptr = (RawObject*)current;
-         auto size = ptr->GetTotalSize();
-
-         if(!Visit(ptr))
-           return;
-
-         current += size;
-       }
-     });
-   }
-
-   void Sweep() override{
-     TIMED_SECTION("SweepingPages", {
-       zone()->VisitPages([&](OldPage* page){
-         SweepPage(page);
-         return true;
-       });
-     });
-   }
+   void Sweep() override;
  };
 
  class OldZone;
@@ -149,10 +125,12 @@ namespace poseidon{
      SetSweeping(false);
    }
 
-   static void SweepObject(FreeList* free_list, RawObject* ptr);
+   static void SweepRange(FreeList* free_list, uword start, uword end);
+   static void SweepPage(FreeList* free_list, OldPage* page);
 
    static void SerialSweep(OldZone* old_zone);
    static void ParallelSweep(OldZone* old_zone);
+   static void SweepLargeObjects(LargeObjectSpace* space);
   public:
    Sweeper() = delete;
    Sweeper(const Sweeper& rhs) = delete;
@@ -165,13 +143,18 @@ namespace poseidon{
    static int64_t GetLastSweepDurationMillis();
    static double GetLastSweepFragmentationPercentage();
    static int64_t GetNumberOfBytesLastSweep();
-   static int64_t GetNumberOfObjectsLastSweep();
+
+   /**
+    * The number of free blocks the last sweep created, the dead objects between two marked objects become a single
+    * block.
+    */
+   static int64_t GetNumberOfBlocksLastSweep();
 
    static SweeperStats GetStats(){
      return {GetLastSweepTimestamp(),
              GetLastSweepDurationMillis(),
              GetLastSweepFragmentationPercentage(),
-             GetNumberOfObjectsLastSweep(),
+             GetNumberOfBlocksLastSweep(),
              GetNumberOfBytesLastSweep()};
    }
 
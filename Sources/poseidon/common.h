@@ -1,6 +1,7 @@
 #ifndef POSEIDON_COMMON_H
 #define POSEIDON_COMMON_H
 
+#include <cassert>
 #include <cstdint>
 #include <iostream>
 
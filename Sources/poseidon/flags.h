@@ -8,18 +8,84 @@ namespace poseidon{
  static constexpr const int64_t kDefaultNewZoneSize = 16 * kMB;
  DECLARE_int64(new_zone_size);
 
+ static constexpr const int64_t kDefaultMaxTenuringThreshold = 15;
+ DECLARE_int64(max_tenuring_threshold);
+
+ static constexpr const int64_t kDefaultTargetSurvivorRatio = 50;
+ DECLARE_int64(target_survivor_ratio);
+
+ static constexpr const int64_t kDefaultLocalAllocationBufferSize = 256 * kKB;
+ DECLARE_int64(tlab_size);
+
+ static constexpr const int64_t kDefaultCollectorLocalAllocationBufferSize = 64 * kKB;
+ DECLARE_int64(gclab_size);
+
  static constexpr const int64_t kDefaultOldZoneSize = 512 * kMB;
  DECLARE_int64(old_zone_size);
 
+ static constexpr const int64_t kDefaultOldZoneCommittedSize = 64 * kMB;
+ DECLARE_int64(old_zone_committed_size);
+
  static constexpr const int64_t kDefaultOldPageSize = 16 * kMB;
  DECLARE_int64(old_page_size);
 
  static constexpr const int64_t kDefaultLargeObjectSize = 1 * kMB;
  DECLARE_int64(large_object_size);
 
+ static constexpr const int64_t kDefaultLargeObjectSpaceSize = 4 * kGB;
+ DECLARE_int64(large_object_space_size);
+
+ static constexpr const char* kDefaultHugePages = "none";
+ DECLARE_string(huge_pages);
+
+ static constexpr const bool kDefaultPreFault = false;
+ DECLARE_bool(pre_fault);
+
+ static constexpr const char* kDefaultMemoryReleaseMode = "dontneed";
+ DECLARE_string(memory_release_mode);
+
+ static constexpr const int64_t kDefaultMemoryReleaseDelay = 2;
+ DECLARE_int64(memory_release_delay);
+
+ static constexpr const bool kDefaultNuma = false;
+ DECLARE_bool(numa);
+
+ static constexpr const char* kDefaultNumaTopology = "";
+ DECLARE_string(numa_topology);
+
  static constexpr const int64_t kDefaultNumberOfWorkers = 2;
  DECLARE_int64(num_workers);
 
+ static constexpr const int64_t kDefaultMarkStackSize = 4 * kMB;
+ DECLARE_int64(mark_stack_size);
+
+ static constexpr const bool kDefaultConcurrentMark = false;
+ DECLARE_bool(concurrent_mark);
+
+ static constexpr const int64_t kDefaultConcurrentMarkThreshold = 45;
+ DECLARE_int64(concurrent_mark_threshold);
+
+ static constexpr const bool kDefaultIncrementalMark = false;
+ DECLARE_bool(incremental_mark);
+
+ static constexpr const int64_t kDefaultMarkStepSize = 256 * kKB;
+ DECLARE_int64(mark_step_size);
+
+ static constexpr const int64_t kDefaultMarkStepTime = 500;
+ DECLARE_int64(mark_step_time);
+
+ static constexpr const int64_t kDefaultMutatorUtilizationWindow = 10 * 1000;
+ DECLARE_int64(mmu_window);
+
+ static constexpr const int64_t kDefaultStoreBufferSize = 16 * 1024;
+ DECLARE_int64(store_buffer_size);
+
+ static constexpr const int64_t kDefaultRefinementBudget = 1024;
+ DECLARE_int64(refinement_budget);
+
+ static constexpr const bool kDefaultPageProtection = false;
+ DECLARE_bool(page_protection);
+
  static constexpr const char* kDefaultReportDirectory = "";
  DECLARE_string(report_directory);
 
@@ -38,11 +104,46 @@ namespace poseidon{
    return FLAGS_new_zone_size;
  }
 
+ static inline int64_t
+ GetMaxTenuringThreshold(){
+   return FLAGS_max_tenuring_threshold;
+ }
+
+ static inline int64_t
+ GetTargetSurvivorRatio(){
+   return FLAGS_target_survivor_ratio;
+ }
+
+ static inline int64_t
+ GetLocalAllocationBufferSize(){
+   return FLAGS_tlab_size;
+ }
+
+ static inline bool
+ HasLocalAllocationBuffers(){
+   return GetLocalAllocationBufferSize() > 0;
+ }
+
+ static inline int64_t
+ GetCollectorLocalAllocationBufferSize(){
+   return FLAGS_gclab_size;
+ }
+
+ static inline bool
+ HasCollectorLocalAllocationBuffers(){
+   return GetCollectorLocalAllocationBufferSize() > 0;
+ }
+
  static inline int64_t
  GetOldZoneSize(){
    return FLAGS_old_zone_size;
  }
 
+ static inline int64_t
+ GetOldZoneCommittedSize(){
+   return FLAGS_old_zone_committed_size;
+ }
+
  static inline int64_t
  GetOldPageSize(){
    return FLAGS_old_page_size;
@@ -53,6 +154,61 @@ namespace poseidon{
    return FLAGS_large_object_size;
  }
 
+ static inline int64_t
+ GetLargeObjectSpaceSize(){
+   return FLAGS_large_object_space_size;
+ }
+
+ static inline std::string
+ GetHugePages(){
+   return FLAGS_huge_pages;
+ }
+
+ static inline bool
+ HasHugePages(){
+   return GetHugePages() != "none";
+ }
+
+ static inline bool
+ IsPreFaultEnabled(){
+   return FLAGS_pre_fault;
+ }
+
+ static inline std::string
+ GetMemoryReleaseMode(){
+   return FLAGS_memory_release_mode;
+ }
+
+ static inline bool
+ HasMemoryRelease(){
+   return GetMemoryReleaseMode() != "none";
+ }
+
+ static inline bool
+ IsLazyMemoryRelease(){
+   return GetMemoryReleaseMode() == "free";
+ }
+
+ static inline int64_t
+ GetMemoryReleaseDelay(){
+   return FLAGS_memory_release_delay;
+ }
+
+ static inline bool
+ IsNumaEnabled(){
+   return FLAGS_numa;
+ }
+
+ static inline std::string
+ GetNumaTopologyString(){
+   return FLAGS_numa_topology;
+ }
+
+ static inline bool
+ HasNumaTopology(){
+   return !GetNumaTopologyString().empty();
+ }
+
  static inline int64_t
  GetNumberOfWorkers(){
    return FLAGS_num_workers;
@@ -63,6 +219,61 @@ namespace poseidon{
    return GetNumberOfWorkers() > 0;
  }
 
+ static inline int64_t
+ GetMarkStackSize(){
+   return FLAGS_mark_stack_size;
+ }
+
+ static inline bool
+ IsConcurrentMarkEnabled(){
+   return HasWorkers() && FLAGS_concurrent_mark;
+ }
+
+ static inline int64_t
+ GetConcurrentMarkThreshold(){
+   return FLAGS_concurrent_mark_threshold;
+ }
+
+ static inline bool
+ IsIncrementalMarkEnabled(){
+   return FLAGS_incremental_mark;
+ }
+
+ static inline int64_t
+ GetMarkStepSize(){
+   return FLAGS_mark_step_size;
+ }
+
+ static inline int64_t
+ GetMarkStepTime(){
+   return FLAGS_mark_step_time;
+ }
+
+ static inline int64_t
+ GetMutatorUtilizationWindow(){
+   return FLAGS_mmu_window;
+ }
+
+ static inline int64_t
+ GetStoreBufferSize(){
+   return FLAGS_store_buffer_size;
+ }
+
+ static inline int64_t
+ GetRefinementBudget(){
+   return FLAGS_refinement_budget;
+ }
+
+ static inline bool
+ IsConcurrentRefinementEnabled(){
+   return HasWorkers() && GetRefinementBudget() > 0;
+ }
+
+ static inline bool
+ IsPageProtectionEnabled(){
+   return FLAGS_page_protection;
+ }
+
  static inline int64_t
  GetTotalInitialHeapSize(){
    return GetNewZoneSize() + GetOldZoneSize();
@@ -1,105 +1,129 @@
 #include "poseidon/freelist.h"
 
 namespace poseidon{
- static inline bool
- CanSplit(FreeList::Node* node, int64_t size){
-   return (node->size - size) >= kWordSize;
+ static inline int64_t
+ AlignSize(int64_t size){
+   return (size + (kWordSize - 1)) & ~(kWordSize - 1);
  }
 
- static inline FreeList::Node*
- Split(FreeList::Node* node, int64_t size){
-   auto new_size = node->size - size;
-   auto new_start = node->start + size;
-   return new FreeList::Node(new_start, new_size);
+ static inline bool
+ CanSplit(FreeList::Node* node, int64_t size){
+   return (node->GetSize() - size) >= FreeList::kMinimumBlockSize;
  }
 
- static inline void
- InsertAfter(FreeList::Node* previous, FreeList::Node* node){
-   node->previous = previous;
-   node->next = previous->next;
-   node->previous->next = node;
-   if(node->next)
-     node->next->previous = node;
+ FreeList::Node* FreeList::Initialize(uword address, int64_t size){
+   auto tag = ObjectTag::OldWithSize(size - static_cast<int64_t>(sizeof(RawObject)));
+   tag.SetFree();
+   auto node = Node::From(new ((void*)address)RawObject(tag));
+   node->next = nullptr;
+   return node;
  }
 
- static inline void
- Append(FreeList::Node* tail, FreeList::Node* node){
-   node->previous = tail;
-   tail->next = node;
+ FreeList::Node* FreeList::Split(Node* node, int64_t size){
+   auto new_size = node->GetSize() - size;
+   auto new_start = node->GetStartingAddress() + size;
+   node->GetHeader()->SetPointerSize(size - sizeof(RawObject));
+   return Initialize(new_start, new_size);
  }
 
- static inline void
- InsertBefore(FreeList::Node* next, FreeList::Node* node){
-   return InsertAfter(next->previous, node);
+ FreeList::FreeList(uword start, int64_t size):
+  buckets_(),
+  non_empty_(0),
+  generation_(0),
+  free_bytes_(0){
+   Add(start, size);
  }
 
- FreeList::Node* FreeList::FindBestFit(int64_t size){
-   std::lock_guard<std::mutex> guard(mutex_);
-   auto current = list_;
-   while(current != nullptr && current->size < size)
-     current = current->next;
-   return current;
+ void FreeList::Insert(Node* node){
+   auto index = GetBucketIndexFor(node->GetSize());
+   bucket(index)->Push(node);
+   non_empty_.fetch_or(kUWordOne << index, std::memory_order_release);
+   generation_.fetch_add(1);
  }
 
- void FreeList::Remove(Node* node){
-   std::lock_guard<std::mutex> guard(mutex_);
-   if(node == list_){
-     list_ = list_->next;
-     return;
+ FreeList::Node* FreeList::FindFirstFit(int64_t size){
+   auto index = GetFirstFitIndexFor(size);
+   if(index >= kNumberOfBuckets)
+     return nullptr;
+
+   // a block another thread popped comes back as its remainder. A search that saw an insert searches once more,
+   // otherwise it misses right away instead of waiting for the other threads.
+   for(auto attempt = 0; attempt < 2; attempt++){
+     auto generation = generation_.load();
+     auto candidates = non_empty_.load(std::memory_order_acquire) & ~((kUWordOne << index) - 1);
+     while(candidates != 0){
+       auto next = static_cast<int64_t>(__builtin_ctzl(candidates));
+       Node* node;
+       if((node = bucket(next)->Pop()) != nullptr){
+         PSDN_ASSERT(node->GetSize() >= size);
+         return node;
+       }
+
+       // the bucket was drained by another thread, clear its bit unless a block was pushed in the meantime.
+       auto mask = kUWordOne << next;
+       non_empty_.fetch_and(~mask, std::memory_order_acq_rel);
+       if(!bucket(next)->IsEmpty())
+         non_empty_.fetch_or(mask, std::memory_order_release);
+       candidates &= ~mask;
+     }
+
+     if(generation_.load() == generation)
+       return nullptr;
    }
-
-   auto previous = node->previous;
-   auto next = node->next;
-   if(previous)
-     previous->next = next;
-   if(next)
-     next->previous = previous;
+   return nullptr;
  }
 
  void FreeList::Add(uword address, int64_t size){
-   std::lock_guard<std::mutex> guard(mutex_);
-   auto node = list_;
-   while(node->next != nullptr)
-     node = node->next;
-   Append(node, new Node(address, size));
+   if(size < kMinimumBlockSize){
+     DLOG(WARNING) << "cannot add block of " << Bytes(size) << " @" << ((void*)address) << " to FreeList, it is too small.";
+     return;
+   }
+   Insert(Initialize(address, size));
    free_bytes_ += size;
  }
 
- uword FreeList::TryAllocate(int64_t size){
+ uword FreeList::TryAllocate(int64_t size, int64_t* allocated){
    if(size < kWordSize){
      DLOG(WARNING) << "object size " << Bytes(size) << " is smaller than a word, cannot allocate in FreeList.";
      return 0;
    }
 
-   auto total_size = static_cast<int64_t>(sizeof(RawObject) + size);
-
-   //TODO: align size
-   auto best_fit = FindBestFit(total_size);
-   if(!best_fit){
+   auto total_size = AlignSize(static_cast<int64_t>(sizeof(RawObject) + size));
+   Node* best_fit;
+   if((best_fit = FindFirstFit(total_size)) == nullptr){
      DLOG(WARNING) << "couldn't find best fit in FreeList for object of " << Bytes(total_size) << ".";
      return 0;
    }
 
-   if(CanSplit(best_fit, total_size)){
-     std::lock_guard<std::mutex> guard(mutex_);
-     auto new_node = Split(best_fit, total_size);
-     InsertAfter(list_, new_node);
-   }
+   if(CanSplit(best_fit, total_size))
+     Insert(Split(best_fit, total_size));
 
-   Remove(best_fit);
+   auto start = best_fit->GetStartingAddress();
+   auto block_size = best_fit->GetSize();
 #ifdef PSDN_DEBUG
-   memset((void*)best_fit->start, 0, best_fit->size);
+   memset((void*)start, 0, block_size);
 #endif//PSDN_DEBUG
-   free_bytes_ -= size;
-   return best_fit->start;
+   free_bytes_ -= block_size;
+   if(allocated)
+     (*allocated) = block_size;
+   return start;
+ }
+
+ void FreeList::Clear(){
+   for(auto& bucket : buckets_)
+     bucket.Clear();
+   non_empty_.store(0, std::memory_order_release);
+   free_bytes_ = 0;
  }
 
  void FreeList::VisitFreeList(const std::function<bool(Node*)>& vis) const{
-   auto node = list_;
-   while(node != nullptr){
-     if(!vis(node))
-       return;
-     node = node->next;
+   for(auto& bucket : buckets_){
+     auto node = bucket.Peek();
+     while(node != nullptr){
+       if(!vis(node))
+         return;
+       node = node->next;
+     }
    }
  }
 
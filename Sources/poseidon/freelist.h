@@ -1,6 +1,7 @@
 #ifndef POSEIDON_FREELIST_H
 #define POSEIDON_FREELIST_H
 
+#include <atomic>
 #include <cstdlib>
 #include <utility>
 #include <glog/logging.h>
@@ -10,63 +11,179 @@
 #include "poseidon/raw_object.h"
 #include "poseidon/platform/platform.h"
 
-namespace poseidon{ //TODO: atomic support?
+namespace poseidon{
+ /**
+  * A segregated-fit free list.
+  *
+  * Free blocks are binned by the floor of the log2 of their size, each bucket is a lock-free stack & a bitmap tracks
+  * the non-empty buckets so finding a fit is a single bit scan. Blocks are never coalesced.
+  *
+  * An allocation pops a block & puts the remainder back, so a bucket can look empty while its block is being split.
+  * A search that raced w/ an insert is repeated once, but it never waits for the other threads. So a miss can be
+  * spurious while other threads split the only large enough blocks, the caller falls back like on any other miss.
+  */
  class FreeList{ //TODO: relocate
   public:
+   friend class OldZone;
    friend class Sweeper;
+   friend class FreeListTest;
   public:
+   static constexpr const int64_t kNumberOfBuckets = kBitsPerWord;
+   static constexpr const int64_t kMinimumBlockSize = sizeof(RawObject) + kWordSize;
+
+   /**
+    * The link of a free block, stored in the block itself right after a free {@link RawObject} header. The header
+    * keeps the size of the block & lets walks over the zone step over it.
+    */
    struct Node{
-     Node* previous;
      Node* next;
 
-     uword start;
-     int64_t size;
+     uword GetStartingAddress() const{
+       return reinterpret_cast<uword>(this) - sizeof(RawObject);
+     }
 
-     Node() = default;
-     Node(uword starting_address, int64_t total_size):
-       previous(nullptr),
-       next(nullptr),
-       start(starting_address),
-       size(total_size){
+     RawObject* GetHeader() const{
+       return (RawObject*)GetStartingAddress();
      }
-     Node(const Node& rhs) = default;
-     ~Node() = default;
 
-     Node& operator=(const Node& rhs) = default;
+     int64_t GetSize() const{
+       return GetHeader()->GetTotalSize();
+     }
+
+     static inline Node*
+     From(RawObject* header){
+       PSDN_ASSERT(header->IsFree());
+       return (Node*)header->GetPointer();
+     }
 
      friend std::ostream& operator<<(std::ostream& stream, const Node& val){
-       return stream << "Node(start=" << ((void*) val.start) << ", size=" << Bytes(val.size) << ")";
+       return stream << "Node(start=" << ((void*) val.GetStartingAddress()) << ", size=" << Bytes(val.GetSize()) << ")";
      }
    };
+
+   class Bucket{
+    private:
+     // the head is tagged w/ a counter in the upper bits to avoid ABA between concurrent pops & pushes.
+     static constexpr const int kPointerBits = 48;
+     static constexpr const uword kPointerMask = (kUWordOne << kPointerBits) - 1;
+
+     static inline Node*
+     GetNode(uword head){
+       return (Node*)(head & kPointerMask);
+     }
+
+     static inline uword
+     GetNextTag(uword head){
+       return ((head >> kPointerBits) + 1) << kPointerBits;
+     }
+
+     std::atomic<uword> head_;
+    public:
+     Bucket():
+      head_(0){
+     }
+     Bucket(const Bucket& rhs) = delete;
+     ~Bucket() = default;
+
+     bool IsEmpty() const{
+       return GetNode(head_.load(std::memory_order_acquire)) == nullptr;
+     }
+
+     Node* Peek() const{
+       return GetNode(head_.load(std::memory_order_acquire));
+     }
+
+     void Push(Node* node){
+       auto head = head_.load(std::memory_order_relaxed);
+       do{
+         node->next = GetNode(head);
+       } while(!head_.compare_exchange_weak(head, GetNextTag(head) | (uword)node, std::memory_order_release, std::memory_order_relaxed));
+     }
+
+     void Clear(){
+       head_.store(GetNextTag(head_.load(std::memory_order_relaxed)), std::memory_order_release);
+     }
+
+     Node* Pop(){
+       auto head = head_.load(std::memory_order_acquire);
+       Node* node;
+       do{
+         if((node = GetNode(head)) == nullptr)
+           return nullptr;
+       } while(!head_.compare_exchange_weak(head, GetNextTag(head) | (uword)node->next, std::memory_order_acq_rel, std::memory_order_acquire));
+       return node;
+     }
+
+     Bucket& operator=(const Bucket& rhs) = delete;
+   };
+
+   static inline int64_t
+   GetBucketIndexFor(int64_t size){
+     PSDN_ASSERT(size > 0);
+     return static_cast<int64_t>(kBitsPerWord - 1 - __builtin_clzl(static_cast<uword>(size)));
+   }
+
+   /**
+    * Returns the first bucket where every block is large enough for size bytes.
+    */
+   static inline int64_t
+   GetFirstFitIndexFor(int64_t size){
+     auto index = GetBucketIndexFor(size);
+     return IsPow2(size) ? index : index + 1;
+   }
   private:
-   std::mutex mutex_;//TODO: remove mutex?
-   Node* list_;
+   Bucket buckets_[kNumberOfBuckets];
+   std::atomic<uword> non_empty_;
+   // the number of inserts, a search that raced w/ one is repeated once.
+   std::atomic<uword> generation_;
    RelaxedAtomic<int64_t> free_bytes_;
 
-   Node* FindBestFit(int64_t size);
-   virtual void Remove(Node* node);
+   inline Bucket* bucket(int64_t index){
+     PSDN_ASSERT(index >= 0 && index < kNumberOfBuckets);
+     return &buckets_[index];
+   }
+
+   static Node* Initialize(uword address, int64_t size);
+   static Node* Split(Node* node, int64_t size);
+
+   void Insert(Node* node);
+   Node* FindFirstFit(int64_t size);
+  protected:
    virtual void Add(uword address, int64_t size);
   public:
-   FreeList() = delete;
-   FreeList(uword start, int64_t size):
-    mutex_(),
-    list_(new Node(start, size)),
-    free_bytes_(size){
+   FreeList():
+    buckets_(),
+    non_empty_(0),
+    generation_(0),
+    free_bytes_(0){
    }
+   FreeList(uword start, int64_t size);
    FreeList(const FreeList& rhs) = delete;
-   virtual ~FreeList(){
-     delete list_;
-   }
+   virtual ~FreeList() = default;
 
    int64_t GetTotalBytesFree() const{
      return (int64_t)free_bytes_;
    }
 
-   virtual uword TryAllocate(int64_t size);
+   /**
+    * Allocates a block for an object of size bytes, safe to call from multiple threads.
+    *
+    * @param size The size of the object
+    * @param allocated Set to the total size of the block, which includes slack too small to be split off
+    * @return The starting address of the block, or 0 if no block is large enough
+    */
+   virtual uword TryAllocate(int64_t size, int64_t* allocated = nullptr);
+
+   /**
+    * Drops every block from this {@link FreeList}, the blocks themselves are left untouched.
+    *
+    * Not safe to call while other threads are allocating.
+    */
+   void Clear();
    void VisitFreeList(const std::function<bool(Node*)>& vis) const;
  };
 
  void PrintFreeList(FreeList* free_list);
 }
 
-#endif//POSEIDON_FREELIST_H
\ No newline at end of file
+#endif//POSEIDON_FREELIST_H
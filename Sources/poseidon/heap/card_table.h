@@ -0,0 +1,156 @@
+#ifndef POSEIDON_HEAP_CARD_TABLE_H
+#define POSEIDON_HEAP_CARD_TABLE_H
+
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+#include "poseidon/relaxed_atomic.h"
+
+namespace poseidon{
+ /**
+  * A byte per {@link kCardSize} bytes of a zone, dirtied by the write barrier when a reference to a new object gets
+  * stored inside of the card.
+  *
+  * The scavenger treats the reference fields inside of the dirty cards as roots instead of scanning the whole zone,
+  * cards whose fields still reference new objects afterwards stay dirty.
+  */
+ class CardTable{
+   friend class CardTableTest;
+  public:
+   static constexpr const int64_t kCardSizeBits = 9;
+   static constexpr const int64_t kCardSize = 1 << kCardSizeBits;
+
+   static constexpr const uint8_t kClean = 0;
+   static constexpr const uint8_t kDirty = 1;
+  private:
+   uword start_;
+   int64_t size_;
+   int64_t num_cards_;
+   RelaxedAtomic<uint8_t>* cards_;
+  public:
+   CardTable(uword start, int64_t size):
+    start_(start),
+    size_(size),
+    num_cards_((size + (kCardSize - 1)) >> kCardSizeBits),
+    cards_(new RelaxedAtomic<uint8_t>[num_cards_]){
+   }
+   CardTable(const CardTable& rhs) = delete;
+   ~CardTable(){
+     delete[] cards_;
+   }
+
+   uword GetStartingAddress() const{
+     return start_;
+   }
+
+   uword GetEndingAddress() const{
+     return start_ + size_;
+   }
+
+   int64_t GetNumberOfCards() const{
+     return num_cards_;
+   }
+
+   bool Contains(uword address) const{
+     return address >= GetStartingAddress() && address < GetEndingAddress();
+   }
+
+   int64_t GetCardIndexFor(uword address) const{
+     PSDN_ASSERT(Contains(address));
+     return static_cast<int64_t>(address - GetStartingAddress()) >> kCardSizeBits;
+   }
+
+   uword GetCardAddress(int64_t index) const{
+     return GetStartingAddress() + (static_cast<uword>(index) << kCardSizeBits);
+   }
+
+   bool IsDirty(int64_t index) const{
+     return cards_[index].load() == kDirty;
+   }
+
+   bool IsDirty(uword address) const{
+     return IsDirty(GetCardIndexFor(address));
+   }
+
+   /**
+    * Dirties the card of address, the card is only written when it's clean so hot cards don't keep invalidating
+    * the cache line.
+    */
+   void Dirty(uword address){
+     auto& card = cards_[GetCardIndexFor(address)];
+     if(card.load() != kDirty)
+       card.store(kDirty);
+   }
+
+   /**
+    * Dirties the cards of [start, end).
+    */
+   void Dirty(uword start, uword end){
+     for(auto idx = GetCardIndexFor(start); idx <= GetCardIndexFor(end - 1); idx++)
+       cards_[idx].store(kDirty);
+   }
+
+   void Clean(int64_t index){
+     cards_[index].store(kClean);
+   }
+
+   /**
+    * Cleans the cards of [start, end).
+    */
+   void Clean(uword start, uword end){
+     for(auto idx = GetCardIndexFor(start); idx <= GetCardIndexFor(end - 1); idx++)
+       Clean(idx);
+   }
+
+   void Clear(){
+     for(int64_t idx = 0; idx < GetNumberOfCards(); idx++)
+       Clean(idx);
+   }
+
+   /**
+    * Returns the ending address of the last dirty card of [start, end), or 0 if all of its cards are clean.
+    */
+   uword GetLastDirtyCardEnd(uword start, uword end) const{
+     for(auto idx = GetCardIndexFor(end - 1); idx >= GetCardIndexFor(start); idx--){
+       if(IsDirty(idx))
+         return GetCardAddress(idx + 1);
+     }
+     return 0;
+   }
+
+   bool HasDirtyCards(uword start, uword end) const{
+     for(auto idx = GetCardIndexFor(start); idx <= GetCardIndexFor(end - 1); idx++){
+       if(IsDirty(idx))
+         return true;
+     }
+     return false;
+   }
+
+   int64_t GetNumberOfDirtyCards(uword start, uword end) const{
+     int64_t dirty = 0;
+     for(auto idx = GetCardIndexFor(start); idx <= GetCardIndexFor(end - 1); idx++){
+       if(IsDirty(idx))
+         dirty++;
+     }
+     return dirty;
+   }
+
+   int64_t GetNumberOfDirtyCards() const{
+     return GetNumberOfDirtyCards(GetStartingAddress(), GetEndingAddress());
+   }
+
+   CardTable& operator=(const CardTable& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const CardTable& val){
+     stream << "CardTable(";
+     stream << "start=" << ((void*)val.GetStartingAddress()) << ", ";
+     stream << "cards=" << val.GetNumberOfCards() << ", ";
+     stream << "dirty=" << val.GetNumberOfDirtyCards();
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_HEAP_CARD_TABLE_H
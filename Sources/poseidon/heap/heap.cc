@@ -1,5 +1,6 @@
 #include <glog/logging.h>
 #include "poseidon/heap/heap.h"
+#include "poseidon/collector/marker.h"
 #include "poseidon/collector/collector.h"
 
 namespace poseidon{
@@ -38,10 +39,10 @@ finish_allocation:
    if((val = (RawObject*)old_zone()->TryAllocate(size)) != nullptr)
      goto finish_allocation;
 
-   // 4. Try Pages w/ Grow
-   {
-     //TODO: allocate using pages, with growth
-   }
+   // 4. Try Growing the Zone
+   if(old_zone()->Grow(static_cast<int64_t>(sizeof(RawObject)) + size) > 0
+   && (val = (RawObject*)old_zone()->TryAllocate(size)) != nullptr)
+     goto finish_allocation;
 
    // 5. Crash
    LOG(FATAL) << "cannot allocate " << Bytes(size) << " in heap.";
@@ -49,21 +50,79 @@ finish_allocation:
 
 finish_allocation:
    val->SetOldBit();
+   // allocated black, the object isn't part of the snapshot the concurrent mark traces.
+   if(Marker::IsMarkingConcurrently(this))
+     old_zone()->Mark(val);
    return val->GetAddress();
  }
 
  uword Heap::AllocateLargeObject(int64_t size){
-   return AllocateOldObject(size);//TODO: refactor
+   uword address;
+
+   // 1. Try Allocation
+   if((address = large_object_space()->TryAllocate(size)) != 0)
+     goto finish_allocation;
+
+   // 2. Try Major Collection, which unmaps the dead large objects
+   Collector::MajorCollection();
+
+   // 3. Try Allocation Again
+   if((address = large_object_space()->TryAllocate(size)) != 0)
+     goto finish_allocation;
+
+   // 4. Crash
+   LOG(FATAL) << "cannot allocate large object of " << Bytes(size) << " in heap.";
+   return 0;
+
+finish_allocation:
+   // allocated black, like the old objects.
+   if(Marker::IsMarkingConcurrently(this))
+     ((RawObject*)address)->SetMarkedBit();
+   return address;
+ }
+
+ void Heap::MarkStepIfNeeded(int64_t size){
+   if(!Marker::IsMarkingIncrementally() || !Marker::IsMarkingConcurrently(this))
+     return;
+   allocated_since_step_ += size;
+   if(allocated_since_step_ < GetMarkStepSize())
+     return;
+   allocated_since_step_ = 0;
+   Collector::MarkStep();
  }
 
  uword Heap::TryAllocate(int64_t size){
+   return TryAllocate(nullptr, size);
+ }
+
+ uword Heap::TryAllocate(LocalAllocationBuffer* buffer, int64_t size){
    if(size < kWordSize)
      size = kWordSize;
 
    if(size >= GetLargeObjectSize()){
+     MarkStepIfNeeded(size);
      DLOG(INFO) << "allocating large object of " << Bytes(size);
      return AllocateLargeObject(size);
    }
+
+   if(buffer == nullptr){
+     MarkStepIfNeeded(size);
+     return AllocateNewObject(size);
+   }
+
+   // a refill is the slow path of the buffer, it takes a step of the incremental mark or finishes the concurrent mark.
+   if(Marker::IsMarkingIncrementally()){
+     if(Marker::IsMarkingConcurrently(this))
+       Collector::MarkStep();
+   } else{
+     Collector::FinishMajorCollectionIfTerminated();
+   }
+
+   uword address;
+   if(new_zone()->TryRefill(buffer, size) && (address = buffer->TryAllocate(size)) != 0)
+     return address;
+
+   // the object doesn't fit in a buffer or the new zone is exhausted.
    return AllocateNewObject(size);
  }
 }
\ No newline at end of file
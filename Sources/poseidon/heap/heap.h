@@ -7,7 +7,10 @@
 #include "poseidon/heap/zone.h"
 #include "poseidon/heap/new_zone.h"
 #include "poseidon/heap/old_zone.h"
+#include "poseidon/heap/large_object_space.h"
+#include "poseidon/collector/refiner.h"
 
+#include "poseidon/platform/numa.h"
 #include "poseidon/platform/os_thread.h"
 #include "poseidon/platform/memory_region.h"
 
@@ -21,6 +24,16 @@ namespace poseidon{
   private:
    static pthread_key_t kThreadKey;
 
+   static inline MemoryRegion::PageMode
+   GetPageMode(){
+     auto huge_pages = GetHugePages();
+     if(huge_pages == "hugetlb")
+       return MemoryRegion::kHugeTLBPages;
+     if(huge_pages == "transparent")
+       return MemoryRegion::kTransparentHugePages;
+     return MemoryRegion::kDefaultPages;
+   }
+
    static inline void
    SetCurrentThreadHeap(Heap* heap){
      int err;
@@ -33,31 +46,70 @@ namespace poseidon{
    MemoryRegion* region_;
    NewZone* new_zone_;
    OldZone* old_zone_;
+   LargeObjectSpace* large_object_space_;
+   NumaNode node_;
+   // the bytes allocated directly since the last incremental mark step.
+   int64_t allocated_since_step_;
+
+   /**
+    * Places the new zone on the NUMA node of the mutator creating this heap, each thread has its own heap so the
+    * new zone is only ever allocated in by that mutator. The old zone places its pages itself as they get committed.
+    */
+   void BindToNumaNode(){
+     if(!IsNumaEnabled())
+       return;
+     node_ = GetCurrentNumaNode();
+     BindMemoryToNumaNode(new_zone()->GetStartingAddress(), new_zone()->GetSize(), node_);
+   }
+
+   /**
+    * Pre-faults the new zone, the old zone pre-faults its pages itself as they get committed.
+    */
+   void PreFault(){
+     if(!IsPreFaultEnabled())
+       return;
+     MemoryRegion region(new_zone()->GetStartingAddress(), new_zone()->GetSize());
+     if(!region.Populate())
+       LOG(WARNING) << "cannot pre-fault " << (*new_zone()) << ".";
+   }
 
    Heap(MemoryRegion* region, NewZone* new_zone, OldZone* old_zone):
     region_(region),
     new_zone_(new_zone),
-    old_zone_(old_zone){
+    old_zone_(old_zone),
+    large_object_space_(new LargeObjectSpace()),
+    node_(kAnyNumaNode),
+    allocated_since_step_(0){
    }
 
    explicit Heap(MemoryRegion* region, int64_t new_zone_size = GetNewZoneSize(), int64_t old_zone_size = GetOldZoneSize(), int64_t old_page_size = GetOldPageSize()):
     region_(region),
     new_zone_(new NewZone(region, new_zone_size)),
-    old_zone_(new OldZone(region, new_zone_size, old_zone_size, old_page_size)){
+    old_zone_(new OldZone(region, new_zone_size, old_zone_size, old_page_size)),
+    large_object_space_(new LargeObjectSpace()),
+    node_(kAnyNumaNode),
+    allocated_since_step_(0){
+     // the memory has to be placed before it gets touched.
+     BindToNumaNode();
+     PreFault();
    }
 
    Heap():
-    Heap(new MemoryRegion(GetTotalInitialHeapSize())){
+    Heap(new MemoryRegion(GetTotalInitialHeapSize(), GetPageMode())){
    }
 
    uword AllocateNewObject(int64_t size);
    uword AllocateOldObject(int64_t size);
    uword AllocateLargeObject(int64_t size);
+
+   // takes an incremental mark step once enough was allocated w/o a buffer, the mark keeps pace w/ the allocation.
+   void MarkStepIfNeeded(int64_t size);
   public:
    Heap(const Heap& rhs) = default;
    virtual ~Heap(){
      delete new_zone_;
      delete old_zone_;
+     delete large_object_space_;
    }
 
    MemoryRegion* region() const{
@@ -72,8 +124,79 @@ namespace poseidon{
      return old_zone_;
    }
 
+   LargeObjectSpace* large_object_space() const{
+     return large_object_space_;
+   }
+
+   /**
+    * Returns the number of bytes of this heap's {@link MemoryRegion} that are backed by huge pages.
+    */
+   int64_t GetHugePageBackedSize() const{
+     return region()->GetHugePageBackedSize();
+   }
+
+   /**
+    * Returns the NUMA node of the object at address, or {@link kAnyNumaNode} if NUMA placement is disabled.
+    *
+    * Large objects are mapped by the mutator, so they are assumed to be on the node of the new zone.
+    */
+   NumaNode GetNumaNodeFor(uword address) const{
+     if(!IsNumaEnabled())
+       return kAnyNumaNode;
+     if(old_zone()->Contains(address))
+       return old_zone()->GetNumaNodeFor(old_zone()->GetPageIndexFor(address));
+     return node_;
+   }
+
+   /**
+    * The write barrier, records that value was stored into slot so the next scavenge finds the references from old
+    * objects to new ones w/o scanning the old objects.
+    *
+    * @param slot The reference field that was written
+    * @param value The new value of the field
+    */
+   inline void RecordWrite(uword* slot, uword value){
+     if(value == 0 || !new_zone()->Contains(value) || new_zone()->Contains((uword)slot))
+       return;
+
+     if(old_zone()->Contains((uword)slot)){
+       // the pages of the old zone are write-protected, the store was recorded by the page fault.
+       if(old_zone()->IsWatchingWrites())
+         return;
+       // the store has to be visible before the buffer is read, otherwise the refinement could drop the field
+       // w/o seeing the new value.
+       std::atomic_thread_fence(std::memory_order_seq_cst);
+       if(old_zone()->RecordWrite(slot))
+         Refiner::ScheduleRefinement(this);
+     } else if(large_object_space()->IsReserved((uword)slot)){
+       large_object_space()->RememberSlot(slot);
+     }
+   }
+
+   /**
+    * Remembers slot, a field of an old object that still references a new object after a collection.
+    */
+   inline void RememberSlot(uword* slot){
+     if(old_zone()->Contains((uword)slot)){
+       old_zone()->RememberSlot(slot);
+     } else if(large_object_space()->IsReserved((uword)slot)){
+       large_object_space()->RememberSlot(slot);
+     }
+   }
+
    uword TryAllocate(int64_t size);
 
+   /**
+    * Refills the {@link LocalAllocationBuffer} from the new zone & allocates a new object of size bytes in it.
+    *
+    * Large objects & objects that don't fit in a {@link LocalAllocationBuffer} are allocated directly.
+    *
+    * @param buffer The calling thread's {@link LocalAllocationBuffer}, or nullptr to allocate directly
+    * @param size The size of the new object
+    * @return The address of the new object
+    */
+   uword TryAllocate(LocalAllocationBuffer* buffer, int64_t size);
+
    Heap& operator=(const Heap& rhs) = delete;
 
    friend std::ostream& operator<<(std::ostream& stream, const Heap& heap){//TODO: implement
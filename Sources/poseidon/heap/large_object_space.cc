@@ -0,0 +1,162 @@
+#include <unistd.h>
+#include "poseidon/heap/large_object_space.h"
+
+namespace poseidon{
+ static inline int64_t
+ GetSystemPageSize(){
+   static const int64_t kPageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+   return kPageSize;
+ }
+
+ int64_t LargeObjectSpace::GetMappingSizeFor(int64_t size){
+   auto total_size = static_cast<int64_t>(sizeof(RawObject)) + size;
+   auto page_size = GetSystemPageSize();
+   return (total_size + (page_size - 1)) & ~(page_size - 1);
+ }
+
+ LargeObjectSpace::LargeObjectSpace(int64_t size):
+  reserved_(size),
+  mutex_(),
+  objects_(),
+  free_(),
+  allocated_(0),
+  remembered_(){
+   if(reserved_.size() > 0)
+     free_.emplace(reserved_.GetStartingAddress(), reserved_.size());
+ }
+
+ LargeObjectSpace::~LargeObjectSpace(){
+   std::lock_guard<std::mutex> guard(mutex_);
+   objects_.clear();
+   free_.clear();
+   if(reserved_.size() > 0)
+     reserved_.FreeRegion();
+ }
+
+ // takes the first run of the reserved range that fits size bytes, called w/ the lock held.
+ uword LargeObjectSpace::TryReserve(int64_t size){
+   for(auto next = free_.begin(); next != free_.end(); next++){
+     if(next->second < size)
+       continue;
+     auto start = next->first;
+     auto remaining = next->second - size;
+     free_.erase(next);
+     if(remaining > 0)
+       free_.emplace(start + size, remaining);
+     return start;
+   }
+   return 0;
+ }
+
+ // returns the run to the reserved range & merges it w/ its neighbors, called w/ the lock held.
+ void LargeObjectSpace::Unreserve(uword start, int64_t size){
+   auto next = free_.lower_bound(start);
+   if(next != free_.end() && (start + size) == next->first){
+     size += next->second;
+     next = free_.erase(next);
+   }
+   if(next != free_.begin()){
+     auto previous = std::prev(next);
+     if((previous->first + previous->second) == start){
+       previous->second += size;
+       return;
+     }
+   }
+   free_.emplace(start, size);
+ }
+
+ bool LargeObjectSpace::Contains(uword address) const{
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto next = objects_.upper_bound(address);
+   if(next == objects_.begin())
+     return false;
+   auto& region = std::prev(next)->second;
+   return address < region.GetEndingAddress();
+ }
+
+ uword LargeObjectSpace::TryAllocate(int64_t size){
+   auto mapping_size = GetMappingSizeFor(size);
+   uword start;
+   {
+     std::lock_guard<std::mutex> guard(mutex_);
+     start = TryReserve(mapping_size);
+   }
+   // logged w/o the lock, printing the space takes it.
+   if(start == 0){
+     PSDN_CANT_ALLOCATE(ERROR, mapping_size, (*this));
+     return 0;
+   }
+
+   // the run is reserved for this object, so it's committed w/o the lock.
+   MemoryRegion region(start, mapping_size);
+   if(!region.Commit()){
+     std::lock_guard<std::mutex> guard(mutex_);
+     Unreserve(start, mapping_size);
+     return 0;
+   }
+
+   auto ptr = new (region.GetStartingAddressPointer())RawObject(ObjectTag::OldWithSize(size));
+   {
+     std::lock_guard<std::mutex> guard(mutex_);
+     objects_.emplace(region.GetStartingAddress(), region);
+   }
+   allocated_ += mapping_size;
+   return ptr->GetAddress();
+ }
+
+ int64_t LargeObjectSpace::Sweep(int64_t* num_freed){
+   int64_t freed = 0;
+   int64_t bytes_freed = 0;
+
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto next = objects_.begin();
+   while(next != objects_.end()){
+     auto ptr = (RawObject*)next->first;
+     // the mark of a survivor is dropped by the next MarkEpoch, it doesn't have to be cleared.
+     if(ptr->IsMarked()){
+       next++;
+       continue;
+     }
+
+     DLOG(INFO) << "freeing large object " << ptr->ToString();
+     auto region = next->second;
+     remembered_.erase(remembered_.lower_bound(region.GetStartingAddress()), remembered_.lower_bound(region.GetEndingAddress()));
+     bytes_freed += region.size();
+     freed++;
+     // the memory goes back to the OS, the range stays reserved for the next large objects.
+     if(!region.Decommit())
+       LOG(WARNING) << "cannot decommit large object of " << Bytes(region.size()) << ".";
+     Unreserve(region.GetStartingAddress(), region.size());
+     next = objects_.erase(next);
+   }
+
+   allocated_ -= bytes_freed;
+   if(num_freed)
+     (*num_freed) = freed;
+   return bytes_freed;
+ }
+
+ void LargeObjectSpace::VisitPointers(const std::function<bool(RawObject*)>& vis) const{
+   std::lock_guard<std::mutex> guard(mutex_);
+   for(auto& entry : objects_){
+     if(!vis((RawObject*)entry.first))
+       return;
+   }
+ }
+
+ void LargeObjectSpace::RememberSlot(uword* slot){
+   std::lock_guard<std::mutex> guard(mutex_);
+   remembered_.insert((uword)slot);
+ }
+
+ void LargeObjectSpace::VisitRememberedSlots(const std::function<void(uword*)>& vis){
+   std::set<uword> remembered;
+   {
+     std::lock_guard<std::mutex> guard(mutex_);
+     remembered.swap(remembered_);
+   }
+
+   for(auto& slot : remembered)
+     vis((uword*)slot);
+ }
+}
@@ -0,0 +1,131 @@
+#ifndef POSEIDON_HEAP_LARGE_OBJECT_SPACE_H
+#define POSEIDON_HEAP_LARGE_OBJECT_SPACE_H
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <ostream>
+#include <functional>
+
+#include "poseidon/flags.h"
+#include "poseidon/utils.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/platform/memory_region.h"
+
+namespace poseidon{
+ /**
+  * The space for objects of {@link GetLargeObjectSize()} bytes or more.
+  *
+  * Every large object gets its own page-aligned {@link MemoryRegion}, tracked in a side table keyed by its
+  * starting address. Large objects are never copied & the memory of a dead one is returned to the OS when
+  * it gets swept.
+  *
+  * The regions are committed in an address range reserved up front, nothing but large objects lives in it. So the
+  * write barrier tells a field of a large object apart w/ a range check, w/o taking the lock.
+  */
+ class LargeObjectSpace{
+   friend class LargeObjectSpaceTest;
+  public:
+   static int64_t GetMappingSizeFor(int64_t size);
+  private:
+   MemoryRegion reserved_;
+   mutable std::mutex mutex_;
+   std::map<uword, MemoryRegion> objects_;
+   // the unused runs of the reserved range, keyed by their starting address.
+   std::map<uword, int64_t> free_;
+   RelaxedAtomic<int64_t> allocated_;
+   // the fields of large objects that reference new objects, large objects are too big to be covered by cards.
+   std::set<uword> remembered_;
+
+   uword TryReserve(int64_t size);
+   void Unreserve(uword start, int64_t size);
+  public:
+   explicit LargeObjectSpace(int64_t size = GetLargeObjectSpaceSize());
+   LargeObjectSpace(const LargeObjectSpace& rhs) = delete;
+   ~LargeObjectSpace();
+
+   /**
+    * Returns the number of bytes mapped for the live large objects, including the page alignment slack.
+    */
+   int64_t GetNumberOfBytesAllocated() const{
+     return (int64_t)allocated_;
+   }
+
+   int64_t GetNumberOfObjects() const{
+     std::lock_guard<std::mutex> guard(mutex_);
+     return static_cast<int64_t>(objects_.size());
+   }
+
+   bool IsEmpty() const{
+     return GetNumberOfObjects() == 0;
+   }
+
+   const MemoryRegion& reserved() const{
+     return reserved_;
+   }
+
+   /**
+    * Returns true if address is inside of the range reserved for the large objects, w/o taking the lock. Used by the
+    * write barrier, the field of an object in the range belongs to a large object.
+    */
+   bool IsReserved(uword address) const{
+     return address >= reserved_.GetStartingAddress()
+         && address < reserved_.GetEndingAddress();
+   }
+
+   /**
+    * Returns true if address is inside of one of the large objects in this space.
+    */
+   bool Contains(uword address) const;
+
+   /**
+    * Maps a new old object of size bytes.
+    *
+    * @param size The size of the new object
+    * @return The address of the new object, or 0 if the reserved range is exhausted or the mapping failed
+    */
+   uword TryAllocate(int64_t size);
+
+   /**
+    * Unmaps every large object that isn't marked, the survivors stay marked until the next {@link MarkEpoch}.
+    *
+    * Called during collection time, after marking.
+    *
+    * @param num_freed Set to the number of large objects that were freed
+    * @return The number of bytes returned to the OS
+    */
+   int64_t Sweep(int64_t* num_freed = nullptr);
+
+   void VisitPointers(const std::function<bool(RawObject*)>& vis) const;
+
+   /**
+    * Records a store of a reference to a new object into slot, a field of one of the large objects in this space.
+    */
+   void RememberSlot(uword* slot);
+
+   int64_t GetNumberOfRememberedSlots() const{
+     std::lock_guard<std::mutex> guard(mutex_);
+     return static_cast<int64_t>(remembered_.size());
+   }
+
+   /**
+    * Visits the remembered fields.
+    *
+    * The fields are forgotten before the first one gets visited, vis has to remember the fields that still
+    * reference new objects again.
+    */
+   void VisitRememberedSlots(const std::function<void(uword*)>& vis);
+
+   LargeObjectSpace& operator=(const LargeObjectSpace& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const LargeObjectSpace& val){
+     stream << "LargeObjectSpace(";
+     stream << "objects=" << val.GetNumberOfObjects() << ", ";
+     stream << "allocated=" << Bytes(val.GetNumberOfBytesAllocated());
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_HEAP_LARGE_OBJECT_SPACE_H
@@ -0,0 +1,142 @@
+#ifndef POSEIDON_HEAP_LOCAL_ALLOCATION_BUFFER_H
+#define POSEIDON_HEAP_LOCAL_ALLOCATION_BUFFER_H
+
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ class NewZone;
+
+ /**
+  * A bump-pointer buffer carved out of a {@link NewZone} and owned by a single thread.
+  *
+  * Allocating from a {@link LocalAllocationBuffer} requires no atomics, only the refill
+  * from the owning {@link NewZone} does.
+  *
+  * The spaces of a {@link NewZone} are only swapped by a collection its mutator runs, so the buffers are emptied at
+  * that safepoint & the next allocation refills them from the new space.
+  */
+ class LocalAllocationBuffer{
+   friend class NewZone;
+   friend class Semispace;
+  private:
+   uword start_;
+   uword current_;
+   uword end_;
+
+   NewZone* owner_;
+   LocalAllocationBuffer* next_;
+
+   inline void Reset(uword start, int64_t size){
+     start_ = start;
+     current_ = start;
+     end_ = start + size;
+   }
+  public:
+   constexpr LocalAllocationBuffer():
+    start_(0),
+    current_(0),
+    end_(0),
+    owner_(nullptr),
+    next_(nullptr){
+   }
+   LocalAllocationBuffer(const LocalAllocationBuffer& rhs) = delete;
+   ~LocalAllocationBuffer() = default;
+
+   uword GetStartingAddress() const{
+     return start_;
+   }
+
+   uword GetCurrentAddress() const{
+     return current_;
+   }
+
+   void* GetCurrentAddressPointer() const{
+     return (void*)GetCurrentAddress();
+   }
+
+   uword GetEndingAddress() const{
+     return end_;
+   }
+
+   int64_t GetSize() const{
+     return static_cast<int64_t>(GetEndingAddress() - GetStartingAddress());
+   }
+
+   int64_t GetNumberOfBytesAllocated() const{
+     return static_cast<int64_t>(GetCurrentAddress() - GetStartingAddress());
+   }
+
+   int64_t GetNumberOfBytesRemaining() const{
+     return static_cast<int64_t>(GetEndingAddress() - GetCurrentAddress());
+   }
+
+   NewZone* owner() const{
+     return owner_;
+   }
+
+   bool HasOwner() const{
+     return owner_ != nullptr;
+   }
+
+   bool Contains(uword address) const{
+     return GetStartingAddress() <= address
+         && GetEndingAddress() > address;
+   }
+
+   /**
+    * Allocates a new object of size bytes by bumping the current address of this buffer.
+    *
+    * @param size The size of the new object to allocate
+    * @return The address of the new object, or 0 if the buffer is exhausted
+    */
+   inline uword TryAllocate(int64_t size){
+     auto total_size = static_cast<int64_t>(sizeof(RawObject) + size);
+     if((GetCurrentAddress() + total_size) > GetEndingAddress())
+       return 0;
+     auto ptr = new (GetCurrentAddressPointer())RawObject(ObjectTag::NewWithSize(size));
+     current_ += total_size;
+     return ptr->GetAddress();
+   }
+
+   /**
+    * Takes back the allocation of ptr, which only works as long as ptr is the last object allocated.
+    *
+    * @return false if another object was allocated after ptr
+    */
+   inline bool TryRetract(RawObject* ptr){
+     if((ptr->GetAddress() + ptr->GetTotalSize()) != GetCurrentAddress())
+       return false;
+     current_ = ptr->GetAddress();
+     return true;
+   }
+
+   /**
+    * Retires this buffer, the unused tail is filled w/ a dead object so the {@link NewZone} stays parsable.
+    */
+   void Retire(){
+     auto remaining = GetNumberOfBytesRemaining();
+     if(remaining >= static_cast<int64_t>(sizeof(RawObject))){
+       auto filler = new (GetCurrentAddressPointer())RawObject();
+       filler->SetPointerSize(remaining - sizeof(RawObject));
+     }
+     Reset(0, 0);
+   }
+
+   LocalAllocationBuffer& operator=(const LocalAllocationBuffer& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const LocalAllocationBuffer& val){
+     stream << "LocalAllocationBuffer(";
+     stream << "start=" << ((void*)val.GetStartingAddress()) << ", ";
+     stream << "allocated=" << Bytes(val.GetNumberOfBytesAllocated()) << ", ";
+     stream << "size=" << Bytes(val.GetSize());
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_HEAP_LOCAL_ALLOCATION_BUFFER_H
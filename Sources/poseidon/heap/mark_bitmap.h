@@ -0,0 +1,209 @@
+#ifndef POSEIDON_MARK_BITMAP_H
+#define POSEIDON_MARK_BITMAP_H
+
+#include <cstring>
+#include <ostream>
+#include <functional>
+
+#include "poseidon/utils.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ /**
+  * The marks of the objects in a range of memory, a bit per word which is set for the first word of a marked object.
+  *
+  * The bitmap doesn't own its bits, they're part of the metadata of the {@link OldPageTable}. Marking touches the
+  * bitmap instead of the headers of the objects & finding the marked objects scans the bitmap a word at a time.
+  *
+  * The bits are preceded by the {@link MarkEpoch} they belong to, the bits of an earlier epoch read as unmarked. They
+  * get cleared when the first object is marked in the current epoch, so a bitmap w/o marked objects is never cleared.
+  */
+ class MarkBitmap{
+  public:
+   static inline int64_t
+   GetNumberOfBitWords(int64_t size){
+     auto num_bits = size >> kWordSizeLog2;
+     return (num_bits + (kBitsPerWord - 1)) / kBitsPerWord;
+   }
+
+   /**
+    * Returns the number of words of storage a bitmap for size bytes needs, the epoch followed by the bits.
+    */
+   static inline int64_t
+   GetSizeInWords(int64_t size){
+     return 1 + GetNumberOfBitWords(size);
+   }
+  private:
+   // the epoch of a bitmap that's being cleared by one of the markers.
+   static constexpr const uword kClearingEpoch = ~static_cast<uword>(0);
+
+   uword start_;
+   int64_t size_;
+   uword* epoch_;
+   uword* bits_;
+
+   inline int64_t GetIndex(uword address) const{
+     return static_cast<int64_t>(address - start_) >> kWordSizeLog2;
+   }
+
+   inline uword* GetWord(int64_t index) const{
+     return &bits_[index >> kBitsPerWordLog2];
+   }
+
+   static inline uword
+   GetMask(int64_t index){
+     return static_cast<uword>(1) << (index & (kBitsPerWord - 1));
+   }
+
+   inline int64_t GetNumberOfBitWords() const{
+     return GetNumberOfBitWords(GetSize());
+   }
+
+   // clears the bits of an earlier epoch before the first object gets marked, the other markers wait for the clearing.
+   void Refresh(){
+     auto epoch = MarkEpoch::Get();
+     auto current = __atomic_load_n(epoch_, __ATOMIC_ACQUIRE);
+     while(current != epoch){
+       if(current != kClearingEpoch &&
+          __atomic_compare_exchange_n(epoch_, &current, kClearingEpoch, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+         memset(bits_, 0, sizeof(uword) * GetNumberOfBitWords());
+         __atomic_store_n(epoch_, epoch, __ATOMIC_RELEASE);
+         return;
+       }
+       current = __atomic_load_n(epoch_, __ATOMIC_ACQUIRE);
+     }
+   }
+  public:
+   MarkBitmap():
+    start_(0),
+    size_(0),
+    epoch_(nullptr),
+    bits_(nullptr){
+   }
+   MarkBitmap(uword start, int64_t size, uword* storage):
+    start_(start),
+    size_(size),
+    epoch_(storage),
+    bits_(storage != nullptr ? storage + 1 : nullptr){
+   }
+   MarkBitmap(const MarkBitmap& rhs) = default;
+   ~MarkBitmap() = default;
+
+   uword GetStartingAddress() const{
+     return start_;
+   }
+
+   uword GetEndingAddress() const{
+     return start_ + size_;
+   }
+
+   int64_t GetSize() const{
+     return size_;
+   }
+
+   int64_t GetSizeInWords() const{
+     return GetSizeInWords(GetSize());
+   }
+
+   uword* data() const{
+     return bits_;
+   }
+
+   /**
+    * Returns the {@link MarkEpoch} the bits belong to, {@link MarkEpoch::kNoEpoch} if nothing was marked yet.
+    */
+   uword GetEpoch() const{
+     return epoch_ != nullptr ? __atomic_load_n(epoch_, __ATOMIC_ACQUIRE) : MarkEpoch::kNoEpoch;
+   }
+
+   bool IsCurrent() const{
+     return GetEpoch() == MarkEpoch::Get();
+   }
+
+   bool Contains(uword address) const{
+     return address >= GetStartingAddress() && address < GetEndingAddress();
+   }
+
+   bool IsMarked(uword address) const{
+     PSDN_ASSERT(Contains(address));
+     if(!IsCurrent())
+       return false;
+     auto index = GetIndex(address);
+     return (__atomic_load_n(GetWord(index), __ATOMIC_RELAXED) & GetMask(index)) != 0;
+   }
+
+   /**
+    * Marks the object at address, several markers can race to mark it.
+    *
+    * @return true if this call marked the object, false if it was already marked
+    */
+   bool TryMark(uword address){
+     PSDN_ASSERT(Contains(address));
+     Refresh();
+     auto index = GetIndex(address);
+     auto mask = GetMask(index);
+     return (__atomic_fetch_or(GetWord(index), mask, __ATOMIC_RELAXED) & mask) == 0;
+   }
+
+   void Mark(uword address){
+     TryMark(address);
+   }
+
+   /**
+    * Unmarks every object by dropping the epoch of the bits, they get cleared once an object is marked again.
+    */
+   void Clear(){
+     if(epoch_ != nullptr)
+       __atomic_store_n(epoch_, MarkEpoch::kNoEpoch, __ATOMIC_RELEASE);
+   }
+
+   /**
+    * Returns the first marked object at or after address.
+    *
+    * @return The address of the marked object, or the end of the bitmap if there's none
+    */
+   uword FindNextMarked(uword address) const{
+     if(address >= GetEndingAddress() || !IsCurrent())
+       return GetEndingAddress();
+     auto index = GetIndex(address);
+     auto word = index >> kBitsPerWordLog2;
+     // the bits of the words before address are masked off.
+     auto bits = bits_[word] & (~static_cast<uword>(0) << (index & (kBitsPerWord - 1)));
+     while(bits == 0){
+       if(++word >= GetNumberOfBitWords())
+         return GetEndingAddress();
+       bits = bits_[word];
+     }
+     auto next = (word << kBitsPerWordLog2) + static_cast<int64_t>(__builtin_ctzl(bits));
+     return GetStartingAddress() + (static_cast<uword>(next) << kWordSizeLog2);
+   }
+
+   void VisitMarked(const std::function<bool(uword)>& vis) const{
+     if(!IsCurrent())
+       return;
+     for(int64_t word = 0; word < GetNumberOfBitWords(); word++){
+       auto bits = bits_[word];
+       while(bits != 0){
+         auto next = (word << kBitsPerWordLog2) + static_cast<int64_t>(__builtin_ctzl(bits));
+         bits &= (bits - 1);
+         if(!vis(GetStartingAddress() + (static_cast<uword>(next) << kWordSizeLog2)))
+           return;
+       }
+     }
+   }
+
+   MarkBitmap& operator=(const MarkBitmap& rhs) = default;
+
+   friend std::ostream& operator<<(std::ostream& stream, const MarkBitmap& val){
+     stream << "MarkBitmap(";
+     stream << "start=" << ((void*)val.GetStartingAddress()) << ", ";
+     stream << "size=" << Bytes(val.GetSize()) << ", ";
+     stream << "epoch=" << val.GetEpoch();
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_MARK_BITMAP_H
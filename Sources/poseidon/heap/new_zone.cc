@@ -1,20 +1,109 @@
+#include <thread>
 #include "poseidon/heap/new_zone.h"
-#include "poseidon/collector/collector.h"
 
 namespace poseidon{
+ NewZone::~NewZone(){
+   WaitForToSpace();
+   std::lock_guard<std::mutex> guard(buffers_mutex_);
+   auto buffer = buffers_;
+   while(buffer != nullptr){
+     auto next = buffer->next_;
+     buffer->Reset(0, 0);
+     buffer->owner_ = nullptr;
+     buffer->next_ = nullptr;
+     buffer = next;
+   }
+   buffers_ = nullptr;
+ }
+
+ uword NewZone::TryClaim(int64_t size){
+   uword current = GetCurrentAddress();
+   do{
+     if((current + size) > GetAllocationLimit())
+       return 0;
+   } while(!current_.compare_exchange_weak(current, current + size));
+   return current;
+ }
+
  uword NewZone::TryAllocate(int64_t size){
    auto total_size = static_cast<int64_t>(sizeof(RawObject)) + size;
-   if((GetCurrentAddress() + total_size) >= (fromspace() + tospace())){
+   auto address = TryClaim(total_size);
+   if(address == 0){
      PSDN_CANT_ALLOCATE(ERROR, total_size, (*this));
-     Collector::MinorCollection();
+     return 0;
    }
+   auto ptr = new ((void*)address)RawObject(ObjectTag::NewWithSize(size));
+   return ptr->GetAddress();
+ }
+
+ bool NewZone::TryRefill(LocalAllocationBuffer* buffer, int64_t size){
+   auto total_size = static_cast<int64_t>(sizeof(RawObject)) + size;
+   auto chunk_size = std::min(GetLocalAllocationBufferSize(), GetLargeObjectSize());
+   if(total_size > chunk_size)
+     return false; // too large for a buffer, allocate it directly.
 
-   if((GetCurrentAddress() + total_size) >= (fromspace() + tospace())){
-     PSDN_CANT_ALLOCATE(FATAL, total_size, (*this));
+   auto remaining = static_cast<int64_t>(GetAllocationLimit() - GetCurrentAddress());
+   if(remaining < chunk_size)
+     chunk_size = std::max(remaining, total_size);
+
+   if(buffer->owner() != this){
+     if(buffer->HasOwner())
+       buffer->owner()->Release(buffer);
+
+     std::lock_guard<std::mutex> guard(buffers_mutex_);
+     buffer->owner_ = this;
+     buffer->next_ = buffers_;
+     buffers_ = buffer;
    }
 
-   auto ptr = new (GetCurrentAddressPointer())RawObject(ObjectTag::NewWithSize(size));
-   current_ += total_size;
-   return ptr->GetAddress();
+   buffer->Retire();
+   auto start = TryClaim(chunk_size);
+   if(start == 0)
+     return false;
+   buffer->Reset(start, chunk_size);
+   return true;
+ }
+
+ void NewZone::Release(LocalAllocationBuffer* buffer){
+   PSDN_ASSERT(buffer->owner() == this);
+   buffer->Retire();
+
+   std::lock_guard<std::mutex> guard(buffers_mutex_);
+   auto previous = &buffers_;
+   while((*previous) != nullptr && (*previous) != buffer)
+     previous = &(*previous)->next_;
+   if((*previous) != nullptr)
+     (*previous) = buffer->next_;
+   buffer->owner_ = nullptr;
+   buffer->next_ = nullptr;
+ }
+
+ void NewZone::RetireAllocationBuffers(){
+   // the tails lie in the evacuated space, they're dropped instead of filled.
+   std::lock_guard<std::mutex> guard(buffers_mutex_);
+   for(auto buffer = buffers_; buffer != nullptr; buffer = buffer->next_)
+     buffer->Reset(0, 0);
+ }
+ 
+ bool NewZone::ReleaseToSpace(){
+   if(!HasMemoryRelease() || ++idle_ < GetMemoryReleaseDelay())
+     return false;
+
+   // the to_ Semispace has to read as zero afterwards, so it's never released lazily.
+   MemoryRegion region(tospace(), semisize());
+   if(!region.Release())
+     return false;
+   idle_ = 0;
+   return true;
+ }
+
+ void NewZone::ClearToSpace(){
+   memset((void*)tospace(), 0, semisize());
+   clearing_.store(false, std::memory_order_release);
+ }
+
+ void NewZone::WaitForToSpace() const{
+   while(IsClearingToSpace())
+     std::this_thread::yield();
  }
-}
\ No newline at end of file
+}
@@ -1,13 +1,18 @@
 #ifndef POSEIDON_HEAP_NEW_ZONE_H
 #define POSEIDON_HEAP_NEW_ZONE_H
 
+#include <mutex>
+#include <atomic>
+
 #include "poseidon/flags.h"
 #include "poseidon/heap/zone.h"
+#include "poseidon/heap/local_allocation_buffer.h"
 
 namespace poseidon{
  class NewZone : public Zone{//TODO: pages?
    template<bool Parallel>
    friend class ScavengerVisitorBase;//TODO: remove
+   friend class NewZoneTest;
   public:
    static inline int64_t
    CalculateSemispaceSize(int64_t zone_size){
@@ -23,28 +28,66 @@ namespace poseidon{
    uword tospace_;
    int64_t semisize_;
 
+   std::mutex buffers_mutex_;
+   LocalAllocationBuffer* buffers_;
+
+   int64_t idle_; // the number of scavenges since the to_ Semispace was released
+   std::atomic<bool> clearing_; // true while the to_ Semispace is cleared in the background
+
+   /**
+    * Claims size bytes from the from_ Semispace of this Zone w/ a single atomic bump.
+    *
+    * @param size The number of bytes to claim
+    * @return The starting address of the claimed bytes, or 0 if the from_ Semispace is exhausted
+    */
+   uword TryClaim(int64_t size);
+
+   /**
+    * Retires all the {@link LocalAllocationBuffer}s carved out of this Zone by emptying them, so the allocation fast
+    * path never has to check whether its buffer is still in the from_ {@link Semispace}.
+    *
+    * Called during collection time, before the spaces are swapped. The collection is run by the mutator owning this
+    * Zone, so none of the buffers is allocated from meanwhile.
+    */
+   void RetireAllocationBuffers();
+
    /**
     * Swaps the from_ & to_ {@link Semispace}s in this {@link Zone}.
     *
-    * Called during collection time.
+    * Called during collection time, the survivors get copied into the new from_ {@link Semispace}.
     */
    virtual void SwapSpaces(){
+     WaitForToSpace();
+     RetireAllocationBuffers();
      std::swap(fromspace_, tospace_);
-     current_ = tospace_;
+     current_ = fromspace_;
+   }
+
+   inline void SetCurrentAddress(uword address){
+     PSDN_ASSERT(address >= fromspace() && address <= GetAllocationLimit());
+     current_ = address;
    }
   public:
    NewZone():
      Zone(),
      fromspace_(0),
      tospace_(0),
-     semisize_(0){
+     semisize_(0),
+     buffers_mutex_(),
+     buffers_(nullptr),
+     idle_(0),
+     clearing_(false){
    }
 
    NewZone(uword start, int64_t size):
      Zone(start, size),
      fromspace_(start),
      tospace_(start + CalculateSemispaceSize(size)),
-     semisize_(CalculateSemispaceSize(size)){
+     semisize_(CalculateSemispaceSize(size)),
+     buffers_mutex_(),
+     buffers_(nullptr),
+     idle_(0),
+     clearing_(false){
      SetWriteable();
    }
 
@@ -60,8 +103,8 @@ namespace poseidon{
      NewZone(region, region->size()){
    }
 
-   NewZone(const NewZone& rhs) = default;
-   ~NewZone() override = default;
+   NewZone(const NewZone& rhs) = delete;
+   ~NewZone() override;
 
    uword tospace() const{
      return tospace_;
@@ -75,6 +118,10 @@ namespace poseidon{
      return semisize_;
    }
 
+   uword GetAllocationLimit() const{
+     return fromspace() + semisize();
+   }
+
    /**
     * Allocates a new object of size bytes in the from_ Semispace of this Zone.
     *
@@ -83,7 +130,59 @@ namespace poseidon{
     */
    uword TryAllocate(int64_t size) override;
 
-   NewZone& operator=(const NewZone& rhs) = default;
+   /**
+    * Refills the {@link LocalAllocationBuffer} w/ a new chunk of the from_ Semispace of this Zone.
+    *
+    * The previous chunk of the buffer is retired and the buffer gets registered w/ this Zone, so it can be
+    * retired when the spaces are swapped.
+    *
+    * @param buffer The {@link LocalAllocationBuffer} to refill
+    * @param size The size of the object that didn't fit in the buffer
+    * @return True if the buffer was refilled, false otherwise.
+    */
+   bool TryRefill(LocalAllocationBuffer* buffer, int64_t size);
+
+   /**
+    * Retires & unregisters the {@link LocalAllocationBuffer} from this Zone.
+    *
+    * @param buffer The {@link LocalAllocationBuffer} to release
+    */
+   void Release(LocalAllocationBuffer* buffer);
+
+   /**
+    * Returns the memory of the evacuated to_ Semispace to the OS, once every {@link GetMemoryReleaseDelay()} scavenges.
+    *
+    * The released memory reads as zero, so it doesn't have to be cleared. Called during collection time, after the
+    * spaces are swapped.
+    *
+    * @return True if the to_ Semispace was released, false if it still has to be cleared.
+    */
+   bool ReleaseToSpace();
+
+   bool IsClearingToSpace() const{
+     return clearing_.load(std::memory_order_acquire);
+   }
+
+   /**
+    * Marks the to_ Semispace as being cleared, until {@link ClearToSpace()} runs.
+    *
+    * Called during collection time, before the clearing is handed off to a background task.
+    */
+   void SetClearingToSpace(){
+     clearing_.store(true, std::memory_order_relaxed);
+   }
+
+   /**
+    * Zeroes the evacuated to_ Semispace, run by a background task so the clearing stays out of the pause.
+    */
+   void ClearToSpace();
+
+   /**
+    * Waits for the background clearing of the to_ Semispace to finish, the next scavenge copies into it.
+    */
+   void WaitForToSpace() const;
+
+   NewZone& operator=(const NewZone& rhs) = delete;
 
    friend std::ostream& operator<<(std::ostream& stream, const NewZone& val){
      stream << "NewZone(";
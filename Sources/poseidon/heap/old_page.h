@@ -5,6 +5,7 @@
 #include "poseidon/bitset.h"
 #include "poseidon/common.h"
 #include "poseidon/heap/page.h"
+#include "poseidon/heap/mark_bitmap.h"
 #include "poseidon/platform/memory_region.h"
 
 namespace poseidon{
@@ -15,26 +16,32 @@ namespace poseidon{
    friend class OldPageTable;
   protected:
    OldPageTable* table_;
+   int64_t idle_;
+   bool empty_; // true if the last sweep found no marked object, the page isn't in the free list
+   MarkBitmap marks_;
 
-   OldPage(OldPageTable* table, int64_t index, uword start, int64_t size):
+   OldPage(OldPageTable* table, int64_t index, uword start, int64_t size, uword* marks):
      Page(index, start, size),
-     table_(table){
+     table_(table),
+     idle_(0),
+     empty_(false),
+     marks_(start, size, marks){
    }
 
-   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region, int64_t offset, int64_t size):
-     OldPage(table, index, region->GetStartingAddress() + offset, size){
+   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region, int64_t offset, int64_t size, uword* marks):
+     OldPage(table, index, region->GetStartingAddress() + offset, size, marks){
    }
 
-   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region, int64_t size):
-     OldPage(table, index, region, 0, size){
+   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region, int64_t size, uword* marks):
+     OldPage(table, index, region, 0, size, marks){
    }
 
-   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region):
-     OldPage(table, index, region, region->size()){
+   OldPage(OldPageTable* table, int64_t index, MemoryRegion* region, uword* marks):
+     OldPage(table, index, region, region->size(), marks){
    }
 
-   explicit OldPage(OldPageTable* table, MemoryRegion* region):
-     OldPage(table, 0, region){
+   OldPage(OldPageTable* table, MemoryRegion* region, uword* marks):
+     OldPage(table, 0, region, marks){
    }
 
    inline OldPageTable* GetTable() const{
@@ -43,18 +50,91 @@ namespace poseidon{
   public:
    OldPage():
      Page(),
-     table_(nullptr){
+     table_(nullptr),
+     idle_(0),
+     empty_(false),
+     marks_(){
    }
    OldPage(const OldPage& rhs):
      Page(rhs),
-     table_(rhs.GetTable()){
+     table_(rhs.GetTable()),
+     idle_(rhs.GetIdleCount()),
+     empty_(rhs.IsEmpty()),
+     marks_(rhs.marks_){
    }
    ~OldPage() override = default;
 
+   /**
+    * Returns the number of consecutive major collections this page has been empty for.
+    */
+   int64_t GetIdleCount() const{
+     return idle_;
+   }
+
+   int64_t IncrementIdleCount(){
+     return ++idle_;
+   }
+
+   void ResetIdleCount(){
+     idle_ = 0;
+   }
+
+   /**
+    * Returns true if the last sweep found this page empty, its memory is left for {@link OldZone::Shrink()}.
+    */
+   bool IsEmpty() const{
+     return empty_;
+   }
+
+   void SetEmpty(bool empty = true){
+     empty_ = empty;
+   }
+
+   MarkBitmap& marks(){
+     return marks_;
+   }
+
+   const MarkBitmap& marks() const{
+     return marks_;
+   }
+
+   bool IsMarked(RawObject* ptr) const{
+     return marks_.IsMarked(ptr->GetAddress());
+   }
+
+   /**
+    * Marks ptr in the {@link MarkBitmap} of this page, several markers can race to mark it.
+    *
+    * @return true if this call marked ptr, false if it was already marked
+    */
+   bool TryMark(RawObject* ptr){
+     return marks_.TryMark(ptr->GetAddress());
+   }
+
+   void Mark(RawObject* ptr){
+     return marks_.Mark(ptr->GetAddress());
+   }
+
+   void ClearMarks(){
+     return marks_.Clear();
+   }
+
    uword TryAllocate(int64_t size) override{
      return RawObject::TryAllocateOldIn(this, size);
    }
 
+   void VisitMarkedPointers(RawObjectVisitor* vis) const override{
+     return marks_.VisitMarked([vis](uword address){
+       return vis->Visit((RawObject*)address);
+     });
+   }
+
+   void VisitMarkedPointers(const std::function<bool(RawObject*)>& vis) const override{
+     return marks_.VisitMarked([&vis](uword address){
+       return vis((RawObject*)address);
+     });
+   }
+
    OldPage& operator=(const OldPage& rhs) = default;
 
    friend std::ostream& operator<<(std::ostream& stream, const OldPage& val){
@@ -88,6 +168,9 @@ namespace poseidon{
    OldPage* pages_;
    int64_t num_pages_;
    BitSet marked_;
+   BitSet committed_;
+   // the mark bitmaps of the pages, a contiguous run of words per page which starts w/ the epoch of its bits.
+   uword* marks_;
 
    void CreatePagesForRange(uword start, int64_t sz, int64_t page_size){
      PSDN_ASSERT(IsPow2(sz));
@@ -97,7 +180,7 @@ namespace poseidon{
 
      int64_t index = 0;
      for(auto current = start; current < (start + sz); current += page_size, index++){
-       pages_[index] = OldPage(this, index, current, page_size);
+       pages_[index] = OldPage(this, index, current, page_size, &marks_[index * MarkBitmap::GetSizeInWords(page_size)]);
      }
    }
   public:
@@ -105,12 +188,16 @@ namespace poseidon{
      zone_(nullptr),
      pages_(nullptr),
      num_pages_(0),
-     marked_(){
+     marked_(),
+     committed_(),
+     marks_(nullptr){
    }
    OldPageTable(uword start, int64_t sz, int64_t page_size):
      pages_(nullptr),
      num_pages_(0),
-     marked_(){
+     marked_(),
+     committed_(),
+     marks_(nullptr){
      PSDN_ASSERT(start > 0);
      PSDN_ASSERT(sz > 0);
      PSDN_ASSERT(IsPow2(sz));
@@ -119,22 +206,18 @@ namespace poseidon{
      PSDN_ASSERT((sz % page_size) == 0);
      num_pages_ = (sz / page_size);
      marked_ = BitSet(num_pages_);
+     marked_.Reset();
+     committed_ = BitSet(num_pages_);
+     committed_.Reset();
      pages_ = new OldPage[num_pages_];
-
-     auto current_address = start;
-     for(auto idx = 0; idx < num_pages_; idx++, current_address += page_size){
-       pages_[idx] = OldPage(this, idx, current_address, page_size);
-     }
-   }
-   OldPageTable(const OldPageTable& rhs):
-     zone_(rhs.zone_),
-     pages_(new OldPage[rhs.size()]),
-     num_pages_(rhs.size()),
-     marked_(rhs.marked_){
-     std::copy(begin(), end(), rhs.begin());
+     // calloc'ed, so the bitmaps of the reserved pages don't take up memory until they're used.
+     marks_ = (uword*)calloc(static_cast<size_t>(num_pages_ * MarkBitmap::GetSizeInWords(page_size)), sizeof(uword));
+     CreatePagesForRange(start, sz, page_size);
    }
+   OldPageTable(const OldPageTable& rhs) = delete;
    ~OldPageTable(){
      delete[] pages_;
+     free(marks_);
    }
 
    int64_t size() const{
@@ -155,7 +238,8 @@ namespace poseidon{
    void Mark(int64_t idx){
      PSDN_ASSERT(idx >= 0);
      PSDN_ASSERT(idx <= size());
-     return marked_.Set(idx, true);
+     // the workers of a parallel scavenge promote into the pages concurrently.
+     return marked_.AtomicSet(idx);
    }
 
    void Mark(OldPage* page){
@@ -174,6 +258,23 @@ namespace poseidon{
      return Unmark(page->GetIndex());
    }
 
+   bool IsCommitted(int64_t idx) const{
+     PSDN_ASSERT(idx >= 0);
+     PSDN_ASSERT(idx < size());
+     return committed_.Test(idx);
+   }
+
+   bool IsCommitted(OldPage* page) const{
+     PSDN_ASSERT(page != nullptr);
+     return IsCommitted(page->GetIndex());
+   }
+
+   void SetCommitted(int64_t idx, bool committed = true){
+     PSDN_ASSERT(idx >= 0);
+     PSDN_ASSERT(idx < size());
+     return committed_.Set(idx, committed);
+   }
+
    OldPage* page(int64_t idx) const{
      PSDN_ASSERT(idx >= 0);
      PSDN_ASSERT(idx <= size());
@@ -217,7 +318,7 @@ namespace poseidon{
    }
 
    friend std::ostream& operator<<(std::ostream& stream, const OldPageTable& val){
-     return stream << "OldPageTable(num_pages=" << val.size() << ", marked=" << val.marked_ << ")";
+     return stream << "OldPageTable(num_pages=" << val.size() << ", marked=" << val.marked_ << ", committed=" << val.committed_ << ")";
    }
  };
 }
@@ -1,17 +1,274 @@
+#include <vector>
 #include "poseidon/heap/old_zone.h"
 
 namespace poseidon{
  uword OldZone::TryAllocate(int64_t size){
-   auto ptr = (void*)free_list()->TryAllocate(size);
-   auto val = new (ptr)RawObject();
+   int64_t total_size = 0;
+   auto address = free_list()->TryAllocate(size, &total_size);
+   if(address == 0)
+     return 0;
+
+   // the block may include slack that was too small to split off, the object absorbs it.
+   auto val = new ((void*)address)RawObject();
    val->SetOldBit();
-   val->SetPointerSize(size);
+   val->SetPointerSize(total_size - static_cast<int64_t>(sizeof(RawObject)));
 
    pages_.Mark(GetPageIndexFor(val->GetAddress()));
 
    return val->GetAddress();
  }
 
+ bool OldZone::TryRefill(PromotionLocalAllocationBuffer* buffer, int64_t size){
+   PSDN_ASSERT(buffer->GetNumberOfBytesRemaining() == 0);
+   int64_t total_size = 0;
+   auto address = free_list()->TryAllocate(size - static_cast<int64_t>(sizeof(RawObject)), &total_size);
+   if(address == 0)
+     return false;
+   pages_.Mark(GetPageIndexFor(address));
+   buffer->Reset(address, total_size);
+   return true;
+ }
+
+ int64_t OldZone::Retire(PromotionLocalAllocationBuffer* buffer){
+   auto remaining = buffer->GetNumberOfBytesRemaining();
+   int64_t wasted = 0;
+   if(remaining >= FreeList::kMinimumBlockSize){
+     free_list()->Add(buffer->GetCurrentAddress(), remaining);
+   } else if(remaining > 0){
+     // the sweeper reclaims the dead object once the page is swept.
+     auto filler = new (buffer->GetCurrentAddressPointer())RawObject();
+     filler->SetOldBit();
+     filler->SetPointerSize(remaining - static_cast<int64_t>(sizeof(RawObject)));
+     wasted = remaining;
+   }
+   buffer->Reset(0, 0);
+   return wasted;
+ }
+
+ int64_t OldZone::Grow(int64_t size){
+   int64_t committed = 0;
+   for(auto idx = 0; idx < pages_.size() && committed < size; idx++){
+     if(pages_.IsCommitted(idx))
+       continue;
+
+     auto page = pages(idx);
+     // the policy has to be set before the page is first touched.
+     if(IsNumaEnabled())
+       BindMemoryToNumaNode(page->GetStartingAddress(), page->GetSize(), GetNumaNodeFor(idx));
+
+     MemoryRegion region(page->GetStartingAddress(), page->GetSize());
+     if(!region.Commit()){
+       LOG(ERROR) << "cannot commit " << (*page) << ".";
+       break;
+     }
+     if(IsPreFaultEnabled())
+       region.Populate();
+     pages_.SetCommitted(idx);
+     // free blocks never span pages, so every page can be decommitted on its own.
+     free_list()->Add(page->GetStartingAddress(), page->GetSize());
+     // the mutator grows the zone while its writes are watched, the new page has to be watched as well.
+     if(IsWatchingWrites() && !watch_.Protect(page->GetStartingAddress(), page->GetSize()))
+       LOG(FATAL) << "cannot write-protect " << (*page) << ".";
+     committed += page->GetSize();
+   }
+   committed_ += committed;
+   return committed;
+ }
+
+ int64_t OldZone::Shrink(){
+   int64_t decommitted = 0;
+   int64_t released = 0;
+   // walk the pages backwards, so the zone shrinks from the top.
+   for(auto idx = pages_.size() - 1; idx >= 0; idx--){
+     if(!pages_.IsCommitted(idx))
+       continue;
+
+     auto page = pages(idx);
+     if(!page->IsEmpty()){
+       page->ResetIdleCount();
+       continue;
+     }
+     page->SetEmpty(false);
+
+     // pages only get returned once they stayed empty for a while, so they aren't released & re-faulted right away.
+     auto idle = page->IncrementIdleCount();
+     if(idle >= GetMemoryReleaseDelay()){
+       MemoryRegion region(page->GetStartingAddress(), page->GetSize());
+       if((GetCommittedSize() - page->GetSize()) >= GetOldZoneCommittedSize()){
+         if(region.Decommit()){
+           pages_.SetCommitted(idx, false);
+           pages_.Unmark(idx);
+           page->ClearMarks();
+           cards_.Clean(page->GetStartingAddress(), page->GetEndingAddress());
+           page->ResetIdleCount();
+           committed_ -= page->GetSize();
+           decommitted += page->GetSize();
+           continue;
+         }
+         LOG(ERROR) << "cannot decommit " << (*page) << ".";
+       } else if(HasMemoryRelease() && idle == GetMemoryReleaseDelay() && region.Release(IsLazyMemoryRelease())){
+         released += page->GetSize();
+       }
+     }
+     // the page is empty, so all of it becomes a single block.
+     free_list()->Add(page->GetStartingAddress(), page->GetSize());
+   }
+   DLOG_IF(INFO, released > 0) << "released " << Bytes(released) << " of " << (*this) << " to the OS.";
+   return decommitted;
+ }
+
+ int64_t OldZone::VisitDirtyCards(const std::function<void(uword*)>& vis){
+   int64_t dirty = 0;
+   // the fields are collected before the cards get cleaned, objects can share cards & the visitor can allocate in
+   // the pages that are still to be walked.
+   std::vector<uword*> slots;
+   for(auto idx = 0; idx < pages_.size(); idx++){
+     if(!pages_.IsCommitted(idx))
+       continue;
+
+     auto page = pages(idx);
+     auto last = cards_.GetLastDirtyCardEnd(page->GetStartingAddress(), page->GetEndingAddress());
+     if(last == 0)
+       continue;
+
+     // the cards don't record where objects start, so the page is walked from its start up to its last dirty card.
+     auto current = page->GetStartingAddress();
+     while(current < last && ((RawObject*)current)->GetPointerSize() > 0){
+       auto ptr = (RawObject*)current;
+       auto next = current + ptr->GetTotalSize();
+       if(!ptr->IsFree() && ptr->GetClassId() != kInvalidClassId && cards_.HasDirtyCards(current, next)){
+         ptr->VisitPointers([&](uword* slot){
+           if(cards_.IsDirty((uword)slot))
+             slots.push_back(slot);
+           return true;
+         });
+       }
+       current = next;
+     }
+     dirty += cards_.GetNumberOfDirtyCards(page->GetStartingAddress(), last);
+     cards_.Clean(page->GetStartingAddress(), last);
+   }
+
+   for(auto& slot : slots)
+     vis(slot);
+   return dirty;
+ }
+
+ void OldZone::VisitRememberedSlots(const std::function<void(uword*)>& vis){
+   std::vector<std::set<uword>> remembered(remembered_.size());
+   {
+     std::lock_guard<std::mutex> guard(remembered_mutex_);
+     remembered.swap(remembered_);
+   }
+
+   for(auto& slots : remembered){
+     for(auto& slot : slots)
+       vis((uword*)slot);
+   }
+ }
+
+ void OldZone::ForgetFreeSlots(){
+   WaitForRefinement();
+   uword slot;
+   std::vector<uword> buffered;
+   while(store_buffer_.Pop(&slot))
+     buffered.push_back(slot);
+   RememberSlots(buffered);
+
+   std::lock_guard<std::mutex> guard(remembered_mutex_);
+   for(auto idx = 0; idx < pages_.size(); idx++){
+     auto& slots = remembered_[idx];
+     if(slots.empty())
+       continue;
+
+     auto page = pages(idx);
+     auto current = page->GetStartingAddress();
+     while(current < page->GetEndingAddress() && ((RawObject*)current)->GetPointerSize() > 0){
+       auto ptr = (RawObject*)current;
+       auto next = current + ptr->GetTotalSize();
+       if(ptr->IsFree() || ptr->GetClassId() == kInvalidClassId)
+         slots.erase(slots.lower_bound(current), slots.lower_bound(next));
+       current = next;
+     }
+   }
+ }
+
+ bool OldZone::StartWriteWatch(){
+   if(IsWatchingWrites())
+     return true;
+
+   // the pages are protected one by one, which fails inside a hugetlb mapping & splits transparent huge pages.
+   if(HasHugePages()){
+     LOG(WARNING) << "cannot watch the writes to " << (*this) << " backed by huge pages, falling back to the write barrier.";
+     return false;
+   }
+
+   if(!watch_.Enable()){
+     LOG(WARNING) << "cannot watch the writes to " << (*this) << ", falling back to the write barrier.";
+     return false;
+   }
+
+   for(auto idx = 0; idx < pages_.size(); idx++){
+     if(!pages_.IsCommitted(idx))
+       continue;
+
+     auto page = pages(idx);
+     if(!watch_.Protect(page->GetStartingAddress(), page->GetSize()))
+       LOG(FATAL) << "cannot write-protect " << (*page) << ".";
+   }
+   watching_ = true;
+   return true;
+ }
+
+ int64_t OldZone::StopWriteWatch(){
+   if(!IsWatchingWrites())
+     return 0;
+
+   int64_t dirty = 0;
+   for(auto idx = 0; idx < pages_.size(); idx++){
+     if(!pages_.IsCommitted(idx))
+       continue;
+
+     auto page = pages(idx);
+     // the fault doesn't tell which field got written, so all of the cards of a dirty page get scanned.
+     watch_.VisitDirtyPages(page->GetStartingAddress(), page->GetEndingAddress(), [&](uword start, uword end){
+       cards_.Dirty(start, end);
+       dirty++;
+     });
+     if(!watch_.Unprotect(page->GetStartingAddress(), page->GetSize()))
+       LOG(FATAL) << "cannot unprotect " << (*page) << ".";
+   }
+   watching_ = false;
+   DLOG(INFO) << dirty << " pages of " << (*this) << " were written to.";
+   return dirty;
+ }
+
+ void OldZone::VisitMarkedPointers(RawObjectVisitor* vis) const{
+   for(auto& page : pages_){
+     if(!pages_.IsCommitted(&page))
+       continue;
+     auto done = false;
+     page.VisitMarkedPointers([&](RawObject* ptr){
+       return !(done = !vis->Visit(ptr));
+     });
+     if(done)
+       return;
+   }
+ }
+
+ void OldZone::VisitMarkedPointers(const std::function<bool(RawObject*)>& vis) const{
+   for(auto& page : pages_){
+     if(!pages_.IsCommitted(&page))
+       continue;
+     auto done = false;
+     page.VisitMarkedPointers([&](RawObject* ptr){
+       return !(done = !vis(ptr));
+     });
+     if(done)
+       return;
+   }
+ }
+
  void OldZone::VisitPages(const std::function<bool(OldPage*)>& vis) const{
    for(auto& page : pages_){
      if(!vis(&page))
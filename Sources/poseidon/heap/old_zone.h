@@ -1,11 +1,23 @@
 #ifndef POSEIDON_HEAP_OLD_ZONE_H
 #define POSEIDON_HEAP_OLD_ZONE_H
 
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "poseidon/flags.h"
 #include "poseidon/bitset.h"
 #include "poseidon/freelist.h"
 #include "poseidon/heap/zone.h"
 
 #include "poseidon/heap/old_page.h"
+#include "poseidon/heap/card_table.h"
+#include "poseidon/heap/store_buffer.h"
+#include "poseidon/heap/promotion_local_allocation_buffer.h"
+#include "poseidon/platform/numa.h"
+#include "poseidon/platform/write_watch.h"
 
 namespace poseidon{
  class OldZone : public Zone{
@@ -18,6 +30,16 @@ namespace poseidon{
    int64_t page_size_;
    FreeList* free_list_;
    OldPageTable pages_;
+   RelaxedAtomic<int64_t> committed_;
+   CardTable cards_;
+   StoreBuffer store_buffer_;
+   std::atomic<bool> refining_;
+   // the refined fields that reference new objects, a set per page.
+   std::mutex remembered_mutex_;
+   std::vector<std::set<uword>> remembered_;
+   // the pages written to by the mutator, w/ --page_protection.
+   WriteWatch watch_;
+   bool watching_;
 
    static inline int64_t
    CalculateTableSize(int64_t size, int64_t page_size){
@@ -26,9 +48,22 @@ namespace poseidon{
 
    OldZone(uword start, int64_t size, int64_t page_size, FreeList* free_list):// visible for testing?
     Zone(start, size),
+    page_size_(page_size),
+    free_list_(free_list),
     pages_(start, size, page_size),
-    free_list_(free_list){
+    committed_(0),
+    cards_(start, size),
+    store_buffer_(GetStoreBufferSize()),
+    refining_(false),
+    remembered_mutex_(),
+    remembered_(pages_.size()),
+    watch_(start, size),
+    watching_(false){
+     // the free list is managed by the caller, so the whole zone gets committed.
      SetWriteable();
+     for(auto idx = 0; idx < pages_.size(); idx++)
+       pages_.SetCommitted(idx);
+     committed_ = size;
    }
 
    OldZone(MemoryRegion* region, int64_t offset, int64_t size, int64_t page_size, FreeList* free_list):
@@ -54,9 +89,19 @@ namespace poseidon{
    OldZone(uword start, int64_t size, int64_t page_size):
      Zone(start, size),
      page_size_(page_size),
+     free_list_(new FreeList()),
      pages_(start, size, page_size),
-     free_list_(new FreeList(start, size)){
-     SetWriteable();
+     committed_(0),
+     cards_(start, size),
+     store_buffer_(GetStoreBufferSize()),
+     refining_(false),
+     remembered_mutex_(),
+     remembered_(pages_.size()),
+     watch_(start, size),
+     watching_(false){
+     Grow(std::min(size, GetOldZoneCommittedSize()));
+     if(IsPageProtectionEnabled())
+       StartWriteWatch();
    }
 
    OldZone(MemoryRegion* region, int64_t offset, int64_t size, int64_t page_size):
@@ -70,7 +115,10 @@ namespace poseidon{
    OldZone(MemoryRegion* region, int64_t page_size):
     OldZone(region, region->size(), page_size){
    }
-   ~OldZone() override = default;
+   ~OldZone() override{
+     // the memory of the zone outlives it, so its pages have to be writeable again.
+     StopWriteWatch();
+   }
 
    FreeList* free_list(){//TODO: visible for testing
      return free_list_;
@@ -80,11 +128,231 @@ namespace poseidon{
      return pages_.marked();
    }
 
+   int64_t GetNumberOfPages() const{
+     return pages_.size();
+   }
+
    OldPage* pages(int64_t index) const{
      return pages_[index];
    }
 
+   CardTable* cards(){
+     return &cards_;
+   }
+
+   OldPage* GetPageFor(RawObject* ptr){
+     return pages(GetPageIndexFor(ptr->GetAddress()));
+   }
+
+   /**
+    * Returns true if ptr is marked in the {@link MarkBitmap} of its page, the marks of old objects aren't kept in
+    * their headers.
+    */
+   bool IsMarked(RawObject* ptr){
+     return GetPageFor(ptr)->IsMarked(ptr);
+   }
+
+   bool TryMark(RawObject* ptr){
+     return GetPageFor(ptr)->TryMark(ptr);
+   }
+
+   void Mark(RawObject* ptr){
+     return GetPageFor(ptr)->Mark(ptr);
+   }
+
+   StoreBuffer* store_buffer(){
+     return &store_buffer_;
+   }
+
+   /**
+    * Records a store of a reference to a new object into slot, called by the write barrier of the mutator.
+    *
+    * The field is buffered for the refinement, the card of the field gets dirtied once the buffer is full.
+    *
+    * @return True if enough stores are buffered to start a refinement
+    */
+   bool RecordWrite(uword* slot){
+     if(!store_buffer_.Push((uword)slot))
+       cards_.Dirty((uword)slot);
+     return store_buffer_.size() >= GetRefinementBudget();
+   }
+
+   /**
+    * Adds slot, a field that references a new object, to the remembered set of its page.
+    */
+   void RememberSlot(uword* slot){
+     std::lock_guard<std::mutex> guard(remembered_mutex_);
+     remembered_[GetPageIndexFor((uword)slot)].insert((uword)slot);
+   }
+
+   void RememberSlots(const std::vector<uword>& slots){
+     std::lock_guard<std::mutex> guard(remembered_mutex_);
+     for(auto& slot : slots)
+       remembered_[GetPageIndexFor(slot)].insert(slot);
+   }
+
+   int64_t GetNumberOfRememberedSlots(){
+     std::lock_guard<std::mutex> guard(remembered_mutex_);
+     int64_t total = 0;
+     for(auto& slots : remembered_)
+       total += static_cast<int64_t>(slots.size());
+     return total;
+   }
+
+   /**
+    * Visits the fields in the remembered sets of the pages.
+    *
+    * The sets are emptied before the first field gets visited, vis has to remember the fields that still reference
+    * new objects again.
+    */
+   void VisitRememberedSlots(const std::function<void(uword*)>& vis);
+
+   /**
+    * Drops the remembered fields of the objects freed by the sweeper, buffered fields are refined first.
+    *
+    * Called during collection time, after sweeping.
+    */
+   void ForgetFreeSlots();
+
+   /**
+    * Visits the non-null reference fields of the objects in this zone that lie inside of a dirty card.
+    *
+    * All of the cards are cleaned before the first field gets visited, vis has to remember the fields that still
+    * reference new objects again.
+    *
+    * @return The number of dirty cards
+    */
+   int64_t VisitDirtyCards(const std::function<void(uword*)>& vis);
+
+   bool IsWatchingWrites() const{
+     return watching_;
+   }
+
+   /**
+    * Write-protects the committed pages, so the stores of the mutator into this zone get recorded w/o the write
+    * barrier. The first store to each page faults & dirties the page.
+    *
+    * Called after a collection w/ {@link IsPageProtectionEnabled()}.
+    *
+    * @return false if the OS can't deliver the write faults or the zone is backed by huge pages, the write barrier
+    * keeps recording the stores then
+    */
+   bool StartWriteWatch();
+
+   /**
+    * Dirties the cards of the pages written to since {@link StartWriteWatch()} & makes the committed pages
+    * writeable for the collector.
+    *
+    * Called before a collection.
+    *
+    * @return The number of dirty pages
+    */
+   int64_t StopWriteWatch();
+
+   bool IsRefining() const{
+     return refining_.load(std::memory_order_acquire);
+   }
+
+   /**
+    * Claims the refinement of this zone, there's only ever a single one as it's the consumer of the
+    * {@link StoreBuffer}.
+    *
+    * @return False if a refinement is already running
+    */
+   bool TryStartRefinement(){
+     auto expected = false;
+     return refining_.compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+   }
+
+   void FinishRefinement(){
+     refining_.store(false, std::memory_order_release);
+   }
+
+   void WaitForRefinement() const{
+     while(IsRefining())
+       std::this_thread::yield();
+   }
+
+   /**
+    * Returns the NUMA node of the page at index, the zone is split into a contiguous run of pages per node.
+    *
+    * @return The node of the page, or {@link kAnyNumaNode} if NUMA placement is disabled
+    */
+   NumaNode GetNumaNodeFor(int64_t index) const{
+     if(!IsNumaEnabled())
+       return kAnyNumaNode;
+     return static_cast<NumaNode>((index * GetNumberOfNumaNodes()) / pages_.size());
+   }
+
+   /**
+    * Returns the number of bytes of this zone that are backed by memory, the rest is only reserved.
+    */
+   int64_t GetCommittedSize() const{
+     return (int64_t)committed_;
+   }
+
+   /**
+    * Returns the percentage of the committed bytes that aren't in the free list.
+    */
+   int64_t GetOccupancy() const{
+     auto committed = GetCommittedSize();
+     if(committed <= 0)
+       return 0;
+     return ((committed - free_list_->GetTotalBytesFree()) * 100) / committed;
+   }
+
+   bool IsCommitted(OldPage* page) const{
+     return pages_.IsCommitted(page);
+   }
+
+   /**
+    * Commits enough reserved {@link OldPage}s to hold at least size bytes & adds them to the free list.
+    *
+    * @param size The number of bytes needed
+    * @return The number of bytes committed, 0 if the zone is fully committed
+    */
+   int64_t Grow(int64_t size);
+
+   /**
+    * Hands the {@link OldPage}s the sweeper found empty back to the free list, each as a single block. The sweeper
+    * already coalesced the free blocks of the other pages, so only the page table is walked.
+    *
+    * Pages that stayed empty for {@link GetMemoryReleaseDelay()} collections are decommitted as long as
+    * {@link GetOldZoneCommittedSize()} bytes stay committed, otherwise their memory is released to the OS.
+    *
+    * Called during collection time, after sweeping.
+    *
+    * @return The number of bytes decommitted
+    */
+   int64_t Shrink();
+
    uword TryAllocate(int64_t size) override;
+
+   /**
+    * Takes back the allocation of ptr, an object returned by {@link TryAllocate()} that was never used.
+    */
+   void Retract(RawObject* ptr){
+     free_list()->Add(ptr->GetAddress(), ptr->GetTotalSize());
+   }
+
+   /**
+    * Refills the {@link PromotionLocalAllocationBuffer} w/ a free block of at least size bytes, the buffer has to be
+    * retired first.
+    *
+    * @return false if no free block is large enough
+    */
+   bool TryRefill(PromotionLocalAllocationBuffer* buffer, int64_t size);
+
+   /**
+    * Retires the {@link PromotionLocalAllocationBuffer}, the unused tail goes back to the free list.
+    *
+    * @return The number of bytes wasted, a tail too small for a free block stays behind as a dead object
+    */
+   int64_t Retire(PromotionLocalAllocationBuffer* buffer);
+
+   void VisitMarkedPointers(RawObjectVisitor* vis) const override;
+   void VisitMarkedPointers(const std::function<bool(RawObject*)>& vis) const override;
+
    void VisitPages(const std::function<bool(OldPage*)>& vis) const;
    void VisitMarkedPages(const std::function<bool(OldPage*)>& vis) const;
 
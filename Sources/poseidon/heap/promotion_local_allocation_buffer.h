@@ -0,0 +1,112 @@
+#ifndef POSEIDON_HEAP_PROMOTION_LOCAL_ALLOCATION_BUFFER_H
+#define POSEIDON_HEAP_PROMOTION_LOCAL_ALLOCATION_BUFFER_H
+
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ /**
+  * A bump-pointer buffer carved out of a free block of an {@link OldZone} and owned by a single scavenger worker,
+  * which promotes objects into it.
+  *
+  * Promoting into a {@link PromotionLocalAllocationBuffer} requires no atomics, only the refill from the free list of
+  * the {@link OldZone} does. A free block never spans pages, so neither does the buffer.
+  */
+ class PromotionLocalAllocationBuffer{
+   friend class OldZone;
+  private:
+   uword start_;
+   uword current_;
+   uword end_;
+
+   inline void Reset(uword start, int64_t size){
+     start_ = start;
+     current_ = start;
+     end_ = start + size;
+   }
+  public:
+   constexpr PromotionLocalAllocationBuffer():
+    start_(0),
+    current_(0),
+    end_(0){
+   }
+   PromotionLocalAllocationBuffer(const PromotionLocalAllocationBuffer& rhs) = delete;
+   ~PromotionLocalAllocationBuffer() = default;
+
+   uword GetStartingAddress() const{
+     return start_;
+   }
+
+   uword GetCurrentAddress() const{
+     return current_;
+   }
+
+   void* GetCurrentAddressPointer() const{
+     return (void*)GetCurrentAddress();
+   }
+
+   uword GetEndingAddress() const{
+     return end_;
+   }
+
+   int64_t GetSize() const{
+     return static_cast<int64_t>(GetEndingAddress() - GetStartingAddress());
+   }
+
+   int64_t GetNumberOfBytesAllocated() const{
+     return static_cast<int64_t>(GetCurrentAddress() - GetStartingAddress());
+   }
+
+   int64_t GetNumberOfBytesRemaining() const{
+     return static_cast<int64_t>(GetEndingAddress() - GetCurrentAddress());
+   }
+
+   bool Contains(uword address) const{
+     return GetStartingAddress() <= address
+         && GetEndingAddress() > address;
+   }
+
+   /**
+    * Allocates a new old object of size bytes by bumping the current address of this buffer.
+    *
+    * @param size The size of the new object to allocate
+    * @return The address of the new object, or 0 if the buffer is exhausted
+    */
+   inline uword TryAllocate(int64_t size){
+     auto total_size = static_cast<int64_t>(sizeof(RawObject) + size);
+     if((GetCurrentAddress() + total_size) > GetEndingAddress())
+       return 0;
+     auto ptr = new (GetCurrentAddressPointer())RawObject(ObjectTag::OldWithSize(size));
+     current_ += total_size;
+     return ptr->GetAddress();
+   }
+
+   /**
+    * Takes back the allocation of ptr, which only works as long as ptr is the last object allocated.
+    *
+    * @return false if another object was allocated after ptr
+    */
+   inline bool TryRetract(RawObject* ptr){
+     if((ptr->GetAddress() + ptr->GetTotalSize()) != GetCurrentAddress())
+       return false;
+     current_ = ptr->GetAddress();
+     return true;
+   }
+
+   PromotionLocalAllocationBuffer& operator=(const PromotionLocalAllocationBuffer& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const PromotionLocalAllocationBuffer& val){
+     stream << "PromotionLocalAllocationBuffer(";
+     stream << "start=" << ((void*)val.GetStartingAddress()) << ", ";
+     stream << "allocated=" << Bytes(val.GetNumberOfBytesAllocated()) << ", ";
+     stream << "size=" << Bytes(val.GetSize());
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_HEAP_PROMOTION_LOCAL_ALLOCATION_BUFFER_H
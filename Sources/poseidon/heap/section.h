@@ -1,6 +1,7 @@
 #ifndef POSEIDON_HEAP_SECTION_H
 #define POSEIDON_HEAP_SECTION_H
 
+#include "poseidon/relaxed_atomic.h"
 #include "poseidon/platform/platform.h"
 
 namespace poseidon{
@@ -145,10 +146,17 @@ namespace poseidon{
      inline const AllocationSection* section() const{
        return section_;
      }
+
+     // free blocks are bookkeeping of the section, not objects.
+     inline void SkipFreeBlocks(){
+       while(current_address() < section()->GetEndingAddress() && current_ptr()->IsFree())
+         current_ += current_ptr()->GetTotalSize();
+     }
     public:
      explicit Iterator(const AllocationSection* section):
       section_(section),
       current_(section->GetStartingAddress()){
+       SkipFreeBlocks();
      }
      ~Iterator() override = default;
 
@@ -160,11 +168,12 @@ namespace poseidon{
      RawObject* Next() override{
        auto next = current_ptr();
        current_ += next->GetTotalSize();
+       SkipFreeBlocks();
        return next;
      }
    };
   protected:
-   uword current_;
+   RelaxedAtomic<uword> current_;
 
    AllocationSection():
     Section(),
@@ -183,7 +192,7 @@ namespace poseidon{
    ~AllocationSection() override = default;
 
    uword GetCurrentAddress() const{
-     return current_;
+     return (uword)current_;
    }
 
    void* GetCurrentAddressPointer() const{
@@ -1,14 +1,38 @@
 #include "poseidon/heap/semispace.h"
 
 namespace poseidon{
+ uword Semispace::TryClaim(int64_t size){
+   uword current = GetCurrentAddress();
+   do{
+     if((current + size) > GetEndingAddress())
+       return 0;
+   } while(!current_.compare_exchange_weak(current, current + size));
+   return current;
+ }
+
  uword Semispace::TryAllocate(int64_t size){
    auto total_size = static_cast<int64_t>(sizeof(RawObject) + size);
-   if((GetCurrentAddress() + total_size) > GetEndingAddress()){
+   auto address = TryClaim(total_size);
+   if(address == 0){
      PSDN_CANT_ALLOCATE(ERROR, total_size, (*this));
+     return 0;
    }
 
-   auto ptr = new (GetCurrentAddressPointer())RawObject(ObjectTag::NewWithSize(size));
-   current_ += total_size;
+   auto ptr = new ((void*)address)RawObject(ObjectTag::NewWithSize(size));
    return ptr->GetAddress();
  }
+
+ bool Semispace::TryRetract(RawObject* ptr){
+   auto current = ptr->GetAddress() + ptr->GetTotalSize();
+   return current_.compare_exchange_strong(current, ptr->GetAddress());
+ }
+
+ bool Semispace::TryRefill(LocalAllocationBuffer* buffer, int64_t size){
+   buffer->Retire();
+   auto start = TryClaim(size);
+   if(start == 0)
+     return false;
+   buffer->Reset(start, size);
+   return true;
+ }
 }
\ No newline at end of file
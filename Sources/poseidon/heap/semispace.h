@@ -6,6 +6,7 @@
 
 #include "poseidon/raw_object.h"
 #include "poseidon/heap/section.h"
+#include "poseidon/heap/local_allocation_buffer.h"
 #include "poseidon/platform/memory_region.h"
 
 namespace poseidon{
@@ -68,6 +69,9 @@ namespace poseidon{
    };
   private:
    RelaxedAtomic<uword> current_;
+
+   // claims size bytes at the current address, several threads can claim from the same semispace.
+   uword TryClaim(int64_t size);
   public:
    Semispace():
     Section(),
@@ -123,6 +127,21 @@ namespace poseidon{
 
    uword TryAllocate(int64_t size);
 
+   /**
+    * Takes back the allocation of ptr, which only works as long as ptr is the last object allocated.
+    *
+    * @return false if another object was allocated after ptr
+    */
+   bool TryRetract(RawObject* ptr);
+
+   /**
+    * Retires the {@link LocalAllocationBuffer} & refills it w/ the next size bytes of this {@link Semispace}, used by
+    * the scavenger workers to copy objects w/o contending on the current address.
+    *
+    * @return false if less than size bytes are left
+    */
+   bool TryRefill(LocalAllocationBuffer* buffer, int64_t size);
+
    void VisitPointers(RawObjectVisitor* vis) const{
      return IteratePointers<Semispace, SemispaceIterator>(this, vis);
    }
@@ -0,0 +1,102 @@
+#ifndef POSEIDON_HEAP_STORE_BUFFER_H
+#define POSEIDON_HEAP_STORE_BUFFER_H
+
+#include <atomic>
+#include <ostream>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+
+namespace poseidon{
+ /**
+  * A bounded queue of the fields the write barrier recorded.
+  *
+  * Each heap belongs to a single mutator, so there's a single producer. The fields are drained by a single
+  * consumer, either the concurrent refinement or the scavenger once the refinement stopped.
+  */
+ class StoreBuffer{
+   friend class StoreBufferTest;
+  private:
+   int64_t capacity_;
+   uword* slots_;
+   std::atomic<int64_t> head_;
+   std::atomic<int64_t> tail_;
+
+   inline int64_t mask() const{
+     return capacity_ - 1;
+   }
+  public:
+   explicit StoreBuffer(int64_t capacity):
+    capacity_(static_cast<int64_t>(RoundUpPowTwo(capacity > 0 ? capacity : 1))),
+    slots_(new uword[capacity_]),
+    head_(0),
+    tail_(0){
+   }
+   StoreBuffer(const StoreBuffer& rhs) = delete;
+   ~StoreBuffer(){
+     delete[] slots_;
+   }
+
+   int64_t capacity() const{
+     return capacity_;
+   }
+
+   int64_t size() const{
+     return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+   }
+
+   bool empty() const{
+     return size() == 0;
+   }
+
+   /**
+    * Appends slot, repeated stores to the last buffered field are only buffered once.
+    *
+    * Only called by the producer.
+    *
+    * @return False if the buffer is full
+    */
+   bool Push(uword slot){
+     auto tail = tail_.load(std::memory_order_relaxed);
+     auto head = head_.load(std::memory_order_acquire);
+     if(tail > head && slots_[(tail - 1) & mask()] == slot)
+       return true;
+     if((tail - head) >= capacity_)
+       return false;
+     slots_[tail & mask()] = slot;
+     tail_.store(tail + 1, std::memory_order_release);
+     return true;
+   }
+
+   /**
+    * Removes the oldest buffered field.
+    *
+    * Only called by the consumer, which reads the field afterwards.
+    *
+    * @return False if the buffer is empty
+    */
+   bool Pop(uword* result){
+     auto head = head_.load(std::memory_order_relaxed);
+     if(head == tail_.load(std::memory_order_acquire))
+       return false;
+     (*result) = slots_[head & mask()];
+     head_.store(head + 1, std::memory_order_release);
+     // pairs w/ the fence of the write barrier: either the producer sees the field was popped & buffers it again, or
+     // the consumer reads the value of the store the producer didn't buffer.
+     std::atomic_thread_fence(std::memory_order_seq_cst);
+     return true;
+   }
+
+   StoreBuffer& operator=(const StoreBuffer& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const StoreBuffer& val){
+     stream << "StoreBuffer(";
+     stream << "capacity=" << val.capacity() << ", ";
+     stream << "size=" << val.size();
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_HEAP_STORE_BUFFER_H
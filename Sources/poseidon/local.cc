@@ -38,7 +38,8 @@ namespace poseidon{//TODO: clean-up this code
    LocalPageIterator iter(this);
    while(iter.HasNext()){
      auto next = iter.NextPointer();
-     if((*next) && (*next)->GetPointerSize() > 0 && !vis(next))//TODO: investigate null next value
+     // a forwarded object has no size left in its header, but its slot still has to be updated.
+     if((*next) && ((*next)->IsForwarding() || (*next)->GetPointerSize() > 0) && !vis(next))//TODO: investigate null next value
        return;
    }
  }
@@ -6,6 +6,7 @@
 #include <glog/logging.h>
 
 #include "poseidon/utils.h"
+#include "poseidon/common.h"
 #include "poseidon/platform/platform.h"
 
 namespace poseidon{
@@ -19,6 +20,28 @@ namespace poseidon{
       kReadWriteExecute,
     };
 
+    enum PageMode{
+      kDefaultPages,
+      kTransparentHugePages,
+      kHugeTLBPages,
+    };
+
+    static constexpr const int64_t kHugePageSize = 2 * kMB;
+
+    inline friend std::ostream&
+    operator<<(std::ostream& stream, const PageMode& mode){
+      switch(mode){
+        case MemoryRegion::kDefaultPages:
+          return stream << "[default]";
+        case MemoryRegion::kTransparentHugePages:
+          return stream << "[thp]";
+        case MemoryRegion::kHugeTLBPages:
+          return stream << "[hugetlb]";
+        default:
+          return stream << "[unknown]";
+      }
+    }
+
     inline friend std::ostream&
     operator<<(std::ostream& stream, const ProtectionMode& mode){
       switch(mode){
@@ -56,9 +79,13 @@ namespace poseidon{
     /**
      * Create a new {@link MemoryRegion} of a specific size.
      *
+     * W/ huge pages the {@link MemoryRegion} is aligned to & rounded up to {@link kHugePageSize}. kHugeTLBPages
+     * falls back to transparent huge pages when no huge pages are available, which fall back to default pages.
+     *
      * @param size The size of the new {@link MemoryRegion}
+     * @param mode The pages backing the new {@link MemoryRegion}
      */
-    explicit MemoryRegion(int64_t size);
+    explicit MemoryRegion(int64_t size, const PageMode& mode = kDefaultPages);
 
     /**
      * Create a new {@link MemoryRegion} using the specified starting address & size.
@@ -132,6 +159,49 @@ namespace poseidon{
      */
     virtual bool Protect(const ProtectionMode& mode) const;
 
+    /**
+     * Commits the {@link MemoryRegion}, making it readable & writable.
+     *
+     * @return true if the {@link MemoryRegion} was committed, false otherwise.
+     */
+    bool Commit() const{
+      return Protect(kReadWrite);
+    }
+
+    /**
+     * Pre-faults the pages of the {@link MemoryRegion}, so they don't fault when they are first written to. The
+     * contents of the {@link MemoryRegion} are left untouched, it has to be committed.
+     *
+     * @return true if the {@link MemoryRegion} was populated, false otherwise.
+     */
+    virtual bool Populate() const;
+
+    /**
+     * Returns the memory backing the {@link MemoryRegion} to the OS, the {@link MemoryRegion} stays committed.
+     *
+     * @param lazy Let the OS reclaim the memory only under pressure, the contents are undefined until written to.
+     *             Otherwise the memory is dropped right away & reads as zero.
+     * @return true if the {@link MemoryRegion} was released, false otherwise.
+     */
+    virtual bool Release(bool lazy = false) const;
+
+    /**
+     * Returns the memory backing the {@link MemoryRegion} to the OS & makes it inaccessible, the address range
+     * stays reserved & can be committed again later.
+     *
+     * @return true if the {@link MemoryRegion} was decommitted, false otherwise.
+     */
+    virtual bool Decommit() const;
+
+    /**
+     * Returns the number of bytes of the {@link MemoryRegion} that are currently backed by huge pages, as reported
+     * by the OS. The OS reports per mapping, so a mapping shared w/ memory outside of this region is clamped to
+     * the size of the overlap.
+     *
+     * @return The number of huge page backed bytes, or 0 if the OS doesn't report them.
+     */
+    int64_t GetHugePageBackedSize() const;
+
     MemoryRegion& operator=(const MemoryRegion& rhs){
       if(this == &rhs)
         return *this;
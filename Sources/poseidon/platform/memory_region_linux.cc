@@ -1,33 +1,87 @@
 #include "memory_region.h"
 #if defined(OS_IS_LINUX)
 
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
 #include <sys/mman.h>
 #include <glog/logging.h>
-#include "utils.h"
+
+#include "poseidon/utils.h"
 
 #undef MAP_FAILED
 #define MAP_FAILED reinterpret_cast<void*>(-1)
 
 namespace poseidon{
-  MemoryRegion::MemoryRegion(const uword& size):
-    MemoryRegion(true){
-    void* addr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+  static inline void*
+  Reserve(int64_t size, int flags = MAP_NORESERVE){
+    return mmap(nullptr, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|flags, -1, 0);
+  }
+
+  // over-reserves by a huge page & trims the ends, so the reservation starts on a huge page boundary.
+  static inline void*
+  ReserveAligned(int64_t size, int64_t alignment){
+    void* addr = Reserve(size + alignment);
+    if(addr == MAP_FAILED)
+      return MAP_FAILED;
+
+    auto start = (uword)addr;
+    auto aligned = (start + (alignment - 1)) & ~(alignment - 1);
+    if(aligned > start)
+      munmap(addr, aligned - start);
+    auto tail = (start + size + alignment) - (aligned + size);
+    if(tail > 0)
+      munmap((void*)(aligned + size), tail);
+    return (void*)aligned;
+  }
+
+  MemoryRegion::MemoryRegion(int64_t size, const PageMode& mode):
+    MemoryRegion(){
+    if(mode == kDefaultPages){
+      void* addr = Reserve(size);
+      if(addr == MAP_FAILED){
+        LOG(ERROR) << "failed to mmap memory region of " << size << " bytes: " << strerror(errno);
+        return;
+      }
+
+      start_ = (uword)addr;
+      size_ = size;
+      return;
+    }
+
+    size = (size + (kHugePageSize - 1)) & ~(kHugePageSize - 1);
+#ifdef MAP_HUGETLB
+    if(mode == kHugeTLBPages){
+      // w/o MAP_NORESERVE the huge pages are reserved up front, so the mmap fails instead of faulting later on.
+      void* addr = Reserve(size, MAP_HUGETLB);
+      if(addr != MAP_FAILED){
+        start_ = (uword)addr;
+        size_ = size;
+        return;
+      }
+      DLOG(WARNING) << "cannot mmap memory region of " << Bytes(size) << " w/ huge pages, falling back to transparent huge pages: " << strerror(errno);
+    }
+#endif//MAP_HUGETLB
+
+    void* addr = ReserveAligned(size, kHugePageSize);
     if(addr == MAP_FAILED){
       LOG(ERROR) << "failed to mmap memory region of " << size << " bytes: " << strerror(errno);
       return;
     }
+#ifdef MADV_HUGEPAGE
+    if(madvise(addr, size, MADV_HUGEPAGE) != 0)
+      DLOG(WARNING) << "cannot use transparent huge pages for memory region of " << Bytes(size) << ": " << strerror(errno);
+#endif//MADV_HUGEPAGE
 
-    data_ = addr;
+    start_ = (uword)addr;
     size_ = size;
   }
 
-  MemoryRegion::~MemoryRegion(){
-    if(owned_ && data_ != nullptr && size_ > 0){
-      int err;
-      if((err = munmap(data_, size_)) != 0){
-        LOG(ERROR) << "failed to munmap memory region of " << size_ << " bytes: " << strerror(err);
-      }
-      DLOG(INFO) << "freed MemoryRegion (" << HumanReadableSize(size_) << ")";
+  void MemoryRegion::FreeRegion(){
+    if(size_ > 0){
+      if(munmap((void*)start_, size_) != 0)
+        LOG(FATAL) << "failed to munmap memory region of " << Bytes(size_) << " bytes: " << strerror(errno);
+      DLOG(INFO) << "freed MemoryRegion (" << Bytes(size_) << ")";
     }
   }
 
@@ -51,13 +105,83 @@ namespace poseidon{
         break;
     }
 
-    int err;
-    if((err = mprotect(GetPointer(), GetSize(), protection)) != 0){
-      LOG(ERROR) << "failed to " << mode << " protect memory region of " << GetSize() << " bytes @" << GetPointer() << ": " << strerror(err);
+    if(mprotect(GetStartingAddressPointer(), size(), protection) != 0){
+      LOG(ERROR) << "failed to " << mode << " protect memory region of " << size() << " bytes @" << GetStartingAddressPointer() << ": " << strerror(errno);
       return false;
     }
     return true;
   }
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif//MADV_POPULATE_WRITE
+
+  bool MemoryRegion::Populate() const{
+    // kernels older than 5.14 don't know MADV_POPULATE_WRITE, fall back to writing to every page.
+    if(madvise(GetStartingAddressPointer(), size(), MADV_POPULATE_WRITE) == 0)
+      return true;
+
+    static const int64_t kPageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+    for(auto address = GetStartingAddress(); address < GetEndingAddress(); address += kPageSize){
+      auto ptr = (volatile uint8_t*)address;
+      (*ptr) = (*ptr);
+    }
+    return true;
+  }
+
+  bool MemoryRegion::Release(bool lazy) const{
+#ifdef MADV_FREE
+    // kernels older than 4.5 don't know MADV_FREE, fall back to MADV_DONTNEED.
+    if(lazy && madvise(GetStartingAddressPointer(), size(), MADV_FREE) == 0)
+      return true;
+#endif//MADV_FREE
+    // MADV_DONTNEED drops the pages right away, touching them again faults in zeroed pages.
+    if(madvise(GetStartingAddressPointer(), size(), MADV_DONTNEED) != 0){
+      LOG(ERROR) << "failed to release memory region of " << Bytes(size()) << " @" << GetStartingAddressPointer() << ": " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  bool MemoryRegion::Decommit() const{
+    return Release()
+        && Protect(kNoAccess);
+  }
+
+  static inline bool
+  IsHugePageField(const char* name){
+    return strcmp(name, "AnonHugePages") == 0
+        || strcmp(name, "Private_Hugetlb") == 0
+        || strcmp(name, "Shared_Hugetlb") == 0;
+  }
+
+  int64_t MemoryRegion::GetHugePageBackedSize() const{
+    FILE* smaps;
+    if((smaps = fopen("/proc/self/smaps", "r")) == nullptr){
+      DLOG(WARNING) << "cannot open /proc/self/smaps: " << strerror(errno);
+      return 0;
+    }
+
+    int64_t total = 0;
+    int64_t overlap = 0;
+    char line[256];
+    while(fgets(line, sizeof(line), smaps) != nullptr){
+      uword start, end;
+      if(sscanf(line, "%lx-%lx ", &start, &end) == 2){
+        auto from = std::max(start, GetStartingAddress());
+        auto to = std::min(end, GetEndingAddress());
+        overlap = to > from ? static_cast<int64_t>(to - from) : 0;
+        continue;
+      }
+
+      char name[64];
+      long long kb;
+      if(overlap > 0 && sscanf(line, "%63[^:]: %lld kB", name, &kb) == 2 && IsHugePageField(name))
+        total += std::min(static_cast<int64_t>(kb) * kKB, overlap);
+    }
+    fclose(smaps);
+    return total;
+  }
 }
 
-#endif//OS_IS_LINUX
\ No newline at end of file
+#endif//OS_IS_LINUX
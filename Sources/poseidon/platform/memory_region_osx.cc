@@ -1,6 +1,7 @@
 #include "memory_region.h"
 #ifdef OS_IS_OSX
 
+#include <unistd.h>
 #include <sys/mman.h>
 #include <glog/logging.h>
 
@@ -10,8 +11,11 @@
 #define MAP_FAILED reinterpret_cast<void*>(-1)
 
 namespace poseidon{
-  MemoryRegion::MemoryRegion(int64_t size):
+  MemoryRegion::MemoryRegion(int64_t size, const PageMode& mode):
     MemoryRegion(){
+    // osx superpages can't be reserved & committed on demand, so the region is always backed by regular pages.
+    if(mode != kDefaultPages)
+      LOG(WARNING) << "superpages aren't supported, mapping memory region of " << Bytes(size) << " w/ regular pages instead of " << mode << ".";
     void* addr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
     if(addr == MAP_FAILED){
       LOG(ERROR) << "failed to mmap memory region of " << size << " bytes: " << strerror(errno);
@@ -58,6 +62,43 @@ namespace poseidon{
     }
     return true;
   }
+
+  bool MemoryRegion::Populate() const{
+    // osx has no MAP_POPULATE or MADV_POPULATE_WRITE, write to every page instead.
+    static const int64_t kPageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+    madvise(GetStartingAddressPointer(), size(), MADV_WILLNEED);
+    for(auto address = GetStartingAddress(); address < GetEndingAddress(); address += kPageSize){
+      auto ptr = (volatile uint8_t*)address;
+      (*ptr) = (*ptr);
+    }
+    return true;
+  }
+
+  bool MemoryRegion::Release(bool lazy) const{
+    if(lazy && madvise(GetStartingAddressPointer(), size(), MADV_FREE) == 0)
+      return true;
+
+    // madvise doesn't release anonymous memory right away on osx, mapping fresh pages over the range does.
+    void* addr = mmap(GetStartingAddressPointer(), size(), PROT_READ|PROT_WRITE, MAP_FIXED|MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if(addr == MAP_FAILED){
+      LOG(ERROR) << "failed to release memory region of " << Bytes(size()) << " @" << GetStartingAddressPointer() << ": " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  int64_t MemoryRegion::GetHugePageBackedSize() const{
+    return 0;
+  }
+
+  bool MemoryRegion::Decommit() const{
+    void* addr = mmap(GetStartingAddressPointer(), size(), PROT_NONE, MAP_FIXED|MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if(addr == MAP_FAILED){
+      LOG(ERROR) << "failed to decommit memory region of " << Bytes(size()) << " @" << GetStartingAddressPointer() << ": " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
 }
 
 #endif//OS_IS_OSX
\ No newline at end of file
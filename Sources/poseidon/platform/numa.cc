@@ -0,0 +1,119 @@
+#include <mutex>
+#include <sstream>
+#include <glog/logging.h>
+
+#include "poseidon/flags.h"
+#include "poseidon/platform/numa.h"
+
+namespace poseidon{
+ static thread_local NumaNode current_node_ = kAnyNumaNode;
+
+ static inline bool
+ ParseInt(const std::string& value, int* result){
+   if(value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+     return false;
+   (*result) = std::stoi(value);
+   return true;
+ }
+
+ bool NumaTopology::ParseCpuList(const std::string& cpus, std::vector<int>* result){
+   std::stringstream stream(cpus);
+   std::string range;
+   while(std::getline(stream, range, ',')){
+     auto dash = range.find('-');
+     int first = 0;
+     int last = 0;
+     if(dash == std::string::npos){
+       if(!ParseInt(range, &first))
+         return false;
+       last = first;
+     } else if(!ParseInt(range.substr(0, dash), &first) || !ParseInt(range.substr(dash + 1), &last) || last < first){
+       return false;
+     }
+
+     for(auto cpu = first; cpu <= last; cpu++)
+       result->push_back(cpu);
+   }
+   return !result->empty();
+ }
+
+ bool NumaTopology::Parse(const std::string& topology, NumaTopology* result){
+   NumaTopology parsed;
+   std::stringstream stream(topology);
+   std::string node;
+   while(std::getline(stream, node, ';')){
+     std::vector<int> cpus;
+     if(!ParseCpuList(node, &cpus)){
+       LOG(ERROR) << "cannot parse cpus of node" << parsed.GetNumberOfNodes() << " in NUMA topology: " << topology;
+       return false;
+     }
+     parsed.AddNode(cpus);
+   }
+
+   if(parsed.GetNumberOfNodes() == 0)
+     return false;
+   parsed.fake_ = true;
+   (*result) = parsed;
+   return true;
+ }
+
+ NumaNode NumaTopology::GetNodeForCpu(int cpu) const{
+   for(NumaNode node = 0; node < GetNumberOfNodes(); node++){
+     for(auto& next : GetCpus(node)){
+       if(next == cpu)
+         return node;
+     }
+   }
+   return kAnyNumaNode;
+ }
+
+ static inline NumaTopology
+ CreateNumaTopology(){
+   NumaTopology topology;
+   if(HasNumaTopology() && NumaTopology::Parse(GetNumaTopologyString(), &topology))
+     return topology;
+
+   topology = NumaTopology();
+   if(!ReadNumaTopology(&topology) || topology.GetNumberOfNodes() == 0){
+     // no topology, treat the system as a single node.
+     topology = NumaTopology();
+     topology.AddNode({ GetCurrentCpu() });
+   }
+   return topology;
+ }
+
+ const NumaTopology& GetNumaTopology(){
+   static const NumaTopology kTopology = CreateNumaTopology();
+   return kTopology;
+ }
+
+ NumaNode GetCurrentNumaNode(){
+   if(current_node_ != kAnyNumaNode)
+     return current_node_;
+   auto node = GetNumaTopology().GetNodeForCpu(GetCurrentCpu());
+   return node != kAnyNumaNode ? node : 0;
+ }
+
+ bool BindCurrentThreadToNumaNode(const NumaNode& node){
+   auto& topology = GetNumaTopology();
+   if(node < 0 || node >= topology.GetNumberOfNodes()){
+     LOG(WARNING) << "cannot bind thread to unknown NUMA node " << node << ".";
+     return false;
+   }
+
+   // a faked node still steers the work the thread picks, even if the OS rejects its cpus.
+   current_node_ = node;
+   if(!SetCurrentThreadAffinity(topology.GetCpus(node))){
+     DLOG(WARNING) << "cannot set the cpu affinity of the current thread for NUMA node " << node << ".";
+     return false;
+   }
+   return true;
+ }
+
+ bool BindMemoryToNumaNode(uword start, int64_t size, const NumaNode& node){
+   auto& topology = GetNumaTopology();
+   if(topology.IsFake() || node < 0 || node >= topology.GetNumberOfNodes())
+     return false;
+   return SetMemoryPolicy(start, size, node);
+ }
+}
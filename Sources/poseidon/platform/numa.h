@@ -0,0 +1,131 @@
+#ifndef POSEIDON_NUMA_H
+#define POSEIDON_NUMA_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ typedef int32_t NumaNode;
+ static constexpr const NumaNode kAnyNumaNode = -1;
+
+ /**
+  * The NUMA nodes of the system & the cpus of each node.
+  *
+  * The topology is read from the OS, unless {@link GetNumaTopologyString()} fakes one. A faked topology only steers
+  * the placement decisions, memory is never bound to a node the OS doesn't know about.
+  */
+ class NumaTopology{
+  private:
+   std::vector<std::vector<int>> cpus_;
+   bool fake_;
+  public:
+   NumaTopology():
+    cpus_(),
+    fake_(false){
+   }
+   NumaTopology(const NumaTopology& rhs) = default;
+   ~NumaTopology() = default;
+
+   int64_t GetNumberOfNodes() const{
+     return static_cast<int64_t>(cpus_.size());
+   }
+
+   bool IsFake() const{
+     return fake_;
+   }
+
+   const std::vector<int>& GetCpus(const NumaNode& node) const{
+     return cpus_[node];
+   }
+
+   /**
+    * Adds a node w/ the given cpus to this topology.
+    *
+    * @return The new node
+    */
+   NumaNode AddNode(const std::vector<int>& cpus){
+     cpus_.push_back(cpus);
+     return static_cast<NumaNode>(cpus_.size() - 1);
+   }
+
+   /**
+    * Returns the node that owns cpu, or {@link kAnyNumaNode} if no node does.
+    */
+   NumaNode GetNodeForCpu(int cpu) const;
+
+   NumaTopology& operator=(const NumaTopology& rhs) = default;
+
+   friend std::ostream& operator<<(std::ostream& stream, const NumaTopology& val){
+     stream << "NumaTopology(";
+     for(NumaNode node = 0; node < val.GetNumberOfNodes(); node++){
+       if(node > 0)
+         stream << ", ";
+       stream << "node" << node << "=[";
+       auto& cpus = val.GetCpus(node);
+       for(size_t idx = 0; idx < cpus.size(); idx++)
+         stream << (idx > 0 ? "," : "") << cpus[idx];
+       stream << "]";
+     }
+     if(val.IsFake())
+       stream << ", fake";
+     stream << ")";
+     return stream;
+   }
+
+   /**
+    * Parses a topology in the format of the cpu lists in /sys/devices/system/node, w/ the nodes separated by ';'.
+    *
+    * ex: "0-3;4-7" is two nodes w/ four cpus each.
+    *
+    * @param topology The topology to parse
+    * @param result The parsed topology, marked as fake
+    * @return true if the topology was parsed, false otherwise.
+    */
+   static bool Parse(const std::string& topology, NumaTopology* result);
+
+   /**
+    * Parses a single cpu list, ex: "0-3,8,10-11".
+    */
+   static bool ParseCpuList(const std::string& cpus, std::vector<int>* result);
+ };
+
+ /**
+  * Returns the topology of this process, read once.
+  */
+ const NumaTopology& GetNumaTopology();
+
+ static inline int64_t
+ GetNumberOfNumaNodes(){
+   return GetNumaTopology().GetNumberOfNodes();
+ }
+
+ /**
+  * Returns the node the calling thread is bound to, or the node of the cpu it is running on if it isn't bound.
+  */
+ NumaNode GetCurrentNumaNode();
+
+ /**
+  * Binds the calling thread to the cpus of node.
+  *
+  * @return true if the thread was bound, false otherwise.
+  */
+ bool BindCurrentThreadToNumaNode(const NumaNode& node);
+
+ /**
+  * Sets the preferred node of the pages in [start, start + size), pages already touched stay where they are.
+  *
+  * @return true if the memory was bound, false otherwise or if the topology is faked.
+  */
+ bool BindMemoryToNumaNode(uword start, int64_t size, const NumaNode& node);
+
+ // OS specific, see numa_linux.cc & numa_osx.cc
+ bool ReadNumaTopology(NumaTopology* result);
+ int GetCurrentCpu();
+ bool SetCurrentThreadAffinity(const std::vector<int>& cpus);
+ bool SetMemoryPolicy(uword start, int64_t size, const NumaNode& node);
+}
+
+#endif //POSEIDON_NUMA_H
@@ -0,0 +1,79 @@
+#include "poseidon/platform/numa.h"
+#ifdef OS_IS_LINUX
+
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fstream>
+#include <sys/syscall.h>
+#include <glog/logging.h>
+
+#include "poseidon/utils.h"
+
+namespace poseidon{
+ // from linux/mempolicy.h, libnuma isn't required for a single syscall.
+ static constexpr const int kMemoryPolicyPreferred = 1;
+
+ static inline bool
+ ReadLine(const std::string& filename, std::string* result){
+   std::ifstream file(filename);
+   return file.good() && std::getline(file, *result);
+ }
+
+ bool ReadNumaTopology(NumaTopology* result){
+   std::string online;
+   std::vector<int> nodes;
+   if(!ReadLine("/sys/devices/system/node/online", &online) || !NumaTopology::ParseCpuList(online, &nodes))
+     return false;
+
+   // the node ids are used as is, so nodes missing from a sparse list are added w/o any cpus.
+   auto last = nodes.back();
+   for(auto node = 0; node <= last; node++){
+     std::string cpulist;
+     std::vector<int> cpus;
+     if(ReadLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", &cpulist))
+       NumaTopology::ParseCpuList(cpulist, &cpus);
+     result->AddNode(cpus);
+   }
+   return true;
+ }
+
+ int GetCurrentCpu(){
+   auto cpu = sched_getcpu();
+   return cpu >= 0 ? cpu : 0;
+ }
+
+ bool SetCurrentThreadAffinity(const std::vector<int>& cpus){
+   if(cpus.empty())
+     return false;
+
+   cpu_set_t set;
+   CPU_ZERO(&set);
+   for(auto& cpu : cpus){
+     if(cpu < CPU_SETSIZE)
+       CPU_SET(cpu, &set);
+   }
+
+   if(sched_setaffinity(0, sizeof(set), &set) != 0){
+     DLOG(WARNING) << "sched_setaffinity failed: " << strerror(errno);
+     return false;
+   }
+   return true;
+ }
+
+ bool SetMemoryPolicy(uword start, int64_t size, const NumaNode& node){
+   static const uword kPageSize = static_cast<uword>(sysconf(_SC_PAGESIZE));
+   auto aligned = start & ~(kPageSize - 1);
+   auto length = static_cast<unsigned long>((start + size) - aligned);
+
+   unsigned long mask = 1UL << node;
+   if(syscall(SYS_mbind, (void*)aligned, length, kMemoryPolicyPreferred, &mask, sizeof(mask) * 8, 0) != 0){
+     LOG(WARNING) << "cannot bind " << Bytes(size) << " @" << ((void*)start) << " to NUMA node " << node << ": " << strerror(errno);
+     return false;
+   }
+   return true;
+ }
+}
+
+#endif//OS_IS_LINUX
@@ -0,0 +1,23 @@
+#include "poseidon/platform/numa.h"
+#ifdef OS_IS_OSX
+
+namespace poseidon{
+ // macOS doesn't expose its memory topology, the system is treated as a single node.
+ bool ReadNumaTopology(NumaTopology* result){
+   return false;
+ }
+
+ int GetCurrentCpu(){
+   return 0;
+ }
+
+ bool SetCurrentThreadAffinity(const std::vector<int>& cpus){
+   return false;
+ }
+
+ bool SetMemoryPolicy(uword start, int64_t size, const NumaNode& node){
+   return false;
+ }
+}
+
+#endif//OS_IS_OSX
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <unistd.h>
+#include <glog/logging.h>
+
+#include "poseidon/platform/memory_region.h"
+#include "poseidon/platform/write_watch.h"
+
+namespace poseidon{
+ // read by the fault handler, so the watches are kept in a fixed table instead of a container that could allocate.
+ static std::atomic<WriteWatch*> watches_[WriteWatch::kMaxNumberOfWatches];
+
+ int64_t WriteWatch::GetPageSize(){
+   static const int64_t kPageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+   return kPageSize;
+ }
+
+ WriteWatch* WriteWatch::FindWatchFor(uword address){
+   for(auto& entry : watches_){
+     auto watch = entry.load(std::memory_order_acquire);
+     if(watch != nullptr && watch->Contains(address))
+       return watch;
+   }
+   return nullptr;
+ }
+
+ WriteWatch::WriteWatch(uword start, int64_t size):
+  start_(start),
+  size_(size),
+  num_pages_((size + (GetPageSize() - 1)) / GetPageSize()),
+  dirty_(new RelaxedAtomic<uint8_t>[num_pages_]),
+  enabled_(false){
+ }
+
+ WriteWatch::~WriteWatch(){
+   Disable();
+   delete[] dirty_;
+ }
+
+ bool WriteWatch::Enable(){
+   if(IsEnabled())
+     return true;
+
+   if(!InstallFaultHandler()){
+     DLOG(WARNING) << "cannot install the write fault handler.";
+     return false;
+   }
+
+   for(auto& entry : watches_){
+     WriteWatch* expected = nullptr;
+     if(entry.compare_exchange_strong(expected, this, std::memory_order_acq_rel)){
+       enabled_ = true;
+       return true;
+     }
+   }
+   DLOG(WARNING) << "cannot enable " << (*this) << ", " << kMaxNumberOfWatches << " watches are already enabled.";
+   return false;
+ }
+
+ void WriteWatch::Disable(){
+   if(!IsEnabled())
+     return;
+
+   for(auto& entry : watches_){
+     WriteWatch* expected = this;
+     if(entry.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+       break;
+   }
+   enabled_ = false;
+ }
+
+ int64_t WriteWatch::GetNumberOfDirtyPages() const{
+   int64_t dirty = 0;
+   for(int64_t idx = 0; idx < GetNumberOfPages(); idx++){
+     if(IsDirty(idx))
+       dirty++;
+   }
+   return dirty;
+ }
+
+ bool WriteWatch::Protect(uword start, int64_t size){
+   PSDN_ASSERT(IsEnabled());
+   for(auto idx = GetPageIndexFor(start); idx <= GetPageIndexFor(start + size - 1); idx++)
+     dirty_[idx].store(0);
+   // the dirty pages are cleaned before the pages get protected, a write in between faults & dirties its page again.
+   MemoryRegion region(start, size);
+   return region.Protect(MemoryRegion::kReadOnly);
+ }
+
+ bool WriteWatch::Unprotect(uword start, int64_t size){
+   MemoryRegion region(start, size);
+   return region.Protect(MemoryRegion::kReadWrite);
+ }
+
+ void WriteWatch::VisitDirtyPages(uword start, uword end, const std::function<void(uword, uword)>& vis) const{
+   for(auto idx = GetPageIndexFor(start); idx <= GetPageIndexFor(end - 1); idx++){
+     if(IsDirty(idx))
+       vis(GetPageAddress(idx), GetPageAddress(idx + 1));
+   }
+ }
+}
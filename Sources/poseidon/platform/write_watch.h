@@ -0,0 +1,147 @@
+#ifndef POSEIDON_WRITE_WATCH_H
+#define POSEIDON_WRITE_WATCH_H
+
+#include <ostream>
+#include <functional>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+#include "poseidon/relaxed_atomic.h"
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ /**
+  * Tracks the pages of a range of memory that get written to, w/o instrumenting the stores.
+  *
+  * The protected pages are write-protected & the first write to each of them faults. The fault handler records the
+  * page as dirty & makes it writeable again, the faulting store is retried & the later stores to the page run at
+  * full speed.
+  *
+  * Stores by the OS, ex: a read(2) into a protected page, fail w/ EFAULT instead of faulting.
+  */
+ class WriteWatch{
+   friend class WriteWatchTest;
+  public:
+   static constexpr const int64_t kMaxNumberOfWatches = 64;
+
+   /**
+    * Returns the size of the pages tracked by a {@link WriteWatch}, the page size of the OS.
+    */
+   static int64_t GetPageSize();
+
+   /**
+    * Returns the enabled {@link WriteWatch} that contains address, called by the fault handler.
+    *
+    * @return The {@link WriteWatch}, or nullptr if address isn't watched
+    */
+   static WriteWatch* FindWatchFor(uword address);
+  private:
+   // installs the fault handler of the OS, only the first call installs it.
+   static bool InstallFaultHandler();
+
+   uword start_;
+   int64_t size_;
+   int64_t num_pages_;
+   RelaxedAtomic<uint8_t>* dirty_;
+   bool enabled_;
+  public:
+   WriteWatch(uword start, int64_t size);
+   WriteWatch(const WriteWatch& rhs) = delete;
+   ~WriteWatch();
+
+   uword GetStartingAddress() const{
+     return start_;
+   }
+
+   uword GetEndingAddress() const{
+     return start_ + size_;
+   }
+
+   int64_t GetNumberOfPages() const{
+     return num_pages_;
+   }
+
+   bool Contains(uword address) const{
+     return address >= GetStartingAddress() && address < GetEndingAddress();
+   }
+
+   int64_t GetPageIndexFor(uword address) const{
+     PSDN_ASSERT(Contains(address));
+     return static_cast<int64_t>(address - GetStartingAddress()) / GetPageSize();
+   }
+
+   uword GetPageAddress(int64_t index) const{
+     return GetStartingAddress() + (static_cast<uword>(index) * GetPageSize());
+   }
+
+   bool IsEnabled() const{
+     return enabled_;
+   }
+
+   bool IsDirty(int64_t index) const{
+     return dirty_[index].load() != 0;
+   }
+
+   bool IsDirty(uword address) const{
+     return IsDirty(GetPageIndexFor(address));
+   }
+
+   int64_t GetNumberOfDirtyPages() const;
+
+   /**
+    * Registers this {@link WriteWatch} w/ the fault handler.
+    *
+    * @return false if the OS can't deliver write faults or too many {@link WriteWatch}es are enabled
+    */
+   bool Enable();
+
+   /**
+    * Unregisters this {@link WriteWatch}, the protected pages have to be made writeable first.
+    */
+   void Disable();
+
+   /**
+    * Forgets the dirty pages of [start, start + size) & write-protects them, the range has to be committed.
+    *
+    * @return true if the pages were protected, false otherwise.
+    */
+   bool Protect(uword start, int64_t size);
+
+   /**
+    * Makes [start, start + size) writeable w/o recording the writes, the dirty pages stay dirty.
+    *
+    * @return true if the pages were unprotected, false otherwise.
+    */
+   bool Unprotect(uword start, int64_t size);
+
+   /**
+    * Records the write to address as dirtying its page, called by the fault handler so it must not allocate or lock.
+    *
+    * @return The starting address of the dirty page, which the fault handler has to make writeable
+    */
+   uword RecordWrite(uword address){
+     auto index = GetPageIndexFor(address);
+     dirty_[index].store(1);
+     return GetPageAddress(index);
+   }
+
+   /**
+    * Visits the dirty pages of [start, end).
+    */
+   void VisitDirtyPages(uword start, uword end, const std::function<void(uword, uword)>& vis) const;
+
+   WriteWatch& operator=(const WriteWatch& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const WriteWatch& val){
+     stream << "WriteWatch(";
+     stream << "start=" << ((void*)val.GetStartingAddress()) << ", ";
+     stream << "pages=" << val.GetNumberOfPages() << ", ";
+     stream << "dirty=" << val.GetNumberOfDirtyPages() << ", ";
+     stream << "enabled=" << (val.IsEnabled() ? "y" : "n");
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_WRITE_WATCH_H
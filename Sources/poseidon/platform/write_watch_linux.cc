@@ -0,0 +1,59 @@
+#include "poseidon/platform/write_watch.h"
+#ifdef OS_IS_LINUX
+
+#include <mutex>
+#include <csignal>
+#include <sys/mman.h>
+
+namespace poseidon{
+ static struct sigaction previous_;
+
+ // the faults that don't belong to a watch are passed on to the handler that was installed before.
+ static inline void
+ ForwardSignal(int signal, siginfo_t* info, void* context){
+   if((previous_.sa_flags & SA_SIGINFO) != 0){
+     previous_.sa_sigaction(signal, info, context);
+     return;
+   }
+
+   if(previous_.sa_handler != SIG_DFL && previous_.sa_handler != SIG_IGN){
+     previous_.sa_handler(signal);
+     return;
+   }
+   // the faulting store is retried once the handler returns & crashes w/ the default action.
+   std::signal(signal, SIG_DFL);
+ }
+
+ static void
+ HandleWriteFault(int signal, siginfo_t* info, void* context){
+   auto address = (uword)info->si_addr;
+   auto watch = WriteWatch::FindWatchFor(address);
+   if(watch == nullptr){
+     ForwardSignal(signal, info, context);
+     return;
+   }
+
+   auto page = watch->RecordWrite(address);
+   if(mprotect((void*)page, WriteWatch::GetPageSize(), PROT_READ|PROT_WRITE) != 0)
+     ForwardSignal(signal, info, context);
+ }
+
+ bool WriteWatch::InstallFaultHandler(){
+   static std::once_flag installed;
+   static bool result = false;
+   std::call_once(installed, [](){
+     // the page size is cached before the handler can run, sysconf isn't async-signal-safe.
+     GetPageSize();
+
+     struct sigaction action;
+     memset(&action, 0, sizeof(action));
+     action.sa_sigaction = &HandleWriteFault;
+     action.sa_flags = SA_SIGINFO|SA_RESTART;
+     sigemptyset(&action.sa_mask);
+     result = sigaction(SIGSEGV, &action, &previous_) == 0;
+   });
+   return result;
+ }
+}
+
+#endif//OS_IS_LINUX
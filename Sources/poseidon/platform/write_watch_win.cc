@@ -0,0 +1,11 @@
+#include "poseidon/platform/write_watch.h"
+#ifdef OS_IS_WINDOWS
+
+namespace poseidon{
+ //TODO: use GetWriteWatch, the memory has to be reserved w/ MEM_WRITE_WATCH.
+ bool WriteWatch::InstallFaultHandler(){
+   return false;
+ }
+}
+
+#endif//OS_IS_WINDOWS
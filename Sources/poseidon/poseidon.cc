@@ -4,13 +4,37 @@
 
 namespace poseidon{
 DEFINE_int64(new_zone_size, kDefaultNewZoneSize, "The size of the new zone in bytes.");
+DEFINE_int64(max_tenuring_threshold, kDefaultMaxTenuringThreshold, "The max number of scavenges an object survives in the new zone before it gets promoted, at most 15.");
+DEFINE_int64(target_survivor_ratio, kDefaultTargetSurvivorRatio, "The percentage of a semispace the survivors of a scavenge should fill, the tenuring threshold is lowered when they fill more.");
+DEFINE_int64(tlab_size, kDefaultLocalAllocationBufferSize, "The size of the thread-local allocation buffers carved out of the new zone in bytes, 0 disables them.");
+DEFINE_int64(gclab_size, kDefaultCollectorLocalAllocationBufferSize, "The size of the buffers each scavenger worker copies & promotes objects into in bytes, 0 disables them.");
 
 DEFINE_int64(old_zone_size, kDefaultOldZoneSize, "The size of the old zone in bytes.");
+DEFINE_int64(old_zone_committed_size, kDefaultOldZoneCommittedSize, "The number of bytes of the old zone committed up front, the rest of the zone is reserved & committed on demand.");
 DEFINE_int64(old_page_size, kDefaultOldPageSize, "The size of the old zone pages in bytes.");
 
 DEFINE_int64(large_object_size, kDefaultLargeObjectSize, "The max size of an object before it gets classified as a large object.");
+DEFINE_int64(large_object_space_size, kDefaultLargeObjectSpaceSize, "The size of the address range reserved for the large objects in bytes.");
+
+DEFINE_string(huge_pages, kDefaultHugePages, "The pages backing the heap: none, transparent (madvise) or hugetlb (MAP_HUGETLB, falls back to transparent).");
+DEFINE_bool(pre_fault, kDefaultPreFault, "Pre-fault the new zone & the committed pages of the old zone, so the first collections don't pay for the page faults.");
+DEFINE_string(memory_release_mode, kDefaultMemoryReleaseMode, "How free heap memory is returned to the OS: dontneed, free (lazily, under memory pressure) or none.");
+DEFINE_int64(memory_release_delay, kDefaultMemoryReleaseDelay, "The number of consecutive collections free heap memory has to stay unused before it is returned to the OS.");
+
+DEFINE_bool(numa, kDefaultNuma, "Place the heap on the NUMA node of its mutator & bind the collection workers to the NUMA nodes.");
+DEFINE_string(numa_topology, kDefaultNumaTopology, "Fakes the NUMA topology, the cpus of each node separated by ';', ex: 0-3;4-7.");
 
 DEFINE_int64(num_workers, kDefaultNumberOfWorkers, "The number of workers to use for collections.");
+DEFINE_int64(mark_stack_size, kDefaultMarkStackSize, "The max size of the mark stacks of a parallel mark in bytes, objects past it are found again by rescanning their pages.");
+DEFINE_bool(concurrent_mark, kDefaultConcurrentMark, "Mark the old zone on the workers while the mutator runs, between a short initial mark pause & a remark pause.");
+DEFINE_int64(concurrent_mark_threshold, kDefaultConcurrentMarkThreshold, "The percentage of the committed old zone that has to be in use for a scavenge to start a concurrent or incremental mark.");
+DEFINE_bool(incremental_mark, kDefaultIncrementalMark, "Mark the old zone in steps taken by the allocation slow path, w/o the workers. Used when --concurrent_mark is off or there are no workers.");
+DEFINE_int64(mark_step_size, kDefaultMarkStepSize, "The number of bytes of objects an incremental mark step scans at most, 0 for no limit.");
+DEFINE_int64(mark_step_time, kDefaultMarkStepTime, "The number of microseconds an incremental mark step runs for at most, 0 for no limit.");
+DEFINE_int64(mmu_window, kDefaultMutatorUtilizationWindow, "The length of the windows the minimum mutator utilization is reported for in microseconds.");
+DEFINE_int64(store_buffer_size, kDefaultStoreBufferSize, "The number of old to new stores buffered per heap, stores past it dirty cards which get scanned in the scavenge pause.");
+DEFINE_int64(refinement_budget, kDefaultRefinementBudget, "The number of buffered stores that starts a concurrent refinement & the max it refines, 0 leaves all of them to the scavenge pause.");
+DEFINE_bool(page_protection, kDefaultPageProtection, "Record the stores into the old zone by write-protecting its pages after each collection instead of w/ the write barrier, every written page faults once per collection.");
 
 DEFINE_string(report_directory, kDefaultReportDirectory, "The directory used for reports.");
 
@@ -6,6 +6,7 @@
 
 #include "utils.h"
 #include "common.h"
+#include "type_descriptor.h"
 
 namespace poseidon{
  typedef const std::function<bool(RawObject*)>& RawObjectVisitorFunction;
@@ -40,42 +41,118 @@ namespace poseidon{
 
   static const constexpr RawObjectTag kInvalidObjectTag = 0;
 
+  /**
+   * The epoch of the marking, bumped at the start of every major collection.
+   *
+   * An object is marked only if it got marked during the current epoch, so bumping the epoch unmarks every object at
+   * once & the marks of the survivors never have to be cleared.
+   */
+  class MarkEpoch{
+   public:
+    // no marks belong to it, the epochs start at 1.
+    static constexpr const uword kNoEpoch = 0;
+    // the value of the MarkTag of an object that isn't marked.
+    static constexpr const uint8_t kUnmarkedTag = 0;
+    // the number of values the MarkTag of a marked object cycles through.
+    static constexpr const uint8_t kNumberOfTags = 3;
+   private:
+    static RelaxedAtomic<uword> epoch_;
+   public:
+    MarkEpoch() = delete;
+    MarkEpoch(const MarkEpoch& rhs) = delete;
+    ~MarkEpoch() = delete;
+
+    static inline uword
+    Get(){
+      return epoch_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Returns the MarkTag of the objects marked during the current epoch.
+     *
+     * The tag of a survivor is at most one epoch old when the next marking starts & a dead object is freed by the
+     * next sweep, so a handful of values is enough for a stale tag never to match the current one.
+     */
+    static inline uint8_t
+    GetTag(){
+      return static_cast<uint8_t>((Get() % kNumberOfTags) + 1);
+    }
+
+    /**
+     * Starts a new epoch, which unmarks every object. Called at the start of a marking.
+     *
+     * @return The new epoch
+     */
+    static inline uword
+    Flip(){
+      return epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    MarkEpoch& operator=(const MarkEpoch& rhs) = delete;
+  };
+
   class ObjectTag{
    private:
     enum Layout{
+      // ForwardingBit
+      kForwardingBitOffset = 0,
+      kBitsForForwardingBit = 1,
+
       // NewBit
-      kNewBitOffset = 0,
+      kNewBitOffset = kForwardingBitOffset+kBitsForForwardingBit,
       kBitsForNewBit = 1,
 
       // OldBit
       kOldBitOffset = kNewBitOffset+kBitsForNewBit,
       kBitsForOldBit = 1,
 
-      // MarkedBit
-      kMarkedBitOffset = kOldBitOffset+kBitsForNewBit,
-      kBitsForMarkedBit = 1,
+      // MarkTag
+      kMarkTagOffset = kOldBitOffset+kBitsForOldBit,
+      kBitsForMarkTag = 2,
 
       // RememberedBit
-      kRememberedBitOffset = kMarkedBitOffset+kBitsForMarkedBit,
+      kRememberedBitOffset = kMarkTagOffset+kBitsForMarkTag,
       kBitsForRememberedBit = 1,
 
+      // FreeBit
+      kFreeBitOffset = kRememberedBitOffset+kBitsForRememberedBit,
+      kBitsForFreeBit = 1,
+
       // Size
-      kSizeTagOffset = kRememberedBitOffset+kBitsForRememberedBit,
+      kSizeTagOffset = kFreeBitOffset+kBitsForFreeBit,
       kBitsForSizeTag = 32,
 
-      kTotalBits = kBitsForNewBit + kBitsForOldBit + kBitsForMarkedBit + kBitsForRememberedBit + kBitsForSizeTag,
+      // ClassId
+      kClassIdTagOffset = kSizeTagOffset+kBitsForSizeTag,
+      kBitsForClassIdTag = 12,
+
+      // Age
+      kAgeTagOffset = kClassIdTagOffset+kBitsForClassIdTag,
+      kBitsForAgeTag = 4,
+
+      kTotalBits = kBitsForForwardingBit + kBitsForNewBit + kBitsForOldBit + kBitsForMarkTag + kBitsForRememberedBit + kBitsForFreeBit + kBitsForSizeTag + kBitsForClassIdTag + kBitsForAgeTag,
     };
    public:
+    static constexpr const int64_t kMaxAge = (1 << kBitsForAgeTag) - 1;
+
+    // set when the header holds a forwarding address instead of a tag, addresses are word aligned so the bit is free.
+    class ForwardingBit : public BitField<RawObjectTag, bool, kForwardingBitOffset, kBitsForForwardingBit>{};
     // The object's size.
     class SizeTag : public BitField<RawObjectTag, int64_t, kSizeTagOffset, kBitsForSizeTag>{};
     // allocated in the new heap.
     class NewBit : public BitField<RawObjectTag, bool, kNewBitOffset, kBitsForNewBit>{};
     // allocated in the old heap.
     class OldBit : public BitField<RawObjectTag, bool, kOldBitOffset, kBitsForOldBit>{};
-    // marked by the scavenger
-    class MarkedBit : public BitField<RawObjectTag, bool, kMarkedBitOffset, kBitsForMarkedBit>{};
+    // the tag of the MarkEpoch the object was last marked in, kUnmarkedTag if it was never marked.
+    class MarkTag : public BitField<RawObjectTag, uint8_t, kMarkTagOffset, kBitsForMarkTag>{};
     // remembered by the scavenger
     class RememberedBit : public BitField<RawObjectTag, bool, kRememberedBitOffset, kBitsForRememberedBit>{};
+
+    class FreeBit : public BitField<RawObjectTag, bool, kFreeBitOffset, kBitsForFreeBit>{};
+    // The object's TypeDescriptor, kInvalidClassId for objects w/o references.
+    class ClassIdTag : public BitField<RawObjectTag, ClassId, kClassIdTagOffset, kBitsForClassIdTag>{};
+    // The number of scavenges the object survived in the new zone, saturates at kMaxAge.
+    class AgeTag : public BitField<RawObjectTag, uint8_t, kAgeTagOffset, kBitsForAgeTag>{};
    private:
     RawObjectTag raw_;
 
@@ -116,15 +193,15 @@ namespace poseidon{
     }
 
     void SetMarked(){
-      raw_ = MarkedBit::Update(true, raw());
+      raw_ = MarkTag::Update(MarkEpoch::GetTag(), raw());
     }
 
     void ClearMarked(){
-      raw_ = MarkedBit::Update(false, raw());
+      raw_ = MarkTag::Update(MarkEpoch::kUnmarkedTag, raw());
     }
 
     bool IsMarked() const{
-      return MarkedBit::Decode(raw());
+      return MarkTag::Decode(raw()) == MarkEpoch::GetTag();
     }
 
     void SetRemembered(){
@@ -139,6 +216,18 @@ namespace poseidon{
       return RememberedBit::Decode(raw());
     }
 
+    void SetFree(){
+      raw_ = FreeBit::Update(true, raw());
+    }
+
+    void ClearFree(){
+      raw_ = FreeBit::Update(false, raw());
+    }
+
+    bool IsFree() const{
+      return FreeBit::Decode(raw());
+    }
+
     void SetSize(int64_t size){
       raw_ = SizeTag::Update(size, raw());
     }
@@ -147,6 +236,22 @@ namespace poseidon{
       return SizeTag::Decode(raw());
     }
 
+    void SetClassId(ClassId id){
+      raw_ = ClassIdTag::Update(id, raw());
+    }
+
+    ClassId GetClassId() const{
+      return ClassIdTag::Decode(raw());
+    }
+
+    void SetAge(uint8_t age){
+      raw_ = AgeTag::Update(age, raw());
+    }
+
+    uint8_t GetAge() const{
+      return AgeTag::Decode(raw());
+    }
+
     explicit operator RawObjectTag() const{
       return raw();
     }
@@ -164,7 +269,10 @@ namespace poseidon{
       stream << "old=" << val.IsOld() << ", ";
       stream << "marked=" << val.IsMarked() << ", ";
       stream << "remembered=" << val.IsRemembered() << ", ";
-      stream << "size=" << val.GetSize();
+      stream << "free=" << val.IsFree() << ", ";
+      stream << "size=" << val.GetSize() << ", ";
+      stream << "class_id=" << val.GetClassId() << ", ";
+      stream << "age=" << static_cast<int>(val.GetAge());
       stream << ")";
       return stream;
     }
@@ -173,7 +281,7 @@ namespace poseidon{
     New(){
       auto raw = NewBit::Encode(true)
            | OldBit::Encode(false)
-           | MarkedBit::Encode(false)
+           | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
            | RememberedBit::Encode(false)
            | SizeTag::Encode(0);
       return ObjectTag(raw);
@@ -183,7 +291,7 @@ namespace poseidon{
     NewWithSize(int64_t size){
       auto raw = NewBit::Encode(true)
                | OldBit::Encode(false)
-               | MarkedBit::Encode(false)
+               | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
                | RememberedBit::Encode(false)
                | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -193,7 +301,7 @@ namespace poseidon{
     NewMarkedWithSize(int64_t size){
       auto raw = NewBit::Encode(true)
           | OldBit::Encode(false)
-          | MarkedBit::Encode(true)
+          | MarkTag::Encode(MarkEpoch::GetTag())
           | RememberedBit::Encode(false)
           | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -203,7 +311,7 @@ namespace poseidon{
     NewRememberedWithSize(int64_t size){
       auto raw = NewBit::Encode(true)
           | OldBit::Encode(false)
-          | MarkedBit::Encode(false)
+          | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
           | RememberedBit::Encode(true)
           | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -213,7 +321,7 @@ namespace poseidon{
     Old(){
       auto raw = NewBit::Encode(false)
           | OldBit::Encode(true)
-          | MarkedBit::Encode(false)
+          | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
           | RememberedBit::Encode(false)
           | SizeTag::Encode(0);
       return ObjectTag(raw);
@@ -223,7 +331,7 @@ namespace poseidon{
     OldWithSize(int64_t size){
       auto raw = NewBit::Encode(false)
           | OldBit::Encode(true)
-          | MarkedBit::Encode(false)
+          | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
           | RememberedBit::Encode(false)
           | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -233,7 +341,7 @@ namespace poseidon{
     OldMarkedWithSize(int64_t size){
       auto raw = NewBit::Encode(false)
           | OldBit::Encode(true)
-          | MarkedBit::Encode(true)
+          | MarkTag::Encode(MarkEpoch::GetTag())
           | RememberedBit::Encode(false)
           | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -243,7 +351,7 @@ namespace poseidon{
     OldRememberedWithSize(int64_t size){
       auto raw = NewBit::Encode(false)
           | OldBit::Encode(true)
-          | MarkedBit::Encode(false)
+          | MarkTag::Encode(MarkEpoch::kUnmarkedTag)
           | RememberedBit::Encode(true)
           | SizeTag::Encode(size);
       return ObjectTag(raw);
@@ -256,22 +364,24 @@ namespace poseidon{
     friend class Semispace;
     friend class Zone;
     friend class NewZone;
+    friend class LocalAllocationBuffer;
+    friend class PromotionLocalAllocationBuffer;
     friend class OldPage;
     friend class Compactor;
+    friend class FreeList;
+    friend class LargeObjectSpace;
    private:
-    RelaxedAtomic<RawObjectTag> tag_; // TODO: merge w/ forwarding
-    RelaxedAtomic<uword> forwarding_;
+    // a single word, either the ObjectTag of this object or the address it was forwarded to w/ the ForwardingBit set.
+    RelaxedAtomic<uword> header_;
 
     explicit RawObject(ObjectTag tag):
-      tag_((RawObjectTag)tag),
-      forwarding_(0){
+      header_((RawObjectTag)tag){
     }
    public:
     RawObject()://TODO: make private
-      tag_(0),
-      forwarding_(0){
+      header_(kInvalidObjectTag){
     }
-    virtual ~RawObject() = default;
+    ~RawObject() = default;
 
     uword GetAddress() const{
       return (uword)this;
@@ -285,12 +395,52 @@ namespace poseidon{
       return reinterpret_cast<uword>(this) + sizeof(RawObject);
     }
 
+    /**
+     * Overwrites the tag of this object w/ address, the tag of a forwarded object reads as {@link kInvalidObjectTag}.
+     */
     void SetForwardingAddress(uword address){
-      forwarding_ = address;
+      PSDN_ASSERT(IsAligned(address, kWordSize));
+      header_ = address | ObjectTag::ForwardingBit::Encode(true);
+    }
+
+    /**
+     * Forwards this object to address, unless its header changed since it was read as header.
+     *
+     * The copy at address is published w/ the forwarding address, the threads that lose see the winning copy.
+     *
+     * @return false if another thread forwarded this object first
+     */
+    bool TryForwardTo(uword header, uword address){
+      PSDN_ASSERT(IsAligned(address, kWordSize));
+      return header_.compare_exchange_strong(header, address | ObjectTag::ForwardingBit::Encode(true), std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    /**
+     * Stores value into the header field F w/ a CAS loop so that concurrent updates to the other fields
+     * aren't lost, a forwarded header is left untouched.
+     */
+    template<class F, typename T>
+    void UpdateTag(T value){
+      auto header = header_.load(std::memory_order_relaxed);
+      do{
+        if(ObjectTag::ForwardingBit::Decode(header))
+          return;
+      } while(!header_.compare_exchange_weak(header, F::Update(value, header)));
+    }
+
+    /**
+     * Returns the header of this object, the tag or the forwarding address. Reading it acquires the copy of an
+     * object forwarded by another thread.
+     */
+    uword GetHeader() const{
+      return header_.load(std::memory_order_acquire);
     }
 
     uword GetForwardingAddress() const{
-      return (uword)forwarding_;
+      auto header = (uword)header_;
+      return ObjectTag::ForwardingBit::Decode(header)
+           ? ObjectTag::ForwardingBit::Update(false, header)
+           : 0;
     }
 
     void* GetForwardingPointer() const{
@@ -298,11 +448,12 @@ namespace poseidon{
     }
 
     bool IsForwarding() const{
-      return forwarding_ != 0;
+      return ObjectTag::ForwardingBit::Decode((uword)header_);
     }
 
     RawObjectTag raw_tag() const{
-      return (RawObjectTag)tag_;
+      auto header = (uword)header_;
+      return ObjectTag::ForwardingBit::Decode(header) ? kInvalidObjectTag : header;
     }
 
     ObjectTag tag() const{
@@ -310,7 +461,7 @@ namespace poseidon{
     }
 
     void set_tag(const ObjectTag& val){
-      tag_ = (RawObjectTag)val;
+      header_ = (RawObjectTag)val;
     }
 
     bool IsNew() const{
@@ -318,11 +469,11 @@ namespace poseidon{
     }
 
     void SetNewBit(){
-      tag_ = ObjectTag::NewBit::Update(true, raw_tag());
+      UpdateTag<ObjectTag::NewBit>(true);
     }
 
     void ClearNewBit(){
-      tag_ = ObjectTag::NewBit::Update(false, raw_tag());
+      UpdateTag<ObjectTag::NewBit>(false);
     }
 
     bool IsOld() const{
@@ -330,23 +481,38 @@ namespace poseidon{
     }
 
     void SetOldBit(){
-      tag_ = ObjectTag::OldBit::Update(true, raw_tag());
+      UpdateTag<ObjectTag::OldBit>(true);
     }
 
     void ClearOldBit(){
-      tag_ = ObjectTag::OldBit::Update(false, raw_tag());
+      UpdateTag<ObjectTag::OldBit>(false);
     }
 
     bool IsMarked() const{
-      return ObjectTag::MarkedBit::Decode(raw_tag());
+      return ObjectTag::MarkTag::Decode(raw_tag()) == MarkEpoch::GetTag();
     }
 
     void SetMarkedBit(){
-      tag_ = ObjectTag::MarkedBit::Update(true, raw_tag());
+      UpdateTag<ObjectTag::MarkTag>(MarkEpoch::GetTag());
+    }
+
+    /**
+     * Marks this object in the current {@link MarkEpoch}, several markers can race to mark it.
+     *
+     * @return true if this call marked the object, false if it was already marked
+     */
+    bool TrySetMarkedBit(){
+      auto tag = MarkEpoch::GetTag();
+      auto header = header_.load(std::memory_order_relaxed);
+      do{
+        if(ObjectTag::MarkTag::Decode(header) == tag)
+          return false;
+      } while(!header_.compare_exchange_weak(header, ObjectTag::MarkTag::Update(tag, header)));
+      return true;
     }
 
     void ClearMarkedBit(){
-      tag_ = ObjectTag::MarkedBit::Update(false, raw_tag());
+      UpdateTag<ObjectTag::MarkTag>(MarkEpoch::kUnmarkedTag);
     }
 
     bool IsRemembered() const{
@@ -354,15 +520,27 @@ namespace poseidon{
     }
 
     void SetRememberedBit(){
-      tag_ = ObjectTag::RememberedBit::Update(true, raw_tag());
+      UpdateTag<ObjectTag::RememberedBit>(true);
     }
 
     void ClearRememberedBit(){
-      tag_ = ObjectTag::RememberedBit::Update(false, raw_tag());
+      UpdateTag<ObjectTag::RememberedBit>(false);
+    }
+
+    bool IsFree() const{
+      return ObjectTag::FreeBit::Decode(raw_tag());
+    }
+
+    void SetFreeBit(){
+      UpdateTag<ObjectTag::FreeBit>(true);
+    }
+
+    void ClearFreeBit(){
+      UpdateTag<ObjectTag::FreeBit>(false);
     }
 
     void ClearTag(){
-      tag_ = kInvalidObjectTag;
+      header_ = kInvalidObjectTag;
     }
 
     uint32_t GetPointerSize() const{
@@ -370,13 +548,40 @@ namespace poseidon{
     }
 
     void SetPointerSize(const uint32_t& val){
-      tag_ = ObjectTag::SizeTag::Update(val, raw_tag());
+      UpdateTag<ObjectTag::SizeTag>(val);
     }
 
     int64_t GetTotalSize() const{
       return static_cast<int64_t>(sizeof(RawObject) + GetPointerSize());
     }
 
+    ClassId GetClassId() const{
+      return ObjectTag::ClassIdTag::Decode(raw_tag());
+    }
+
+    void SetClassId(ClassId id){
+      UpdateTag<ObjectTag::ClassIdTag>(id);
+    }
+
+    uint8_t GetAge() const{
+      return ObjectTag::AgeTag::Decode(raw_tag());
+    }
+
+    void SetAge(uint8_t age){
+      UpdateTag<ObjectTag::AgeTag>(age);
+    }
+
+    const TypeDescriptor* GetTypeDescriptor() const{
+      return TypeDescriptor::Get(GetClassId());
+    }
+
+    /**
+     * Visits the non-null reference fields of this object, objects w/o a {@link TypeDescriptor} have none.
+     *
+     * @return The number of fields visited
+     */
+    int64_t VisitPointers(const std::function<bool(uword*)>& vis) const;
+
     std::string ToString() const{
       std::stringstream ss;
       ss << "RawObject(";
@@ -384,7 +589,10 @@ namespace poseidon{
       ss << "old=" << IsOld() << ", ";
       ss << "marked=" << IsMarked() << ", ";
       ss << "remembered=" << IsRemembered() << ", ";
+      ss << "free=" << IsFree() << ", ";
       ss << "size=" << Bytes(GetPointerSize()) << ", ";
+      ss << "class_id=" << GetClassId() << ", ";
+      ss << "age=" << static_cast<int>(GetAge()) << ", ";
       ss << "address=" << this << ", ";
       ss << "pointer=" << GetPointer() << ", ";
       ss << "forwarding=" << GetForwardingPointer();
@@ -392,6 +600,14 @@ namespace poseidon{
       return ss.str();
     }
    public:
+    /**
+     * Returns the object whose payload starts at pointer, the inverse of {@link GetObjectPointerAddress()}.
+     */
+    static inline RawObject*
+    FromPointer(uword pointer){
+      return (RawObject*)(pointer - sizeof(RawObject));
+    }
+
     template<class T>
     static inline uword
     TryAllocateIn(T* area, int64_t size){
@@ -432,6 +648,8 @@ namespace poseidon{
       return ptr->GetAddress();
     }
   };
+
+  static_assert(sizeof(RawObject) == kWordSize, "the RawObject header must be a single word.");
 }
 
 #endif //POSEIDON_RAW_OBJECT_H
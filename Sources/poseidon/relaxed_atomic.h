@@ -44,6 +44,10 @@ namespace poseidon{
      return val_.compare_exchange_strong(expected, desired, order, order);
    }
 
+   bool compare_exchange_strong(T& expected, T desired, std::memory_order success, std::memory_order failure){
+     return val_.compare_exchange_strong(expected, desired, success, failure);
+   }
+
    explicit operator T() const{
      return load();
    }
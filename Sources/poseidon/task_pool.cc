@@ -1,31 +1,122 @@
+#include <thread>
 #include <glog/logging.h>
 
 #include "poseidon/common.h"
 #include "poseidon/task_pool.h"
 
 namespace poseidon{
+ thread_local TaskPool::Worker* TaskPool::Worker::current_ = nullptr;
+
+ TaskPool::Worker* TaskPool::Worker::GetCurrentWorker(){
+   return current_;
+ }
+
+ Task* TaskPool::Worker::StealFrom(Worker* victim){
+   auto first = victim->queue_.Steal();
+   if(first == nullptr)
+     return nullptr;
+
+   // stealing half of the tasks at once keeps the workers from coming back to the same victim for every task.
+   auto batch = std::min(victim->queue_.size() / 2, kMaxBatchSize);
+   for(int64_t idx = 0; idx < batch; idx++){
+     auto next = victim->queue_.Steal();
+     if(next == nullptr)
+       break;
+     queue_.Push(next);
+   }
+   return first;
+ }
+
+ Task* TaskPool::Worker::TakeInjected(){
+   auto injected = pool()->injected();
+   if(injected->empty())
+     return nullptr;
+
+   // a worker takes its share of the injected tasks, the others steal the rest from it.
+   Task* tasks[kMaxBatchSize];
+   auto batch = std::max(std::min(injected->size() / static_cast<int64_t>(pool()->size()), kMaxBatchSize), static_cast<int64_t>(1));
+   auto taken = injected->Pop(tasks, batch);
+   if(taken == 0)
+     return nullptr;
+   for(auto idx = taken - 1; idx > 0; idx--)
+     queue_.Push(tasks[idx]);
+   return tasks[0];
+ }
+
+ Task* TaskPool::Worker::StealFromRandomVictim(){
+   auto num_workers = static_cast<int64_t>(pool()->size());
+   if(num_workers <= 1)
+     return nullptr;
+
+   std::uniform_int_distribution<int64_t> distribution(0, num_workers - 1);
+   auto first = distribution(engine_);
+   for(int64_t idx = 0; idx < num_workers; idx++){
+     auto victim = pool()->workers(static_cast<WorkerId>((first + idx) % num_workers));
+     if(victim == this || victim->queue_.empty())
+       continue;
+
+     Task* next;
+     if((next = StealFrom(victim)) != nullptr)
+       return next;
+   }
+   return nullptr;
+ }
+
+ Task* TaskPool::Worker::GetNext(){
+   Task* next;
+   if((next = queue_.Pop()) != nullptr)
+     return next;
+   if((next = TakeInjected()) != nullptr)
+     return next;
+   return StealFromRandomVictim();
+ }
+
+ bool TaskPool::Worker::Shutdown(){
+   if(IsStopped())
+     return true;
+   SetState(State::kStopping);
+   // a parked worker has to wake up to see it's stopping.
+   pool()->UnparkAll();
+   return Join(thread_);
+ }
+
  void TaskPool::Worker::HandleThread(uword parameter){
    auto worker = (TaskPool::Worker*)parameter;
    DLOG(INFO) << "starting worker #" << worker->worker_id() << "....";
-   worker->SetState(State::kStarting);
-   // do something?
-   worker->SetState(State::kIdle);
+   current_ = worker;
+   if(worker->node() != kAnyNumaNode && !BindCurrentThreadToNumaNode(worker->node()))
+     DLOG(WARNING) << "cannot bind worker #" << worker->worker_id() << " to NUMA node " << worker->node() << ".";
+   // the worker can be shut down before it got to run.
+   auto starting = State::kStarting;
+   worker->state_.compare_exchange_strong(starting, State::kIdle);
+   int64_t spins = 0;
    do{
-     do{
-       auto next = worker->queue_->Steal();
-       if(!next)
+     // read before the queues are checked, a task submitted after the check changes it & the worker doesn't park.
+     auto submitted = worker->pool()->GetNumberOfSubmissions();
+     Task* next;
+     if((next = worker->GetNext()) == nullptr){
+       if(++spins < kIdleSpinIterations){
+         std::this_thread::yield();
          continue;
+       }
+       spins = 0;
+       worker->pool()->Park(worker, submitted);
+       continue;
+     }
 
-       DTIMED_SECTION(next->name(), {
-         if(!next->Execute()){
-           DLOG(ERROR) << "failed to execute " << next->name() << ".";
-           continue;
-         }
-       });
-     } while(worker->HasWork());
+     spins = 0;
+     auto idle = State::kIdle;
+     worker->state_.compare_exchange_strong(idle, State::kExecuting);
+     DTIMED_SECTION(next->name(), {
+       if(!next->Execute())
+         DLOG(ERROR) << "failed to execute " << next->name() << ".";
+     });
+     auto executing = State::kExecuting;
+     worker->state_.compare_exchange_strong(executing, State::kIdle);
    } while(worker->IsRunning());
    DLOG(INFO) << "worker #" << worker->worker_id() << " is stopping....";
+   current_ = nullptr;
    worker->SetState(State::kStopped);
    pthread_exit((void*)"Hello World");//TODO: exit properly
  }
-}
\ No newline at end of file
+}
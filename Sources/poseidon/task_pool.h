@@ -5,13 +5,18 @@
 #include <cassert>
 #endif//PSDN_DEBUG
 
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <random>
 #include <ostream>
 #include <glog/logging.h>
 
 #include "poseidon/wsq.h"
+#include "poseidon/flags.h"
 #include "poseidon/common.h"
 #include "poseidon/relaxed_atomic.h"
+#include "poseidon/platform/numa.h"
 #include "poseidon/platform/os_thread.h"
 
 namespace poseidon{
@@ -121,6 +126,10 @@ namespace poseidon{
 
    static constexpr const QueueSize kDefaultMaxQueueSize = 1024;
    static constexpr const size_t kDefaultNumberOfWorkers = 2;
+   // the max number of tasks a worker moves into its queue at once, from another worker or the injection queue.
+   static constexpr const int64_t kMaxBatchSize = 32;
+   // the number of times an idle worker looks for tasks before it parks.
+   static constexpr const int64_t kIdleSpinIterations = 128;
   private:
 #define FOR_EACH_TASK_POOL_WORKER_STATE(V) \
    V(Starting)                             \
@@ -129,6 +138,59 @@ namespace poseidon{
    V(Stopping)                             \
    V(Stopped)
 
+   /**
+    * The tasks submitted by threads outside of the pool, which can't push to the queue of a worker.
+    */
+   class InjectionQueue{
+    private:
+     std::mutex mutex_;
+     std::deque<Task*> tasks_;
+     RelaxedAtomic<int64_t> size_;
+    public:
+     InjectionQueue():
+      mutex_(),
+      tasks_(),
+      size_(0){
+     }
+     InjectionQueue(const InjectionQueue& rhs) = delete;
+     ~InjectionQueue() = default;
+
+     bool empty() const{
+       return size() == 0;
+     }
+
+     int64_t size() const{
+       return (int64_t)size_;
+     }
+
+     void Push(Task* task){
+       std::lock_guard<std::mutex> guard(mutex_);
+       tasks_.push_back(task);
+       size_ += 1;
+     }
+
+     /**
+      * Takes up to max tasks from the front of the queue.
+      *
+      * @return The number of tasks taken
+      */
+     int64_t Pop(Task** tasks, int64_t max){
+       if(empty())
+         return 0;
+       std::lock_guard<std::mutex> guard(mutex_);
+       int64_t taken = 0;
+       while(taken < max && !tasks_.empty()){
+         tasks[taken++] = tasks_.front();
+         tasks_.pop_front();
+       }
+       size_ -= taken;
+       return taken;
+     }
+
+     InjectionQueue& operator=(const InjectionQueue& rhs) = delete;
+   };
+
+   class WorkerPool;
    class Worker{
     public:
      enum State : intptr_t{
@@ -146,31 +208,53 @@ namespace poseidon{
          default: return stream << "Unknown";
        }
      }
+
+     /**
+      * Returns the worker running on the calling thread, or nullptr if it isn't a worker.
+      */
+     static Worker* GetCurrentWorker();
     private:
+     static thread_local Worker* current_;
+
+     WorkerPool* pool_;
      ThreadId thread_;
      WorkerId worker_;
+     NumaNode node_;
      RelaxedAtomic<State> state_;
-     TaskQueue* queue_;
+     // only this worker pushes & pops, the other workers steal.
+     TaskQueue queue_;
+     std::default_random_engine engine_;
 
      inline void SetState(const State& state){
        state_ = state;
      }
 
-     inline bool HasWork() const{
-       return !queue_->empty();
-     }
+     // moves up to half of the tasks of victim into the queue of this worker, the first one is returned.
+     Task* StealFrom(Worker* victim);
+     // moves a batch of the injected tasks into the queue of this worker, the first one is returned.
+     Task* TakeInjected();
+     Task* StealFromRandomVictim();
+     // the own tasks come first, then the injected ones, then the ones of the other workers.
+     Task* GetNext();
 
      static void HandleThread(uword parameter);
     public:
-     Worker(WorkerId worker, TaskQueue* queue):
+     Worker(WorkerPool* pool, WorkerId worker, NumaNode node, int64_t queue_size = kDefaultMaxQueueSize):
+       pool_(pool),
        thread_(),
        worker_(worker),
+       node_(node),
        state_(State::kStopped),
-       queue_(queue){
+       queue_(queue_size),
+       engine_(static_cast<std::default_random_engine::result_type>(Clock::now().time_since_epoch().count() + worker)){
      }
      Worker(const Worker& rhs) = delete;
      ~Worker() = default;
 
+     WorkerPool* pool() const{
+       return pool_;
+     }
+
      ThreadId thread_id() const{
        return thread_;
      }
@@ -179,10 +263,21 @@ namespace poseidon{
        return worker_;
      }
 
+     /**
+      * Returns the NUMA node this worker binds itself to, or {@link kAnyNumaNode} if it isn't bound.
+      */
+     NumaNode node() const{
+       return node_;
+     }
+
      State state() const{
        return (State)state_;
      }
 
+     int64_t GetNumberOfQueuedTasks() const{
+       return queue_.size();
+     }
+
 #define DEFINE_STATE_CHECK(Name) \
      bool Is##Name() const{ return state() == State::k##Name; }
      FOR_EACH_TASK_POOL_WORKER_STATE(DEFINE_STATE_CHECK)
@@ -192,52 +287,71 @@ namespace poseidon{
        return IsIdle() || IsExecuting();
      }
 
+     /**
+      * Pushes task to the queue of this worker, only called on the thread of this worker.
+      */
+     void Submit(Task* task){
+       queue_.Push(task);
+     }
+
      bool Start(){
        if(!IsStopped())
          return false;
+       SetState(State::kStarting);
        char thread_name[kThreadNameMaxLength];
        snprintf(thread_name, kThreadNameMaxLength, "worker-%d", (int)worker_id());
        return ::poseidon::Start(&thread_, thread_name, &HandleThread, (uword)this);
      }
 
-     bool Shutdown(){
-       SetState(State::kStopping);
-       return Join(thread_);
-     }
+     bool Shutdown();
 
      Worker& operator=(const Worker& rhs) = delete;
    };
 
    class WorkerPool{
     private:
-     TaskQueue queue_;
+     InjectionQueue injected_;
 
      Worker** workers_;
      size_t num_workers_;
 
-     std::default_random_engine engine_;
-     std::uniform_int_distribution<WorkerId> distribution_;
-
-     inline WorkerId
-     GetRandomWorkerIndex(){
-       return distribution_(engine_);
+     // the idle workers wait for the number of submissions to change.
+     std::mutex parking_mutex_;
+     std::condition_variable parking_;
+     std::atomic<int64_t> parked_;
+     std::atomic<uint64_t> submitted_;
+
+     // wakes a parked worker, if there is one.
+     void Unpark(){
+       if(parked_.load(std::memory_order_seq_cst) == 0)
+         return;
+       std::lock_guard<std::mutex> guard(parking_mutex_);
+       parking_.notify_one();
      }
     public:
      explicit WorkerPool(size_t num_workers, int64_t queue_size = kDefaultMaxQueueSize):
-      queue_(queue_size),
+      injected_(),
       workers_(new Worker*[num_workers]),
       num_workers_(num_workers),
-      engine_(Clock::now().time_since_epoch().count()),
-      distribution_(0, static_cast<WorkerId>(num_workers - 1)){
+      parking_mutex_(),
+      parking_(),
+      parked_(0),
+      submitted_(0){
+       // the workers are spread evenly across the NUMA nodes.
+       auto num_nodes = IsNumaEnabled() ? GetNumberOfNumaNodes() : 0;
        for(WorkerId widx = 0; widx < static_cast<WorkerId>(num_workers); widx++){
-         workers_[widx] = new Worker(widx, &queue_);
+         auto node = num_nodes > 0 ? static_cast<NumaNode>(widx % num_nodes) : kAnyNumaNode;
+         workers_[widx] = new Worker(this, widx, node, queue_size);
        }
      }
      ~WorkerPool(){
        DVLOG(1) << "shutting down " << num_workers_ << " workers in pool....";
        for(auto& worker : *this){
-         if(!worker->Shutdown())
+         if(!worker->Shutdown()){
            LOG(ERROR) << "cannot shutdown worker #" << worker->worker_id() << ".";
+           continue;
+         }
+         delete worker;
        }
        delete[] workers_;
      }
@@ -251,16 +365,44 @@ namespace poseidon{
      }
 
      Worker* workers(WorkerId id) const{
-       if(id < 0 || id > size()){
+       if(id < 0 || static_cast<size_t>(id) >= size()){
          DLOG(WARNING) << "cannot get worker #" << id;
          return nullptr;
        }
-       DLOG(INFO) << "getting worker #" << id;
        return workers_[id];
      }
 
-     Worker* random(){
-       return workers(GetRandomWorkerIndex());
+     InjectionQueue* injected(){
+       return &injected_;
+     }
+
+     int64_t GetNumberOfParkedWorkers() const{
+       return parked_.load(std::memory_order_seq_cst);
+     }
+
+     /**
+      * Returns the number of tasks submitted so far, an idle worker reads it before it looks for tasks the last time
+      * & parks until it changes.
+      */
+     uint64_t GetNumberOfSubmissions() const{
+       return submitted_.load(std::memory_order_seq_cst);
+     }
+
+     /**
+      * Blocks the calling worker until a task was submitted after submitted was read, or the worker is shut down.
+      */
+     void Park(Worker* worker, uint64_t submitted){
+       std::unique_lock<std::mutex> lock(parking_mutex_);
+       parked_.fetch_add(1, std::memory_order_seq_cst);
+       parking_.wait(lock, [&](){
+         return GetNumberOfSubmissions() != submitted || !worker->IsRunning();
+       });
+       parked_.fetch_sub(1, std::memory_order_seq_cst);
+     }
+
+     void UnparkAll(){
+       std::lock_guard<std::mutex> guard(parking_mutex_);
+       parking_.notify_all();
      }
 
      Worker** begin() const{
@@ -271,9 +413,20 @@ namespace poseidon{
        return &workers_[num_workers_];
      }
 
+     /**
+      * Submits task to the queue of the calling worker, or to the injection queue if it's called from another thread.
+      */
      void Submit(Task* task){
        GCLOG(3) << "submitting " << task->name() << "....";
-       queue_.Push(task);
+       auto worker = Worker::GetCurrentWorker();
+       if(worker != nullptr && worker->pool() == this){
+         worker->Submit(task);
+       } else{
+         injected_.Push(task);
+       }
+       // the task is visible before the count changes, so a worker that sees the new count finds it.
+       submitted_.fetch_add(1, std::memory_order_seq_cst);
+       Unpark();
      }
 
      void StartAll() const{
@@ -300,6 +453,14 @@ namespace poseidon{
    }
    ~TaskPool() = default;
 
+   int64_t GetNumberOfWorkers() const{
+     return static_cast<int64_t>(wpool_.size());
+   }
+
+   int64_t GetNumberOfParkedWorkers() const{
+     return wpool_.GetNumberOfParkedWorkers();
+   }
+
    void Submit(Task* task){
      wpool_.Submit(task);
    }
@@ -320,4 +481,4 @@ namespace poseidon{
  };
 }
 
-#endif //POSEIDON_TASK_POOL_H
\ No newline at end of file
+#endif //POSEIDON_TASK_POOL_H
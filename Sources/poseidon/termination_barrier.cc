@@ -0,0 +1,54 @@
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "poseidon/termination_barrier.h"
+
+namespace poseidon{
+ void TerminationBarrier::Backoff(int64_t iteration){
+   if(iteration < kSpinIterations){
+     spins_ += 1;
+#if defined(__x86_64__) || defined(__i386__)
+     __builtin_ia32_pause();
+#endif
+     return;
+   }
+
+   if(iteration < (kSpinIterations + kYieldIterations)){
+     yields_ += 1;
+     std::this_thread::yield();
+     return;
+   }
+
+   sleeps_ += 1;
+   auto shift = std::min(iteration - (kSpinIterations + kYieldIterations), static_cast<int64_t>(10));
+   auto micros = std::min(static_cast<int64_t>(1) << shift, kMaxSleepMicros);
+   std::this_thread::sleep_for(std::chrono::microseconds(micros));
+ }
+
+ bool TerminationBarrier::TryRetract(){
+   auto offered = GetNumberOfOffers();
+   while(offered < GetNumberOfThreads()){
+     if(offered_.compare_exchange_strong(offered, offered - 1, std::memory_order_acq_rel, std::memory_order_acquire))
+       return true;
+   }
+   return false;
+ }
+
+ bool TerminationBarrier::OfferTermination(const std::function<bool()>& has_work){
+   // the offers release the work of each thread to the threads that observe the termination.
+   offered_.fetch_add(1, std::memory_order_acq_rel);
+   for(int64_t iteration = 0; !IsTerminated(); iteration++){
+     // the work pushed by a thread that hasn't offered yet.
+     if(has_work() && TryRetract())
+       return false;
+     Backoff(iteration);
+   }
+   return true;
+ }
+
+ void TerminationBarrier::WaitForExit(){
+   for(int64_t iteration = 0; !HasExited(); iteration++)
+     Backoff(iteration);
+ }
+}
@@ -0,0 +1,133 @@
+#ifndef POSEIDON_TERMINATION_BARRIER_H
+#define POSEIDON_TERMINATION_BARRIER_H
+
+#include <ostream>
+#include <functional>
+
+#include "poseidon/utils.h"
+#include "poseidon/common.h"
+#include "poseidon/relaxed_atomic.h"
+
+namespace poseidon{
+ /**
+  * Decides when a fixed number of threads sharing a work queue are done, the threads push new work only while they
+  * are working.
+  *
+  * A thread that runs out of work offers to terminate & waits for the others, backing off from spinning to yielding
+  * to sleeping. If work shows up in the meantime it retracts its offer & goes back to work. Once every thread has
+  * offered nobody can push anymore, so they all terminate.
+  *
+  * A thread that terminated may still be backing off inside the barrier, so each thread exits the barrier once it's
+  * done w/ it & the shared work. The owner waits for every thread to exit before it frees them.
+  */
+ class TerminationBarrier{
+   friend class TerminationBarrierTest;
+  public:
+   static constexpr const int64_t kSpinIterations = 64;
+   static constexpr const int64_t kYieldIterations = 16;
+   static constexpr const int64_t kMaxSleepMicros = 1024;
+  private:
+   int64_t num_threads_;
+   RelaxedAtomic<int64_t> offered_;
+   RelaxedAtomic<int64_t> exited_;
+
+   // the number of times a thread backed off, for the stats.
+   RelaxedAtomic<int64_t> spins_;
+   RelaxedAtomic<int64_t> yields_;
+   RelaxedAtomic<int64_t> sleeps_;
+
+   // waits a little longer w/ each iteration.
+   void Backoff(int64_t iteration);
+   // withdraws the offer of the calling thread, unless every thread has offered in the meantime.
+   bool TryRetract();
+  public:
+   explicit TerminationBarrier(int64_t num_threads):
+    num_threads_(num_threads),
+    offered_(0),
+    exited_(0),
+    spins_(0),
+    yields_(0),
+    sleeps_(0){
+   }
+   TerminationBarrier(const TerminationBarrier& rhs) = delete;
+   ~TerminationBarrier() = default;
+
+   int64_t GetNumberOfThreads() const{
+     return num_threads_;
+   }
+
+   int64_t GetNumberOfOffers() const{
+     return offered_.load(std::memory_order_acquire);
+   }
+
+   bool IsTerminated() const{
+     return GetNumberOfOffers() == GetNumberOfThreads();
+   }
+
+   int64_t GetNumberOfExits() const{
+     return exited_.load(std::memory_order_acquire);
+   }
+
+   bool HasExited() const{
+     return GetNumberOfExits() == GetNumberOfThreads();
+   }
+
+   int64_t spins() const{
+     return (int64_t)spins_;
+   }
+
+   int64_t yields() const{
+     return (int64_t)yields_;
+   }
+
+   int64_t sleeps() const{
+     return (int64_t)sleeps_;
+   }
+
+   /**
+    * Offers to terminate, called by a thread once it ran out of work.
+    *
+    * @param has_work Peeks at the shared work, called while waiting for the other threads
+    * @return true if every thread ran out of work, false if has_work found work & the offer was retracted
+    */
+   bool OfferTermination(const std::function<bool()>& has_work);
+
+   /**
+    * Exits the barrier, called by a thread once it terminated as the last thing it does w/ the barrier & the shared
+    * work.
+    */
+   void Exit(){
+     exited_.fetch_add(1, std::memory_order_acq_rel);
+   }
+
+   /**
+    * Waits for every thread to exit, afterwards the barrier & the shared work can be freed.
+    */
+   void WaitForExit();
+
+   /**
+    * Resets the barrier for another round of the same threads, once every thread exited.
+    */
+   void Reset(){
+     PSDN_ASSERT(HasExited());
+     offered_.store(0, std::memory_order_release);
+     exited_.store(0, std::memory_order_release);
+   }
+
+   TerminationBarrier& operator=(const TerminationBarrier& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const TerminationBarrier& val){
+     stream << "TerminationBarrier(";
+     stream << "threads=" << val.GetNumberOfThreads() << ", ";
+     stream << "offered=" << val.GetNumberOfOffers() << ", ";
+     stream << "exited=" << val.GetNumberOfExits() << ", ";
+     stream << "spins=" << val.spins() << ", ";
+     stream << "yields=" << val.yields() << ", ";
+     stream << "sleeps=" << val.sleeps();
+     stream << ")";
+     return stream;
+   }
+ };
+}
+
+#endif//POSEIDON_TERMINATION_BARRIER_H
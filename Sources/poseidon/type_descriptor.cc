@@ -0,0 +1,36 @@
+#include <mutex>
+#include <atomic>
+#include <glog/logging.h>
+
+#include "poseidon/type_descriptor.h"
+
+namespace poseidon{
+ static std::mutex mutex_;
+ static std::atomic<const TypeDescriptor*> types_[TypeDescriptor::kMaxNumberOfTypes];
+ static std::atomic<int64_t> num_types_(1); // 0 is kInvalidClassId
+
+ ClassId TypeDescriptor::Register(const char* name, int64_t size, const int64_t* offsets, int64_t num_offsets){
+   std::lock_guard<std::mutex> guard(mutex_);
+   auto id = num_types_.load(std::memory_order_relaxed);
+   if(id >= kMaxNumberOfTypes){
+     LOG(FATAL) << "cannot register type " << name << ", there are already " << kMaxNumberOfTypes << " types.";
+     return kInvalidClassId;
+   }
+
+   auto type = new TypeDescriptor(static_cast<ClassId>(id), name, size, offsets, num_offsets);
+   types_[id].store(type, std::memory_order_release);
+   num_types_.store(id + 1, std::memory_order_release);
+   DLOG(INFO) << "registered " << (*type) << ".";
+   return type->GetClassId();
+ }
+
+ const TypeDescriptor* TypeDescriptor::Get(ClassId id){
+   if(id == kInvalidClassId || id >= kMaxNumberOfTypes)
+     return nullptr;
+   return types_[id].load(std::memory_order_acquire);
+ }
+
+ int64_t TypeDescriptor::GetNumberOfTypes(){
+   return num_types_.load(std::memory_order_acquire) - 1;
+ }
+}
@@ -0,0 +1,146 @@
+#ifndef POSEIDON_TYPE_DESCRIPTOR_H
+#define POSEIDON_TYPE_DESCRIPTOR_H
+
+#include <array>
+#include <string>
+#include <cstddef>
+#include <ostream>
+#include <typeinfo>
+#include <functional>
+
+#include "poseidon/platform/platform.h"
+
+namespace poseidon{
+ typedef uint16_t ClassId;
+ static constexpr const ClassId kInvalidClassId = 0;
+
+ /**
+  * The byte offsets of the reference fields of T, empty for types w/o references.
+  *
+  * A reference field holds the pointer returned by {@link Allocator::New()}, the start of the referenced object's
+  * payload. Specialized w/ {@link PSDN_POINTER_MAP}.
+  */
+ template<typename T>
+ struct PointerMap{
+   static constexpr const std::array<int64_t, 0> kOffsets = {};
+ };
+
+ template<typename... Offsets>
+ static constexpr std::array<int64_t, sizeof...(Offsets)>
+ MakePointerOffsets(Offsets... offsets){
+   return {{ static_cast<int64_t>(offsets)... }};
+ }
+
+/**
+ * Declares the reference fields of Type, ex: PSDN_POINTER_MAP(Node, offsetof(Node, next), offsetof(Node, prev));
+ *
+ * Has to be used at global scope.
+ */
+#define PSDN_POINTER_MAP(Type, ...) \
+ template<>                         \
+ struct poseidon::PointerMap<Type>{ \
+   static constexpr const auto kOffsets = ::poseidon::MakePointerOffsets(__VA_ARGS__); \
+ }
+
+ /**
+  * Describes the layout of the objects of a class w/ references, so the collectors can trace them precisely.
+  *
+  * Descriptors are registered once per type & looked up by the {@link ClassId} stored in the object header. Types
+  * w/o a {@link PointerMap} don't get a descriptor, their objects are never scanned.
+  */
+ class TypeDescriptor{
+  public:
+   static constexpr const int64_t kMaxNumberOfTypes = 1 << 12;
+  private:
+   ClassId id_;
+   std::string name_;
+   int64_t size_;
+   const int64_t* offsets_;
+   int64_t num_offsets_;
+
+   TypeDescriptor(ClassId id, const char* name, int64_t size, const int64_t* offsets, int64_t num_offsets):
+    id_(id),
+    name_(name),
+    size_(size),
+    offsets_(offsets),
+    num_offsets_(num_offsets){
+   }
+
+   static ClassId Register(const char* name, int64_t size, const int64_t* offsets, int64_t num_offsets);
+  public:
+   TypeDescriptor(const TypeDescriptor& rhs) = delete;
+   ~TypeDescriptor() = default;
+
+   ClassId GetClassId() const{
+     return id_;
+   }
+
+   std::string GetName() const{
+     return name_;
+   }
+
+   int64_t GetSize() const{
+     return size_;
+   }
+
+   int64_t GetNumberOfPointers() const{
+     return num_offsets_;
+   }
+
+   int64_t GetPointerOffset(int64_t index) const{
+     return offsets_[index];
+   }
+
+   /**
+    * Visits the non-null reference fields of the payload at pointer.
+    */
+   void VisitPointers(uword pointer, const std::function<bool(uword*)>& vis) const{
+     for(auto idx = 0; idx < num_offsets_; idx++){
+       auto slot = (uword*)(pointer + offsets_[idx]);
+       if((*slot) != 0 && !vis(slot))
+         return;
+     }
+   }
+
+   TypeDescriptor& operator=(const TypeDescriptor& rhs) = delete;
+
+   friend std::ostream& operator<<(std::ostream& stream, const TypeDescriptor& val){
+     stream << "TypeDescriptor(";
+     stream << "id=" << val.GetClassId() << ", ";
+     stream << "name=" << val.GetName() << ", ";
+     stream << "size=" << val.GetSize() << ", ";
+     stream << "pointers=" << val.GetNumberOfPointers();
+     stream << ")";
+     return stream;
+   }
+
+   /**
+    * Returns the descriptor registered for id, or nullptr if there is none.
+    */
+   static const TypeDescriptor* Get(ClassId id);
+   static int64_t GetNumberOfTypes();
+
+   /**
+    * Returns the descriptor of T, registering it on first use, or nullptr if T has no references.
+    */
+   template<typename T>
+   static inline const TypeDescriptor*
+   Of(){
+     if constexpr(PointerMap<T>::kOffsets.empty()){
+       return nullptr;
+     } else{
+       static const ClassId kClassId = Register(typeid(T).name(), sizeof(T), PointerMap<T>::kOffsets.data(), static_cast<int64_t>(PointerMap<T>::kOffsets.size()));
+       return Get(kClassId);
+     }
+   }
+
+   template<typename T>
+   static inline ClassId
+   GetClassIdOf(){
+     auto type = Of<T>();
+     return type != nullptr ? type->GetClassId() : kInvalidClassId;
+   }
+ };
+}
+
+#endif //POSEIDON_TYPE_DESCRIPTOR_H
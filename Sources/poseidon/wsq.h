@@ -143,6 +143,81 @@ namespace poseidon{
      return value;
    }
  };
+
+ /**
+  * A set of {@link WorkStealingQueue}s, one per partition (ex: a NUMA node).
+  *
+  * Work is pushed to the partition it belongs to & stealers drain their preferred partition before stealing from
+  * the others, so work stays local as long as there is local work left.
+  */
+ template<class T>
+ class PartitionedWorkStealingQueue{
+  private:
+   std::vector<WorkStealingQueue<T>*> partitions_;
+
+   inline int64_t GetPartitionIndex(int64_t partition) const{
+     return partition < 0 ? 0 : partition % GetNumberOfPartitions();
+   }
+  public:
+   explicit PartitionedWorkStealingQueue(int64_t num_partitions, int64_t capacity = 1024):
+    partitions_(){
+     auto num = num_partitions > 0 ? num_partitions : 1;
+     partitions_.reserve(static_cast<size_t>(num));
+     for(auto idx = 0; idx < num; idx++)
+       partitions_.push_back(new WorkStealingQueue<T>(capacity));
+   }
+   PartitionedWorkStealingQueue(const PartitionedWorkStealingQueue<T>& rhs) = delete;
+   ~PartitionedWorkStealingQueue(){
+     for(auto& partition : partitions_)
+       delete partition;
+   }
+
+   int64_t GetNumberOfPartitions() const{
+     return static_cast<int64_t>(partitions_.size());
+   }
+
+   WorkStealingQueue<T>* partition(int64_t partition) const{
+     return partitions_[GetPartitionIndex(partition)];
+   }
+
+   bool empty() const{
+     for(auto& partition : partitions_){
+       if(!partition->empty())
+         return false;
+     }
+     return true;
+   }
+
+   int64_t size() const{
+     int64_t total = 0;
+     for(auto& partition : partitions_)
+       total += partition->size();
+     return total;
+   }
+
+   /**
+    * Pushes item to partition, only the owner of the queue may push.
+    */
+   void Push(int64_t partition, T item){
+     return this->partition(partition)->Push(item);
+   }
+
+   /**
+    * Steals an item from the preferred partition, or from the next non-empty partition if it is empty.
+    */
+   T Steal(int64_t preferred){
+     auto first = GetPartitionIndex(preferred);
+     for(auto idx = 0; idx < GetNumberOfPartitions(); idx++){
+       auto next = partitions_[(first + idx) % GetNumberOfPartitions()];
+       T value;
+       if(!next->empty() && (value = next->Steal()) != (T)0)
+         return value;
+     }
+     return (T)0;
+   }
+
+   PartitionedWorkStealingQueue<T>& operator=(const PartitionedWorkStealingQueue<T>& rhs) = delete;
+ };
 }
 
 #endif //POSEIDON_WSQ_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "poseidon/collector/age_table.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class AgeTableTest : public Test{
+  protected:
+   AgeTable table_;
+
+   AgeTableTest():
+    Test(),
+    table_(){
+   }
+
+   inline AgeTable& table(){
+     return table_;
+   }
+  public:
+   ~AgeTableTest() override = default;
+ };
+
+ TEST_F(AgeTableTest, TestAdd){
+   ASSERT_EQ(table().GetTotalSize(), 0);
+   table().Add(1, 64);
+   table().Add(1, 32);
+   table().Add(3, 16);
+   ASSERT_EQ(table().GetSize(1), 96);
+   ASSERT_EQ(table().GetSize(2), 0);
+   ASSERT_EQ(table().GetSize(3), 16);
+   ASSERT_EQ(table().GetTotalSize(), 112);
+
+   table().Clear();
+   ASSERT_EQ(table().GetTotalSize(), 0);
+ }
+
+ TEST_F(AgeTableTest, TestComputeTenuringThreshold){
+   // everything fits, so the threshold is the max.
+   ASSERT_EQ(table().ComputeTenuringThreshold(128, ObjectTag::kMaxAge), ObjectTag::kMaxAge);
+
+   table().Add(1, 64);
+   table().Add(2, 64);
+   table().Add(3, 64);
+   ASSERT_EQ(table().ComputeTenuringThreshold(256, ObjectTag::kMaxAge), ObjectTag::kMaxAge);
+   // the survivors of age 1 & 2 fill 128 bytes, the ones of age 3 overflow the target.
+   ASSERT_EQ(table().ComputeTenuringThreshold(128, ObjectTag::kMaxAge), 3);
+   ASSERT_EQ(table().ComputeTenuringThreshold(64, ObjectTag::kMaxAge), 2);
+   ASSERT_EQ(table().ComputeTenuringThreshold(0, ObjectTag::kMaxAge), 1);
+   ASSERT_EQ(table().ComputeTenuringThreshold(128, 2), 2);
+ }
+}
@@ -0,0 +1,95 @@
+#include <thread>
+
+#include "helpers.h"
+#include "poseidon/collector/marker.h"
+#include "poseidon/collector/collector.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class CollectorTest : public Test{
+  protected:
+   static inline Heap* heap(){
+     return Heap::GetCurrentThreadHeap();
+   }
+
+   static inline OldZone* old_zone(){
+     return heap()->old_zone();
+   }
+
+   void SetUp() override{
+     LocalPage::ResetLocalPageForCurrentThread();
+     concurrent_mark_ = FLAGS_concurrent_mark;
+     incremental_mark_ = FLAGS_incremental_mark;
+     concurrent_mark_threshold_ = FLAGS_concurrent_mark_threshold;
+   }
+
+   void TearDown() override{
+     FLAGS_concurrent_mark = concurrent_mark_;
+     FLAGS_incremental_mark = incremental_mark_;
+     FLAGS_concurrent_mark_threshold = concurrent_mark_threshold_;
+   }
+  private:
+   bool concurrent_mark_ = false;
+   bool incremental_mark_ = false;
+   int64_t concurrent_mark_threshold_ = 0;
+  public:
+   CollectorTest() = default;
+   ~CollectorTest() override = default;
+ };
+
+ TEST_F(CollectorTest, TestMinorCollectionStartsMark){
+   FLAGS_concurrent_mark = false;
+   FLAGS_incremental_mark = true;
+   FLAGS_concurrent_mark_threshold = 0;
+
+   auto pauses = Collector::GetPauseHistory().GetNumberOfPauses();
+   Collector::MinorCollection();
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+   // the scavenge & the initial mark are recorded as pauses of their own.
+   ASSERT_EQ(Collector::GetPauseHistory().GetNumberOfPauses(), pauses + 2);
+
+   while(Marker::IsMarkingIncrementally())
+     Collector::MarkStep();
+   ASSERT_FALSE(Marker::IsMarking());
+ }
+
+ TEST_F(CollectorTest, TestMarkStepOfOtherHeap){
+   FLAGS_concurrent_mark = false;
+   FLAGS_incremental_mark = true;
+
+   Collector::StartMajorCollection();
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+   // the mutator of another heap neither steps nor finishes the mark.
+   std::thread thread([](){
+     Heap::ResetCurrentThreadHeap();
+     Collector::MarkStep();
+     Marker::MarkStep();
+   });
+   thread.join();
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+
+   while(Marker::IsMarkingIncrementally())
+     Collector::MarkStep();
+   ASSERT_FALSE(Marker::IsMarking());
+ }
+
+ TEST_F(CollectorTest, TestFinishTerminatedMark){
+   FLAGS_concurrent_mark = true;
+   FLAGS_concurrent_mark_threshold = 100;
+
+   auto root = Local<word>();
+   root = TryAllocateNewWord(old_zone(), 1)->GetAddress();
+   auto garbage = TryAllocateNewWord(old_zone(), 2);
+
+   Collector::StartMajorCollection();
+   ASSERT_TRUE(Marker::IsMarkingConcurrently());
+   while(!Marker::IsConcurrentMarkTerminated())
+     std::this_thread::yield();
+   // the minor collection is a safepoint, the mark is finished & the old zone swept before it runs out.
+   Collector::MinorCollection();
+   ASSERT_FALSE(Marker::IsMarking());
+   ASSERT_TRUE(old_zone()->IsMarked(root.raw()));
+   ASSERT_TRUE(garbage->IsFree());
+ }
+}
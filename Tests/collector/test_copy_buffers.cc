@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "memory_region_test.h"
+#include "poseidon/collector/copy_buffers.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class CopyBuffersTest : public HeapTest{
+  protected:
+   static constexpr const int64_t kBufferSize = 4 * kKB;
+
+   Semispace to_;
+   CopyBuffers buffers_;
+
+   CopyBuffersTest():
+    HeapTest(),
+    to_(new_zone()->tospace(), new_zone()->semisize()),
+    buffers_(&to_, old_zone(), kBufferSize){
+   }
+
+   inline Semispace* to(){
+     return &to_;
+   }
+
+   inline CopyBuffers* buffers(){
+     return &buffers_;
+   }
+  public:
+   ~CopyBuffersTest() override = default;
+ };
+
+ TEST_F(CopyBuffersTest, TestTryAllocateNew){
+   auto p1 = (RawObject*)buffers()->TryAllocateNew(kWordSize);
+   ASSERT_NE(p1, nullptr);
+   ASSERT_TRUE(p1->IsNew());
+   ASSERT_EQ(p1->GetPointerSize(), kWordSize);
+   ASSERT_EQ(buffers()->refills(), 1);
+   // the to-space is claimed a buffer at a time.
+   ASSERT_EQ(to()->GetNumberOfBytesAllocated(), kBufferSize);
+
+   auto p2 = (RawObject*)buffers()->TryAllocateNew(kWordSize);
+   ASSERT_EQ(p2->GetAddress(), p1->GetAddress() + p1->GetTotalSize());
+   ASSERT_EQ(buffers()->refills(), 1);
+   ASSERT_EQ(to()->GetNumberOfBytesAllocated(), kBufferSize);
+ }
+
+ TEST_F(CopyBuffersTest, TestTryAllocateNewRefill){
+   static constexpr const int64_t kObjectSize = kBufferSize / 8;
+   auto total_size = static_cast<int64_t>(sizeof(RawObject)) + kObjectSize;
+   auto per_buffer = kBufferSize / total_size;
+   for(auto idx = 0; idx <= per_buffer; idx++)
+     ASSERT_NE(buffers()->TryAllocateNew(kObjectSize), 0);
+   ASSERT_EQ(buffers()->refills(), 2);
+   ASSERT_EQ(buffers()->wasted(), kBufferSize - (per_buffer * total_size));
+   ASSERT_EQ(to()->GetNumberOfBytesAllocated(), 2 * kBufferSize);
+ }
+
+ TEST_F(CopyBuffersTest, TestTryAllocateNewLarge){
+   auto ptr = (RawObject*)buffers()->TryAllocateNew(kBufferSize / 2);
+   ASSERT_NE(ptr, nullptr);
+   // large objects are allocated directly.
+   ASSERT_EQ(buffers()->refills(), 0);
+   ASSERT_EQ(ptr->GetAddress(), to()->GetStartingAddress());
+   ASSERT_EQ(to()->GetNumberOfBytesAllocated(), ptr->GetTotalSize());
+ }
+
+ TEST_F(CopyBuffersTest, TestTryAllocateOld){
+   auto free = old_zone()->free_list()->GetTotalBytesFree();
+   auto p1 = (RawObject*)buffers()->TryAllocateOld(kWordSize);
+   ASSERT_NE(p1, nullptr);
+   ASSERT_TRUE(p1->IsOld());
+   ASSERT_EQ(p1->GetPointerSize(), kWordSize);
+   ASSERT_EQ(buffers()->refills(), 1);
+   ASSERT_EQ(old_zone()->free_list()->GetTotalBytesFree(), free - kBufferSize);
+
+   auto p2 = (RawObject*)buffers()->TryAllocateOld(kWordSize);
+   ASSERT_EQ(p2->GetAddress(), p1->GetAddress() + p1->GetTotalSize());
+   ASSERT_EQ(buffers()->refills(), 1);
+
+   // the unused tail goes back to the free list.
+   buffers()->Retire();
+   ASSERT_EQ(buffers()->wasted(), 0);
+   ASSERT_EQ(old_zone()->free_list()->GetTotalBytesFree(), free - (p1->GetTotalSize() + p2->GetTotalSize()));
+ }
+
+ TEST_F(CopyBuffersTest, TestUndo){
+   auto p1 = (RawObject*)buffers()->TryAllocateNew(kWordSize);
+   auto p2 = (RawObject*)buffers()->TryAllocateNew(kWordSize);
+   buffers()->Undo(p2);
+   ASSERT_EQ(buffers()->lab().GetCurrentAddress(), p2->GetAddress());
+   ASSERT_EQ((RawObject*)buffers()->TryAllocateNew(kWordSize), p2);
+
+   auto o1 = (RawObject*)buffers()->TryAllocateOld(kWordSize);
+   buffers()->Undo(o1);
+   ASSERT_EQ(buffers()->plab().GetCurrentAddress(), o1->GetAddress());
+   ASSERT_EQ(buffers()->wasted(), 0);
+   ASSERT_NE(p1, nullptr);
+ }
+
+ TEST_F(CopyBuffersTest, TestRetire){
+   auto ptr = (RawObject*)buffers()->TryAllocateNew(kWordSize);
+   buffers()->Retire();
+   ASSERT_EQ(buffers()->wasted(), kBufferSize - ptr->GetTotalSize());
+   ASSERT_EQ(buffers()->lab().GetSize(), 0);
+   ASSERT_EQ(buffers()->plab().GetSize(), 0);
+
+   // the tail of the to-space buffer is filled, so the to-space stays walkable.
+   auto filler = (RawObject*)(ptr->GetAddress() + ptr->GetTotalSize());
+   ASSERT_EQ(filler->GetTotalSize(), kBufferSize - ptr->GetTotalSize());
+ }
+
+ TEST_F(CopyBuffersTest, TestDisabled){
+   CopyBuffers buffers(to(), old_zone(), 0);
+   auto p1 = (RawObject*)buffers.TryAllocateNew(kWordSize);
+   ASSERT_EQ(p1->GetAddress(), to()->GetStartingAddress());
+   ASSERT_EQ(to()->GetNumberOfBytesAllocated(), p1->GetTotalSize());
+   ASSERT_NE(buffers.TryAllocateOld(kWordSize), 0);
+   ASSERT_EQ(buffers.refills(), 0);
+ }
+}
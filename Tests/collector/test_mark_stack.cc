@@ -0,0 +1,108 @@
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "poseidon/collector/mark_stack.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ TEST(MarkStackTest, TestPushPop){
+   MarkStackSegmentPool pool(4);
+   MarkStack stack(&pool);
+   ASSERT_TRUE(stack.IsEmpty());
+   ASSERT_TRUE(stack.Push(1));
+   ASSERT_TRUE(stack.Push(2));
+   ASSERT_EQ(stack.size(), 2);
+   ASSERT_EQ(stack.Pop(), 2);
+   ASSERT_EQ(stack.Pop(), 1);
+   ASSERT_EQ(stack.Pop(), 0);
+   ASSERT_TRUE(stack.IsEmpty());
+ }
+
+ TEST(MarkStackTest, TestPublishFullSegment){
+   MarkStackSegmentPool pool(4);
+   MarkStack stack(&pool);
+   for(uword idx = 1; idx <= MarkStackSegment::kCapacity + 1; idx++)
+     ASSERT_TRUE(stack.Push(idx));
+   // the full segment was handed over to the other markers.
+   ASSERT_EQ(pool.GetNumberOfSegments(), 1);
+   ASSERT_EQ(stack.size(), 1);
+
+   MarkStack other(&pool);
+   ASSERT_EQ(other.Pop(), MarkStackSegment::kCapacity);
+   ASSERT_TRUE(pool.IsEmpty());
+   ASSERT_EQ(stack.Pop(), MarkStackSegment::kCapacity + 1);
+   ASSERT_EQ(stack.Pop(), 0);
+ }
+
+ TEST(MarkStackTest, TestOverflow){
+   MarkStackSegmentPool pool(1);
+   MarkStack stack(&pool);
+   for(uword idx = 1; idx <= MarkStackSegment::kCapacity; idx++)
+     ASSERT_TRUE(stack.Push(idx));
+   // the pool is out of segments, so the full segment stays w/ the stack.
+   ASSERT_FALSE(stack.Push(MarkStackSegment::kCapacity + 1));
+   ASSERT_TRUE(pool.IsEmpty());
+   ASSERT_EQ(stack.Pop(), MarkStackSegment::kCapacity);
+   ASSERT_TRUE(stack.Push(MarkStackSegment::kCapacity + 1));
+ }
+
+ TEST(MarkStackTest, TestPublishSurplus){
+   MarkStackSegmentPool pool(4);
+   MarkStack stack(&pool);
+   for(uword idx = 1; idx < (2 * MarkStack::kMinSurplus); idx++)
+     ASSERT_TRUE(stack.Push(idx));
+   ASSERT_FALSE(stack.PublishSurplus());
+   ASSERT_TRUE(stack.Push(2 * MarkStack::kMinSurplus));
+   ASSERT_TRUE(stack.PublishSurplus());
+   ASSERT_EQ(stack.size(), MarkStack::kMinSurplus);
+   ASSERT_EQ(pool.GetNumberOfSegments(), 1);
+   // there's published work left, so nothing else is published.
+   ASSERT_FALSE(stack.PublishSurplus());
+
+   // the older half is published, the stack keeps the newer entries.
+   MarkStack other(&pool);
+   ASSERT_EQ(other.Pop(), MarkStack::kMinSurplus);
+   ASSERT_EQ(stack.Pop(), 2 * MarkStack::kMinSurplus);
+ }
+
+ TEST(MarkStackTest, TestRelease){
+   MarkStackSegmentPool pool(1);
+   MarkStack stack(&pool);
+   ASSERT_TRUE(stack.Push(1));
+   // the entries of a released segment are published.
+   stack.Release();
+   ASSERT_TRUE(stack.IsEmpty());
+   ASSERT_EQ(pool.GetNumberOfSegments(), 1);
+   ASSERT_EQ(stack.Pop(), 1);
+   ASSERT_EQ(stack.Pop(), 0);
+   // the empty segment is reused.
+   ASSERT_TRUE(stack.Push(2));
+ }
+
+ TEST(MarkStackTest, TestConcurrentDrain){
+   static constexpr const int64_t kNumberOfThreads = 4;
+   static constexpr const int64_t kNumberOfEntries = 16 * MarkStackSegment::kCapacity;
+   MarkStackSegmentPool pool(kNumberOfEntries);
+   {
+     MarkStack stack(&pool);
+     for(uword idx = 1; idx <= kNumberOfEntries; idx++)
+       ASSERT_TRUE(stack.Push(idx));
+   }
+
+   RelaxedAtomic<int64_t> total(0);
+   std::vector<std::thread> threads;
+   for(auto idx = 0; idx < kNumberOfThreads; idx++){
+     threads.emplace_back([&](){
+       MarkStack stack(&pool);
+       uword next;
+       while((next = stack.Pop()) != 0)
+         total += static_cast<int64_t>(next);
+     });
+   }
+   for(auto& thread : threads)
+     thread.join();
+   ASSERT_EQ((int64_t)total, (kNumberOfEntries * (kNumberOfEntries + 1)) / 2);
+   ASSERT_TRUE(pool.IsEmpty());
+ }
+}
@@ -0,0 +1,236 @@
+#include <thread>
+
+#include "helpers.h"
+#include "poseidon/allocator/allocator.h"
+#include "poseidon/collector/marker.h"
+#include "poseidon/collector/scavenger.h"
+
+namespace poseidon{
+ struct MarkerTestNode{
+   uword next;
+   word value;
+ };
+}
+
+PSDN_POINTER_MAP(poseidon::MarkerTestNode, offsetof(poseidon::MarkerTestNode, next));
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class ConcurrentMarkerTest : public Test{
+  protected:
+   static inline Heap* heap(){
+     return Heap::GetCurrentThreadHeap();
+   }
+
+   static inline OldZone* old_zone(){
+     return heap()->old_zone();
+   }
+
+   static inline RawObject*
+   TryAllocateOldNode(word value, RawObject* next){
+     auto val = (RawObject*)old_zone()->TryAllocate(sizeof(MarkerTestNode));
+     val->SetClassId(TypeDescriptor::GetClassIdOf<MarkerTestNode>());
+     auto node = (MarkerTestNode*)val->GetPointer();
+     node->next = next != nullptr ? next->GetObjectPointerAddress() : 0;
+     node->value = value;
+     return val;
+   }
+
+   static inline RawObject*
+   TryAllocateNewNode(word value, RawObject* next){
+     auto val = (RawObject*)heap()->new_zone()->TryAllocate(sizeof(MarkerTestNode));
+     val->SetClassId(TypeDescriptor::GetClassIdOf<MarkerTestNode>());
+     auto node = (MarkerTestNode*)val->GetPointer();
+     node->next = next != nullptr ? next->GetObjectPointerAddress() : 0;
+     node->value = value;
+     return val;
+   }
+
+   static inline RawObject*
+   GetNext(RawObject* val){
+     auto next = ((MarkerTestNode*)val->GetPointer())->next;
+     return next != 0 ? RawObject::FromPointer(next) : nullptr;
+   }
+
+   static inline void
+   SetMaxTenuringThreshold(int64_t value){
+     FLAGS_max_tenuring_threshold = value;
+     Scavenger::ResetTenuringThreshold();
+   }
+
+   void SetUp() override{
+     LocalPage::ResetLocalPageForCurrentThread();
+     max_tenuring_threshold_ = FLAGS_max_tenuring_threshold;
+   }
+
+   void TearDown() override{
+     SetMaxTenuringThreshold(max_tenuring_threshold_);
+   }
+  private:
+   int64_t max_tenuring_threshold_ = 0;
+  public:
+   ConcurrentMarkerTest() = default;
+   ~ConcurrentMarkerTest() override = default;
+ };
+
+ TEST_F(ConcurrentMarkerTest, TestSnapshotAtTheBeginning){
+   auto child = TryAllocateOldNode(2, nullptr);
+   auto root = Local<MarkerTestNode>();
+   root = TryAllocateOldNode(1, child)->GetAddress();
+   auto garbage = TryAllocateOldNode(3, nullptr);
+
+   Marker::StartConcurrentMark();
+   ASSERT_TRUE(Marker::IsMarking());
+   ASSERT_TRUE(Marker::IsMarkingConcurrently());
+   // the only reference to the child is overwritten while the workers are marking, the barrier records it.
+   Allocator::StorePointer(&root->next, 0);
+   // allocated black, it isn't part of the snapshot.
+   auto large = (RawObject*)heap()->TryAllocate(GetLargeObjectSize());
+   ASSERT_TRUE(large->IsMarked());
+   Marker::FinishConcurrentMark();
+   ASSERT_FALSE(Marker::IsMarkingConcurrently());
+   ASSERT_FALSE(Marker::IsMarking());
+
+   ASSERT_TRUE(old_zone()->IsMarked(root.raw()));
+   ASSERT_TRUE(old_zone()->IsMarked(child));
+   ASSERT_FALSE(old_zone()->IsMarked(garbage));
+   ASSERT_TRUE(large->IsMarked());
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestRecordOverwrite){
+   // never referenced by anything, only the barrier can mark it.
+   auto unreachable = TryAllocateOldNode(1, nullptr);
+
+   Marker::StartConcurrentMark();
+   ASSERT_FALSE(old_zone()->IsMarked(unreachable));
+   Marker::RecordOverwrite(0);
+   Marker::RecordOverwrite(unreachable->GetObjectPointerAddress());
+   // the overwritten object is marked right away, its fields are traced by the markers.
+   ASSERT_TRUE(old_zone()->IsMarked(unreachable));
+   Marker::FinishConcurrentMark();
+   ASSERT_TRUE(old_zone()->IsMarked(unreachable));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestRecordOverwriteOtherThread){
+   auto unreachable = TryAllocateOldNode(1, nullptr);
+
+   Marker::StartConcurrentMark();
+   // the other thread doesn't own the marked heap, so it doesn't shade onto the marker's stack.
+   std::thread thread([&](){
+     Marker::RecordOverwrite(unreachable->GetObjectPointerAddress());
+   });
+   thread.join();
+   ASSERT_FALSE(old_zone()->IsMarked(unreachable));
+   Marker::FinishConcurrentMark();
+   ASSERT_FALSE(old_zone()->IsMarked(unreachable));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestMarkOfOtherHeap){
+   auto root = Local<MarkerTestNode>();
+   root = TryAllocateOldNode(1, nullptr)->GetAddress();
+
+   Marker::StartConcurrentMark();
+   // the mark belongs to the heap of this thread, the mutator of another heap can't pause or finish it.
+   std::thread thread([](){
+     Heap::ResetCurrentThreadHeap();
+     EXPECT_FALSE(Marker::IsMarkingConcurrently(Heap::GetCurrentThreadHeap()));
+     EXPECT_EQ(Marker::GetMarkStackPool(), nullptr);
+     EXPECT_FALSE(Marker::IsConcurrentMarkTerminated());
+     Marker::FinishConcurrentMark();
+     EXPECT_TRUE(Marker::IsMarkingConcurrently());
+   });
+   thread.join();
+   ASSERT_TRUE(Marker::IsMarkingConcurrently(heap()));
+   ASSERT_NE(Marker::GetMarkStackPool(), nullptr);
+   Marker::FinishConcurrentMark();
+   ASSERT_FALSE(Marker::IsMarking());
+   ASSERT_TRUE(old_zone()->IsMarked(root.raw()));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestIncrementalMark){
+   static constexpr const int64_t kNumberOfNodes = 8;
+   auto root = Local<MarkerTestNode>();
+   RawObject* nodes[kNumberOfNodes];
+   RawObject* next = nullptr;
+   for(auto idx = kNumberOfNodes - 1; idx >= 0; idx--)
+     next = nodes[idx] = TryAllocateOldNode(idx, next);
+   root = nodes[0]->GetAddress();
+
+   // every step scans a single node.
+   auto step_size = FLAGS_mark_step_size;
+   auto step_time = FLAGS_mark_step_time;
+   FLAGS_mark_step_size = 1;
+   FLAGS_mark_step_time = 0;
+   Marker::StartIncrementalMark();
+   ASSERT_TRUE(Marker::IsMarkingConcurrently());
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+   int64_t num_steps = 1;
+   while(!Marker::MarkStep())
+     num_steps++;
+   ASSERT_GE(num_steps, kNumberOfNodes);
+   Marker::FinishConcurrentMark();
+   FLAGS_mark_step_size = step_size;
+   FLAGS_mark_step_time = step_time;
+   ASSERT_FALSE(Marker::IsMarkingIncrementally());
+   ASSERT_FALSE(Marker::IsMarking());
+   for(auto& node : nodes)
+     ASSERT_TRUE(old_zone()->IsMarked(node));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestScavengeDuringMark){
+   SetMaxTenuringThreshold(ObjectTag::kMaxAge);
+   auto child = TryAllocateOldNode(2, nullptr);
+   auto root = Local<MarkerTestNode>();
+   root = TryAllocateNewNode(1, child)->GetAddress();
+
+   Marker::StartIncrementalMark();
+   // the root is on the mark stack, it's moved before the steps trace it.
+   Scavenger::Scavenge(heap(), false);
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+   ASSERT_TRUE(root.raw()->IsNew());
+   while(!Marker::MarkStep());
+   Marker::FinishConcurrentMark();
+   ASSERT_TRUE(old_zone()->IsMarked(child));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestPromoteDuringMark){
+   SetMaxTenuringThreshold(0);
+   auto child = TryAllocateOldNode(3, nullptr);
+   auto next = TryAllocateNewNode(2, child);
+   auto root = Local<MarkerTestNode>();
+   root = TryAllocateNewNode(1, next)->GetAddress();
+
+   Marker::StartIncrementalMark();
+   // both nodes are promoted & allocated black, the child is only reachable through the second one.
+   Scavenger::Scavenge(heap(), false);
+   ASSERT_TRUE(Marker::IsMarkingIncrementally());
+   ASSERT_TRUE(root.raw()->IsOld());
+   next = GetNext(root.raw());
+   ASSERT_TRUE(next->IsOld());
+   ASSERT_TRUE(old_zone()->IsMarked(root.raw()));
+   ASSERT_TRUE(old_zone()->IsMarked(next));
+   ASSERT_FALSE(old_zone()->IsMarked(child));
+   while(!Marker::MarkStep());
+   Marker::FinishConcurrentMark();
+   ASSERT_TRUE(old_zone()->IsMarked(child));
+ }
+
+ TEST_F(ConcurrentMarkerTest, TestParallelScavengeDuringMark){
+   static constexpr const int64_t kNumberOfNodes = 1024;
+   SetMaxTenuringThreshold(ObjectTag::kMaxAge);
+   auto child = TryAllocateOldNode(kNumberOfNodes, nullptr);
+   RawObject* next = child;
+   for(auto idx = kNumberOfNodes - 1; idx > 0; idx--)
+     next = TryAllocateNewNode(idx, next);
+   auto root = Local<MarkerTestNode>();
+   root = TryAllocateNewNode(0, next)->GetAddress();
+
+   Marker::StartConcurrentMark();
+   Scavenger::Scavenge(heap(), true);
+   heap()->new_zone()->WaitForToSpace();
+   ASSERT_TRUE(Marker::IsMarkingConcurrently());
+   Marker::FinishConcurrentMark();
+   ASSERT_TRUE(old_zone()->IsMarked(child));
+ }
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "poseidon/collector/pause_history.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ static inline Timestamp
+ At(int64_t millis){
+   return Timestamp(std::chrono::milliseconds(millis));
+ }
+
+ TEST(PauseHistoryTest, TestNoPauses){
+   PauseHistory pauses;
+   ASSERT_EQ(pauses.GetNumberOfPauses(), 0);
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(10), At(100)), 1.0);
+ }
+
+ TEST(PauseHistoryTest, TestMinimumMutatorUtilization){
+   PauseHistory pauses;
+   pauses.Record(At(100), At(101));
+   pauses.Record(At(102), At(103));
+   ASSERT_EQ(pauses.GetNumberOfPauses(), 2);
+   ASSERT_EQ(pauses.GetTotalPauseTime(), std::chrono::milliseconds(2));
+   ASSERT_EQ(pauses.GetMaxPause(), std::chrono::milliseconds(1));
+   // both pauses fit in the window.
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(10), At(200)), 0.8);
+   // the window is as long as a pause.
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(1), At(200)), 0.0);
+   // the window can't overlap w/ more than one pause.
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(2), At(200)), 0.5);
+ }
+
+ TEST(PauseHistoryTest, TestRecentPauses){
+   PauseHistory pauses;
+   for(int64_t idx = 0; idx < PauseHistory::kMaxNumberOfPauses + 1; idx++)
+     pauses.Record(At(idx * 10), At((idx * 10) + 1));
+   // the oldest pause isn't kept, but counts.
+   ASSERT_EQ(pauses.GetNumberOfPauses(), PauseHistory::kMaxNumberOfPauses + 1);
+   ASSERT_EQ(pauses.GetTotalPauseTime(), std::chrono::milliseconds(PauseHistory::kMaxNumberOfPauses + 1));
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(10), At(10000)), 0.9);
+
+   pauses.Clear();
+   ASSERT_EQ(pauses.GetNumberOfPauses(), 0);
+   ASSERT_DOUBLE_EQ(pauses.GetMinimumMutatorUtilization(std::chrono::milliseconds(10), At(10000)), 1.0);
+ }
+}
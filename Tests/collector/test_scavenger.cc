@@ -1,8 +1,54 @@
+#include <thread>
 #include "helpers.h"
 #include "poseidon/heap/semispace.h"
+#include "poseidon/collector/refiner.h"
 #include "collector/test_scavenger.h"
 
 namespace poseidon{
+ struct TestNode{
+   uword next;
+   word value;
+ };
+}
+
+PSDN_POINTER_MAP(poseidon::TestNode, offsetof(poseidon::TestNode, next));
+
+namespace poseidon{
+ static inline RawObject*
+ TryAllocateNewNode(NewZone* zone, word value, RawObject* next){
+   auto val = (RawObject*)zone->TryAllocate(sizeof(TestNode));
+   val->SetClassId(TypeDescriptor::GetClassIdOf<TestNode>());
+   auto node = (TestNode*)val->GetPointer();
+   node->next = next != nullptr ? next->GetObjectPointerAddress() : 0;
+   node->value = value;
+   return val;
+ }
+
+ static inline RawObject*
+ TryAllocateOldNode(OldZone* zone, word value){
+   auto val = (RawObject*)zone->TryAllocate(sizeof(TestNode));
+   val->SetClassId(TypeDescriptor::GetClassIdOf<TestNode>());
+   auto node = (TestNode*)val->GetPointer();
+   node->next = 0;
+   node->value = value;
+   return val;
+ }
+
+ static inline AssertionResult
+ IsNode(RawObject* val, word value){
+   if(val->GetClassId() != TypeDescriptor::GetClassIdOf<TestNode>())
+     return AssertionFailure() << val->ToString() << " is not a TestNode.";
+   auto node = (TestNode*)val->GetPointer();
+   if(node->value != value)
+     return AssertionFailure() << "expected node value " << node->value << " to be " << value;
+   return AssertionSuccess();
+ }
+
+ static inline RawObject*
+ GetNext(RawObject* val){
+   auto next = ((TestNode*)val->GetPointer())->next;
+   return next != 0 ? RawObject::FromPointer(next) : nullptr;
+ }
  TEST_F(ScavengerTest, TestScavengeObject){
    Semispace tospace(new_zone()->tospace(), new_zone()->semisize());
 
@@ -46,7 +92,7 @@ namespace poseidon{
    ASSERT_TRUE(IsForwardingTo(p0, p1));
    ASSERT_TRUE(IsAllocated(p1));
    ASSERT_TRUE(IsNew(p1));
-   ASSERT_TRUE(IsRemembered(p1));
+   ASSERT_EQ(p1->GetAge(), 1);
    ASSERT_TRUE(IsWord(p1, kRootValue));
    ASSERT_NE(p1->GetAddress(), p0->GetAddress());
 
@@ -54,12 +100,39 @@ namespace poseidon{
    ASSERT_TRUE(IsForwardingTo(p1, p2));
    ASSERT_TRUE(IsAllocated(p2));
    ASSERT_TRUE(IsOld(p2));
-   ASSERT_TRUE(IsRemembered(p2));
    ASSERT_TRUE(IsWord(p2, kRootValue));
    ASSERT_NE(p2->GetAddress(), p0->GetAddress());
    ASSERT_NE(p2->GetAddress(), p1->GetAddress());
  }
 
+ TEST_F(ScavengerTest, TestProcessObjectToSpaceOverflow){
+   static constexpr const int64_t kNumberOfObjects = 8;
+   std::vector<RawObject*> objects;
+   for(auto idx = 0; idx < kNumberOfObjects; idx++)
+     objects.push_back(TryAllocateNewWord(new_zone(), idx));
+
+   auto p0 = ProcessObject(objects[0]);
+   ASSERT_TRUE(IsNew(p0));
+   ASSERT_TRUE(IsWord(p0, 0));
+
+   // the rest of the to-space is taken, so the other survivors don't fit anymore.
+   auto remaining = to()->GetNumberOfBytesRemaining() - static_cast<int64_t>(sizeof(RawObject));
+   ASSERT_TRUE(to()->TryAllocate(remaining) != 0);
+   ASSERT_TRUE(to()->IsFull());
+
+   // the buffer of the fixture was refilled by the first survivor, fresh buffers can't refill from the full to-space.
+   CopyBuffers buffers(to(), old_zone());
+   for(auto idx = 1; idx < kNumberOfObjects; idx++){
+     auto copied = false;
+     auto new_ptr = ProcessObject(&buffers, objects[idx], &copied);
+     ASSERT_TRUE(copied);
+     ASSERT_TRUE(IsForwardingTo(objects[idx], new_ptr));
+     ASSERT_TRUE(IsOld(new_ptr));
+     ASSERT_TRUE(IsWord(new_ptr, idx));
+   }
+   buffers.Retire();
+ }
+
  TEST_F(ScavengerTest, TestSerialScavenge){
    LocalPage::ResetLocalPageForCurrentThread();
 
@@ -85,6 +158,23 @@ namespace poseidon{
    ASSERT_TRUE(IsUnallocated(g1));
  }
 
+ TEST_F(ScavengerTest, TestSerialScavengeCopyBuffers){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   auto r1 = Local<word>();
+   r1 = TryAllocateNewWord(new_zone(), kRoot1Value)->GetAddress();
+   ASSERT_TRUE(IsAllocated(r1));
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+   ASSERT_TRUE(IsWord(r1, kRoot1Value));
+   // the survivor was copied into a buffer, the rest of it was left unused.
+   ASSERT_EQ(Scavenger::GetNumberOfBufferRefillsLastScavenge(), 1);
+   ASSERT_EQ(Scavenger::GetNumberOfBytesWastedLastScavenge(), GetCollectorLocalAllocationBufferSize() - r1.raw()->GetTotalSize());
+   // the mutator allocates after the buffer.
+   ASSERT_EQ(new_zone()->GetCurrentAddress(), r1.raw()->GetAddress() + GetCollectorLocalAllocationBufferSize());
+ }
+
  TEST_F(ScavengerTest, TestParallelScavenge){
    LocalPage::ResetLocalPageForCurrentThread();
 
@@ -109,4 +199,335 @@ namespace poseidon{
 
    ASSERT_TRUE(IsUnallocated(g1));
  }
-}
\ No newline at end of file
+
+ TEST_F(ScavengerTest, TestSerialScavengeReferences){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateNewNode(new_zone(), kRoot1Value, c1)->GetAddress();
+   ASSERT_TRUE(IsNode(r1.raw(), kRoot1Value));
+   ASSERT_EQ(GetNext(r1.raw()), c1);
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+
+   // the child is only reachable through the root, it has to be copied & the root updated.
+   ASSERT_TRUE(IsNew(r1.raw()));
+   ASSERT_TRUE(IsNode(r1.raw(), kRoot1Value));
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, nullptr);
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(GetNext(next), nullptr);
+   ASSERT_TRUE(IsUnallocated(c1));
+ }
+
+ TEST_F(ScavengerTest, TestParallelScavengeReferences){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateNewNode(new_zone(), kRoot1Value, c1)->GetAddress();
+   ASSERT_TRUE(IsNode(r1.raw(), kRoot1Value));
+   ASSERT_EQ(GetNext(r1.raw()), c1);
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+
+   // the child is only reachable through the root, it has to be copied & the root updated.
+   ASSERT_TRUE(IsNew(r1.raw()));
+   ASSERT_TRUE(IsNode(r1.raw(), kRoot1Value));
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, nullptr);
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(GetNext(next), nullptr);
+   ASSERT_TRUE(IsUnallocated(c1));
+ }
+
+ TEST_F(ScavengerTest, TestParallelScavengeList){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kNumberOfNodes = 1024;
+   RawObject* next = nullptr;
+   for(auto idx = kNumberOfNodes - 1; idx > 0; idx--)
+     next = TryAllocateNewNode(new_zone(), idx, next);
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateNewNode(new_zone(), 0, next)->GetAddress();
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+
+   // the list is only reachable through its head, the workers trace it through their queues.
+   auto node = r1.raw();
+   for(auto idx = 0; idx < kNumberOfNodes; idx++){
+     ASSERT_NE(node, nullptr);
+     ASSERT_TRUE(IsNew(node));
+     ASSERT_TRUE(IsNode(node, idx));
+     node = GetNext(node);
+   }
+   ASSERT_EQ(node, nullptr);
+ }
+
+ TEST_F(ScavengerTest, TestSerialScavengeRememberedSet){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateOldNode(old_zone(), kRoot1Value)->GetAddress();
+   ASSERT_TRUE(IsOld(r1.raw()));
+
+   // the child is only referenced by an old object, the write barrier has to remember the field.
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   auto slot = &r1->next;
+   (*slot) = c1->GetObjectPointerAddress();
+   heap()->RecordWrite(slot, *slot);
+   ASSERT_EQ(old_zone()->store_buffer()->size(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_TRUE(IsUnallocated(c1));
+   ASSERT_EQ(Refiner::GetStats().refined_in_pause(), 1);
+   // the field still references a new object.
+   ASSERT_TRUE(old_zone()->store_buffer()->empty());
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+
+   // the child survived twice, so it got promoted & the card isn't needed anymore.
+   next = GetNext(r1.raw());
+   ASSERT_TRUE(IsOld(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 0);
+ }
+
+ TEST_F(ScavengerTest, TestParallelScavengeRememberedSet){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateOldNode(old_zone(), kRoot1Value)->GetAddress();
+   ASSERT_TRUE(IsOld(r1.raw()));
+
+   // the child is only referenced by an old object, the write barrier has to remember the field.
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   auto slot = &r1->next;
+   (*slot) = c1->GetObjectPointerAddress();
+   heap()->RecordWrite(slot, *slot);
+   ASSERT_EQ(old_zone()->store_buffer()->size(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_TRUE(IsUnallocated(c1));
+   ASSERT_EQ(Refiner::GetStats().refined_in_pause(), 1);
+   // the field still references a new object.
+   ASSERT_TRUE(old_zone()->store_buffer()->empty());
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+
+   // the child survived twice, so it got promoted & the card isn't needed anymore.
+   next = GetNext(r1.raw());
+   ASSERT_TRUE(IsOld(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 0);
+ }
+
+ TEST_F(ScavengerTest, TestRefinement){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateOldNode(old_zone(), kRoot1Value)->GetAddress();
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   auto slot = &r1->next;
+   (*slot) = c1->GetObjectPointerAddress();
+   heap()->RecordWrite(slot, *slot);
+   ASSERT_EQ(old_zone()->store_buffer()->size(), 1);
+
+   // the refinement moves the buffered store into the remembered set of the page.
+   ASSERT_EQ(Refiner::Refine(heap(), 16), 1);
+   ASSERT_TRUE(old_zone()->store_buffer()->empty());
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+   ASSERT_EQ(Refiner::GetStats().refined_in_pause(), 0);
+
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 1);
+ }
+
+ TEST_F(ScavengerTest, TestStoreBufferOverflow){
+   LocalPage::ResetLocalPageForCurrentThread();
+   // no concurrent refinement, so the buffer fills up.
+   auto budget = FLAGS_refinement_budget;
+   FLAGS_refinement_budget = 0;
+
+   static constexpr const int64_t kChild1Value = 333;
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   std::vector<RawObject*> roots;
+   for(auto idx = 0; idx <= old_zone()->store_buffer()->capacity(); idx++){
+     auto root = TryAllocateOldNode(old_zone(), idx);
+     auto slot = &((TestNode*)root->GetPointer())->next;
+     (*slot) = c1->GetObjectPointerAddress();
+     heap()->RecordWrite(slot, *slot);
+     roots.push_back(root);
+   }
+   // the store past the capacity of the buffer dirties its card instead.
+   ASSERT_EQ(old_zone()->store_buffer()->size(), old_zone()->store_buffer()->capacity());
+   ASSERT_EQ(old_zone()->cards()->GetNumberOfDirtyCards(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+   ASSERT_EQ(Refiner::GetStats().cards_scanned(), 1);
+   ASSERT_EQ(Refiner::GetStats().refined_in_pause(), old_zone()->store_buffer()->capacity());
+
+   for(auto& root : roots){
+     auto next = GetNext(root);
+     ASSERT_TRUE(IsNew(next));
+     ASSERT_TRUE(IsNode(next, kChild1Value));
+   }
+   FLAGS_refinement_budget = budget;
+ }
+
+ TEST_F(ScavengerTest, TestScavengeWriteWatch){
+   LocalPage::ResetLocalPageForCurrentThread();
+
+   static constexpr const int64_t kRoot1Value = 222;
+   static constexpr const int64_t kChild1Value = 333;
+   auto r1 = Local<TestNode>();
+   r1 = TryAllocateOldNode(old_zone(), kRoot1Value)->GetAddress();
+   auto c1 = TryAllocateNewNode(new_zone(), kChild1Value, nullptr);
+   ASSERT_TRUE(old_zone()->StartWriteWatch());
+
+   // the store doesn't go through the write barrier, it faults & dirties the page of the field.
+   r1->next = c1->GetObjectPointerAddress();
+   ASSERT_TRUE(old_zone()->store_buffer()->empty());
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+   ASSERT_EQ(Refiner::GetStats().cards_scanned(), WriteWatch::GetPageSize() / CardTable::kCardSize);
+   // the old zone is protected again after the scavenge.
+   ASSERT_TRUE(old_zone()->IsWatchingWrites());
+
+   auto next = GetNext(r1.raw());
+   ASSERT_NE(next, c1);
+   ASSERT_TRUE(IsNew(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   ASSERT_EQ(old_zone()->GetNumberOfRememberedSlots(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+   next = GetNext(r1.raw());
+   ASSERT_TRUE(IsOld(next));
+   ASSERT_TRUE(IsNode(next, kChild1Value));
+   old_zone()->StopWriteWatch();
+ }
+
+ TEST_F(ScavengerTest, TestWriteWatchHugePages){
+   // the pages can't be protected one by one w/ huge pages, the write barrier keeps recording the stores.
+   auto huge_pages = FLAGS_huge_pages;
+   FLAGS_huge_pages = "transparent";
+   ASSERT_FALSE(old_zone()->StartWriteWatch());
+   ASSERT_FALSE(old_zone()->IsWatchingWrites());
+   FLAGS_huge_pages = huge_pages;
+ }
+
+ TEST_F(ScavengerTest, TestTenuringThreshold){
+   LocalPage::ResetLocalPageForCurrentThread();
+   SetMaxTenuringThreshold(3);
+
+   static constexpr const int64_t kRoot1Value = 222;
+   auto r1 = Local<word>();
+   r1 = TryAllocateNewWord(new_zone(), kRoot1Value)->GetAddress();
+
+   // the root ages w/ every scavenge it survives, until it reaches the threshold.
+   for(auto age = 1; age <= 3; age++){
+     ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+     ASSERT_TRUE(IsNew(r1));
+     ASSERT_EQ(r1.raw()->GetAge(), age);
+     ASSERT_EQ(Scavenger::GetAgeTable().GetSize(age), r1.raw()->GetTotalSize());
+     ASSERT_EQ(Scavenger::GetTenuringThreshold(), 3);
+   }
+
+   ASSERT_NO_FATAL_FAILURE(SerialScavenge());
+   ASSERT_TRUE(IsOld(r1));
+   ASSERT_TRUE(IsWord(r1, kRoot1Value));
+ }
+
+ TEST_F(ScavengerTest, TestAdaptiveTenuringThreshold){
+   LocalPage::ResetLocalPageForCurrentThread();
+   SetMaxTenuringThreshold(ObjectTag::kMaxAge);
+   // any survivor overflows the target, so the threshold drops to the youngest age.
+   auto ratio = FLAGS_target_survivor_ratio;
+   FLAGS_target_survivor_ratio = 0;
+
+   static constexpr const int64_t kRoot1Value = 222;
+   auto r1 = Local<word>();
+   r1 = TryAllocateNewWord(new_zone(), kRoot1Value)->GetAddress();
+
+   ASSERT_EQ(Scavenger::GetTenuringThreshold(), ObjectTag::kMaxAge);
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+   ASSERT_TRUE(IsNew(r1));
+   ASSERT_EQ(Scavenger::GetTenuringThreshold(), 1);
+
+   ASSERT_NO_FATAL_FAILURE(ParallelScavenge());
+   ASSERT_TRUE(IsOld(r1));
+   ASSERT_TRUE(IsWord(r1, kRoot1Value));
+
+   // nothing survived the last scavenge, so the threshold goes back up to the max.
+   ASSERT_EQ(Scavenger::GetTenuringThreshold(), ObjectTag::kMaxAge);
+   FLAGS_target_survivor_ratio = ratio;
+ }
+
+ TEST_F(ScavengerTest, TestConcurrentProcessObject){
+   static constexpr const int64_t kNumberOfObjects = 1024;
+   static constexpr const int64_t kNumberOfThreads = 4;
+   std::vector<RawObject*> objects;
+   for(auto idx = 0; idx < kNumberOfObjects; idx++)
+     objects.push_back(TryAllocateNewWord(new_zone(), idx));
+
+   // every thread processes every object into its own buffers, only one copy of each may get installed.
+   RelaxedAtomic<int64_t> copies(0);
+   std::vector<std::thread> threads;
+   for(auto idx = 0; idx < kNumberOfThreads; idx++){
+     threads.emplace_back([&, idx](){
+       CopyBuffers buffers(to(), old_zone());
+       for(auto next = 0; next < kNumberOfObjects; next++){
+         auto copied = false;
+         ProcessObject(&buffers, objects[(next * (idx + 1)) % kNumberOfObjects], &copied);
+         if(copied)
+           copies += 1;
+       }
+       buffers.Retire();
+     });
+   }
+   for(auto& thread : threads)
+     thread.join();
+
+   ASSERT_EQ((int64_t)copies, kNumberOfObjects);
+   for(auto idx = 0; idx < kNumberOfObjects; idx++){
+     auto ptr = objects[idx];
+     ASSERT_TRUE(ptr->IsForwarding());
+     auto new_ptr = (RawObject*)ptr->GetForwardingAddress();
+     ASSERT_TRUE(to()->Contains(new_ptr->GetAddress()));
+     ASSERT_TRUE(IsWord(new_ptr, idx));
+     ASSERT_EQ(new_ptr->GetAge(), 1);
+   }
+ }
+}
@@ -14,11 +14,22 @@ namespace poseidon{
   protected:
    Semispace from_;
    Semispace to_;
+   CopyBuffers buffers_;
+   int64_t max_tenuring_threshold_;
 
    explicit ScavengerTest(int64_t size = GetTotalInitialHeapSize()):
     HeapTest(size),
     from_(new_zone()->fromspace(), new_zone()->semisize()),
-    to_(new_zone()->tospace(), new_zone()->semisize()){
+    to_(new_zone()->tospace(), new_zone()->semisize()),
+    buffers_(&to_, old_zone()),
+    max_tenuring_threshold_(FLAGS_max_tenuring_threshold){
+     // unless a test says otherwise, objects get promoted by the second scavenge they survive.
+     SetMaxTenuringThreshold(1);
+   }
+
+   inline void SetMaxTenuringThreshold(int64_t value){
+     FLAGS_max_tenuring_threshold = value;
+     Scavenger::ResetTenuringThreshold();
    }
 
    inline Semispace* from(){
@@ -29,16 +40,24 @@ namespace poseidon{
      return &to_;
    }
 
+   inline CopyBuffers* buffers(){
+     return &buffers_;
+   }
+
    inline RawObject* ScavengeObject(RawObject* ptr){
-     return (RawObject*)Scavenger::ScavengeObject(to(), ptr);
+     return (RawObject*)Scavenger::ScavengeObject(buffers(), ptr, ptr->tag());
    }
 
    inline RawObject* PromoteObject(RawObject* ptr){
-     return (RawObject*)Scavenger::PromoteObject(old_zone(), ptr);
+     return (RawObject*)Scavenger::PromoteObject(buffers(), ptr, ptr->tag());
    }
 
-   inline RawObject* ProcessObject(RawObject* ptr){
-     return (RawObject*)Scavenger::ProcessObject(to(), old_zone(), ptr);
+   inline RawObject* ProcessObject(RawObject* ptr, bool* copied = nullptr){
+     return (RawObject*)Scavenger::ProcessObject(buffers(), ptr, copied);
+   }
+
+   inline RawObject* ProcessObject(CopyBuffers* buffers, RawObject* ptr, bool* copied = nullptr){
+     return (RawObject*)Scavenger::ProcessObject(buffers, ptr, copied);
    }
 
    inline void SerialScavenge(){
@@ -46,10 +65,14 @@ namespace poseidon{
    }
 
    inline void ParallelScavenge(){
-     return Scavenger::Scavenge(heap(), true);
+     Scavenger::Scavenge(heap(), true);
+     // the evacuated space is cleared by the workers after the scavenge.
+     new_zone()->WaitForToSpace();
    }
   public:
-   ~ScavengerTest() override = default;
+   ~ScavengerTest() override{
+     SetMaxTenuringThreshold(max_tenuring_threshold_);
+   }
  };
 }
 
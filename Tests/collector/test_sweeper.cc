@@ -2,68 +2,84 @@
 #include "collector/test_sweeper.h"
 
 namespace poseidon{
- TEST_F(SweeperTest, TestSweepObject){
+ TEST_F(SweeperTest, TestSweepPage){
+   auto page = zone()->pages(5);
+
    static constexpr const int64_t kPtr1Value = 10;
-   auto p1 = TryAllocateMarkedWord(zone(), kPtr1Value);
+   auto p1 = TryAllocateMarkedWord(page, kPtr1Value);
    ASSERT_TRUE(IsAllocated(p1));
-   ASSERT_FALSE(IsNew(p1));
    ASSERT_TRUE(IsOld(p1));
-   ASSERT_TRUE(IsMarked(p1));
-   ASSERT_FALSE(IsRemembered(p1));
-   ASSERT_FALSE(IsForwarding(p1));
-   ASSERT_TRUE(IsWord(p1, kPtr1Value));
+   ASSERT_TRUE(IsMarked(page, p1));
+   // the mark is kept in the bitmap of the page, not in the header.
+   ASSERT_FALSE(p1->IsMarked());
 
    static constexpr const int64_t kPtr2Value = 10000;
-   auto p2 = TryAllocateNewWord(zone(), kPtr2Value);
+   auto p2 = TryAllocateNewWord(page, kPtr2Value);
    ASSERT_TRUE(IsAllocated(p2));
-   ASSERT_FALSE(IsNew(p2));
    ASSERT_TRUE(IsOld(p2));
-   ASSERT_FALSE(IsMarked(p2));
-   ASSERT_FALSE(IsRemembered(p2));
-   ASSERT_FALSE(IsForwarding(p2));
-   ASSERT_TRUE(IsWord(p2, kPtr2Value));
+   ASSERT_FALSE(IsMarked(page, p2));
 
-   // should do nothing to p1 since it is marked.
-   ASSERT_NO_FATAL_FAILURE(SweepObject(p1));
-   ASSERT_TRUE(IsAllocated(p1));
-   ASSERT_FALSE(IsNew(p1));
-   ASSERT_TRUE(IsOld(p1));
-   ASSERT_TRUE(IsMarked(p1));
-   ASSERT_FALSE(IsRemembered(p1));
-   ASSERT_FALSE(IsForwarding(p1));
-   ASSERT_TRUE(IsWord(p1, kPtr1Value));
+   static constexpr const int64_t kPtr3Value = 100;
+   auto p3 = TryAllocateMarkedWord(page, kPtr3Value);
+   ASSERT_TRUE(IsMarked(page, p3));
 
-   // should finalize p2 since it is not marked.
-   ASSERT_NO_FATAL_FAILURE(SweepObject(p2));
-   ASSERT_TRUE(IsAllocated(p2));
-   ASSERT_FALSE(IsNew(p2));
-   ASSERT_TRUE(IsOld(p2));
-   ASSERT_FALSE(IsMarked(p2));
-   ASSERT_FALSE(IsRemembered(p2));
-   ASSERT_FALSE(IsForwarding(p2));
-   ASSERT_EQ(p2->GetPointerSize(), 0);
+   auto free = free_list()->GetTotalBytesFree();
+   ASSERT_NO_FATAL_FAILURE(SweepPage(page));
+
+   // the marked objects are left alone.
+   ASSERT_TRUE(IsMarkedWord(page, p1, kPtr1Value));
+   ASSERT_TRUE(IsMarkedWord(page, p3, kPtr3Value));
+   ASSERT_FALSE(p1->IsFree());
+   ASSERT_FALSE(p3->IsFree());
+
+   // p2 & the rest of the page after p3 become free blocks.
+   ASSERT_TRUE(p2->IsFree());
+   auto tail = static_cast<int64_t>(page->GetEndingAddress() - (p3->GetAddress() + p3->GetTotalSize()));
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), free + p2->GetTotalSize() + tail);
+ }
+
+ TEST_F(SweeperTest, TestSweepEmptyPage){
+   auto page = zone()->pages(6);
+   auto garbage = TryAllocateNewWord(page, 100);
+   ASSERT_TRUE(IsAllocated(garbage));
+   ASSERT_FALSE(IsMarked(page, garbage));
+
+   // the page isn't added to the free list, the zone decides what happens to it.
+   auto free = free_list()->GetTotalBytesFree();
+   ASSERT_NO_FATAL_FAILURE(SweepPage(page));
+   ASSERT_TRUE(page->IsEmpty());
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), free);
  }
- 
+
  TEST_F(SweeperTest, TestSerialSweep){
    static constexpr const int64_t kRoot1Value = 222;
    auto r1 = Local<word>();
    r1 = TryAllocateMarkedWord(zone(), kRoot1Value)->GetAddress();
-   ASSERT_TRUE(IsMarkedWord(r1, kRoot1Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r1, kRoot1Value));
 
    static constexpr const int64_t kRoot2Value = 333;
    auto r2 = Local<word>();
    r2 = TryAllocateMarkedWord(zone(), kRoot2Value)->GetAddress();
-   ASSERT_TRUE(IsMarkedWord(r2, kRoot2Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r2, kRoot2Value));
 
    static constexpr const int64_t kRoot3Value = 444;
    auto r3 = Local<word>();
    r3 = TryAllocateMarkedWord(zone(), kRoot3Value)->GetAddress();
-   ASSERT_TRUE(IsMarkedWord(r3, kRoot3Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r3, kRoot3Value));
+
+   auto garbage = TryAllocateNewWord(zone(), 555);
+   ASSERT_FALSE(IsMarked(zone(), garbage));
 
    ASSERT_NO_FATAL_FAILURE(SerialSweep());
+   // the empty pages are handed back by the zone.
+   ASSERT_EQ(zone()->Shrink(), 0);
 
-   ASSERT_TRUE(IsMarkedWord(r1, kRoot1Value));
-   ASSERT_TRUE(IsMarkedWord(r2, kRoot2Value));
-   ASSERT_TRUE(IsMarkedWord(r3, kRoot3Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r1, kRoot1Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r2, kRoot2Value));
+   ASSERT_TRUE(IsMarkedWord(zone(), r3, kRoot3Value));
+   ASSERT_TRUE(garbage->IsFree());
+   // the free list is rebuilt from the marks, everything but the marked objects is free.
+   auto live = r1.raw()->GetTotalSize() + r2.raw()->GetTotalSize() + r3.raw()->GetTotalSize();
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), zone()->GetSize() - live);
  }
-}
\ No newline at end of file
+}
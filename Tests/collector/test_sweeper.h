@@ -44,8 +44,8 @@ namespace poseidon{
    }
 
    inline void
-   SweepObject(RawObject* ptr){
-     return Sweeper::SweepObject(free_list(), ptr);
+   SweepPage(OldPage* page){
+     return Sweeper::SweepPage(free_list(), page);
    }
 
    inline void
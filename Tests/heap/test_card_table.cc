@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "poseidon/heap/card_table.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class CardTableTest : public Test{
+  protected:
+   static constexpr const uword kTestStartingAddress = 0x100000;
+   static constexpr const int64_t kTestSize = 64 * CardTable::kCardSize;
+
+   CardTable table_;
+
+   CardTableTest():
+    Test(),
+    table_(kTestStartingAddress, kTestSize){
+   }
+
+   inline CardTable& table(){
+     return table_;
+   }
+  public:
+   ~CardTableTest() override = default;
+ };
+
+ TEST_F(CardTableTest, TestConstructor){
+   ASSERT_EQ(table().GetNumberOfCards(), 64);
+   ASSERT_EQ(table().GetNumberOfDirtyCards(), 0);
+   ASSERT_FALSE(table().HasDirtyCards(kTestStartingAddress, kTestStartingAddress + kTestSize));
+ }
+
+ TEST_F(CardTableTest, TestDirty){
+   auto address = kTestStartingAddress + (3 * CardTable::kCardSize) + kWordSize;
+   table().Dirty(address);
+   ASSERT_TRUE(table().IsDirty(address));
+   ASSERT_TRUE(table().IsDirty(kTestStartingAddress + (3 * CardTable::kCardSize)));
+   ASSERT_FALSE(table().IsDirty(kTestStartingAddress + (4 * CardTable::kCardSize)));
+   ASSERT_EQ(table().GetNumberOfDirtyCards(), 1);
+   ASSERT_EQ(table().GetLastDirtyCardEnd(kTestStartingAddress, kTestStartingAddress + kTestSize), kTestStartingAddress + (4 * CardTable::kCardSize));
+
+   table().Clean(kTestStartingAddress, kTestStartingAddress + kTestSize);
+   ASSERT_FALSE(table().IsDirty(address));
+   ASSERT_EQ(table().GetLastDirtyCardEnd(kTestStartingAddress, kTestStartingAddress + kTestSize), 0);
+ }
+}
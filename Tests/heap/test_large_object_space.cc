@@ -0,0 +1,101 @@
+#include <unistd.h>
+#include <thread>
+#include <future>
+
+#include "helpers.h"
+#include "heap/test_large_object_space.h"
+
+namespace poseidon{
+ TEST_F(LargeObjectSpaceTest, TestTryAllocate){
+   auto size = GetLargeObjectSize();
+   auto ptr = (RawObject*)space()->TryAllocate(size);
+   ASSERT_TRUE(IsAllocated(ptr));
+   ASSERT_FALSE(IsNew(ptr));
+   ASSERT_TRUE(IsOld(ptr));
+   ASSERT_FALSE(IsMarked(ptr));
+   ASSERT_FALSE(IsForwarding(ptr));
+   ASSERT_EQ(ptr->GetPointerSize(), size);
+   ASSERT_TRUE(IsAligned(ptr->GetAddress(), sysconf(_SC_PAGESIZE)));
+
+   ASSERT_TRUE(space()->Contains(ptr->GetAddress()));
+   ASSERT_TRUE(space()->Contains(ptr->GetObjectPointerAddress() + size - 1));
+   ASSERT_FALSE(space()->Contains(ptr->GetAddress() - 1));
+   ASSERT_EQ(space()->GetNumberOfObjects(), 1);
+   ASSERT_EQ(space()->GetNumberOfBytesAllocated(), LargeObjectSpace::GetMappingSizeFor(size));
+
+   // the whole object is writable.
+   memset(ptr->GetPointer(), 0xFF, size);
+ }
+
+ TEST_F(LargeObjectSpaceTest, TestSweep){
+   auto size = GetLargeObjectSize();
+   auto p1 = (RawObject*)space()->TryAllocate(size);
+   ASSERT_TRUE(IsAllocated(p1));
+   p1->SetMarkedBit();
+
+   auto p2 = (RawObject*)space()->TryAllocate(size);
+   ASSERT_TRUE(IsAllocated(p2));
+   auto p2_address = p2->GetAddress();
+   ASSERT_EQ(space()->GetNumberOfObjects(), 2);
+
+   int64_t num_freed = 0;
+   ASSERT_EQ(space()->Sweep(&num_freed), LargeObjectSpace::GetMappingSizeFor(size));
+   ASSERT_EQ(num_freed, 1);
+   ASSERT_EQ(space()->GetNumberOfObjects(), 1);
+   ASSERT_TRUE(space()->Contains(p1->GetAddress()));
+   ASSERT_FALSE(space()->Contains(p2_address));
+
+   // the survivor has to be marked again in the next epoch to survive the next sweep.
+   ASSERT_TRUE(IsMarked(p1));
+   MarkEpoch::Flip();
+   ASSERT_FALSE(IsMarked(p1));
+   ASSERT_EQ(space()->Sweep(), LargeObjectSpace::GetMappingSizeFor(size));
+   ASSERT_TRUE(space()->IsEmpty());
+   ASSERT_EQ(space()->GetNumberOfBytesAllocated(), 0);
+ }
+
+ TEST_F(LargeObjectSpaceTest, TestIsReserved){
+   auto size = GetLargeObjectSize();
+   auto ptr = (RawObject*)space()->TryAllocate(size);
+   ASSERT_TRUE(IsAllocated(ptr));
+   ASSERT_TRUE(space()->IsReserved(ptr->GetAddress()));
+   ASSERT_TRUE(space()->IsReserved(ptr->GetObjectPointerAddress() + size - 1));
+   ASSERT_FALSE(space()->IsReserved((uword)&size));
+   ASSERT_FALSE(space()->IsReserved(space()->reserved().GetEndingAddress()));
+ }
+
+ TEST_F(LargeObjectSpaceTest, TestTryAllocateExhausted){
+   auto size = GetLargeObjectSize();
+   auto mapping_size = LargeObjectSpace::GetMappingSizeFor(size);
+   auto space = new LargeObjectSpace(mapping_size);
+   ASSERT_NE(space->TryAllocate(size), 0);
+   // the failure is logged, which prints the space. It runs on another thread, so a deadlock fails the test.
+   auto result = std::make_shared<std::promise<uword>>();
+   auto address = result->get_future();
+   std::thread([space, size, result](){
+     result->set_value(space->TryAllocate(size));
+   }).detach();
+   ASSERT_EQ(address.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+   ASSERT_EQ(address.get(), 0);
+   ASSERT_EQ(space->GetNumberOfObjects(), 1);
+   delete space;
+ }
+
+ TEST_F(LargeObjectSpaceTest, TestSweepReusesRange){
+   auto size = GetLargeObjectSize();
+   auto mapping_size = LargeObjectSpace::GetMappingSizeFor(size);
+   LargeObjectSpace space(2 * mapping_size);
+   auto p1 = space.TryAllocate(size);
+   auto p2 = space.TryAllocate(size);
+   ASSERT_NE(p1, 0);
+   ASSERT_NE(p2, 0);
+   // the reserved range is exhausted.
+   ASSERT_EQ(space.TryAllocate(size), 0);
+
+   MarkEpoch::Flip();
+   ASSERT_EQ(space.Sweep(), 2 * mapping_size);
+   // the freed runs are merged, so an object of both their sizes fits.
+   auto p3 = space.TryAllocate((2 * mapping_size) - static_cast<int64_t>(sizeof(RawObject)));
+   ASSERT_EQ(p3, space.reserved().GetStartingAddress());
+ }
+}
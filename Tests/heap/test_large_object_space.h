@@ -0,0 +1,25 @@
+#ifndef POSEIDON_TEST_LARGE_OBJECT_SPACE_H
+#define POSEIDON_TEST_LARGE_OBJECT_SPACE_H
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "poseidon/heap/large_object_space.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class LargeObjectSpaceTest : public Test{
+  protected:
+   LargeObjectSpace space_;
+
+   inline LargeObjectSpace* space(){
+     return &space_;
+   }
+  public:
+   LargeObjectSpaceTest() = default;
+   ~LargeObjectSpaceTest() override = default;
+ };
+}
+
+#endif//POSEIDON_TEST_LARGE_OBJECT_SPACE_H
@@ -0,0 +1,98 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "poseidon/heap/mark_bitmap.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class MarkBitmapTest : public Test{
+  protected:
+   static constexpr const uword kTestStartingAddress = 0x100000;
+   static constexpr const int64_t kTestSize = 4 * kBitsPerWord * kWordSize;
+
+   std::vector<uword> bits_;
+   MarkBitmap marks_;
+
+   MarkBitmapTest():
+    Test(),
+    bits_(MarkBitmap::GetSizeInWords(kTestSize), 0),
+    marks_(kTestStartingAddress, kTestSize, bits_.data()){
+   }
+
+   inline MarkBitmap& marks(){
+     return marks_;
+   }
+
+   static inline uword
+   GetAddress(int64_t word){
+     return kTestStartingAddress + (word * kWordSize);
+   }
+  public:
+   ~MarkBitmapTest() override = default;
+ };
+
+ TEST_F(MarkBitmapTest, TestTryMark){
+   // the bits are preceded by their epoch.
+   ASSERT_EQ(marks().GetSizeInWords(), 1 + 4);
+   ASSERT_FALSE(marks().IsMarked(GetAddress(3)));
+   ASSERT_TRUE(marks().TryMark(GetAddress(3)));
+   ASSERT_TRUE(marks().IsMarked(GetAddress(3)));
+   // only the first marker wins.
+   ASSERT_FALSE(marks().TryMark(GetAddress(3)));
+   ASSERT_FALSE(marks().IsMarked(GetAddress(2)));
+   ASSERT_FALSE(marks().IsMarked(GetAddress(4)));
+ }
+
+ TEST_F(MarkBitmapTest, TestFindNextMarked){
+   marks().Mark(GetAddress(1));
+   marks().Mark(GetAddress(kBitsPerWord + 2));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(0)), GetAddress(1));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(1)), GetAddress(1));
+   // the next mark is in the next word of the bitmap.
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(2)), GetAddress(kBitsPerWord + 2));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(kBitsPerWord + 3)), marks().GetEndingAddress());
+   ASSERT_EQ(marks().FindNextMarked(marks().GetEndingAddress()), marks().GetEndingAddress());
+ }
+
+ TEST_F(MarkBitmapTest, TestVisitMarked){
+   std::vector<uword> expected = { GetAddress(0), GetAddress(63), GetAddress(64), GetAddress(255) };
+   for(auto& address : expected)
+     marks().Mark(address);
+
+   std::vector<uword> visited;
+   marks().VisitMarked([&](uword address){
+     visited.push_back(address);
+     return true;
+   });
+   ASSERT_EQ(visited, expected);
+ }
+
+ TEST_F(MarkBitmapTest, TestClear){
+   marks().Mark(GetAddress(0));
+   marks().Mark(GetAddress(200));
+   marks().Clear();
+   ASSERT_FALSE(marks().IsMarked(GetAddress(0)));
+   ASSERT_FALSE(marks().IsMarked(GetAddress(200)));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(0)), marks().GetEndingAddress());
+ }
+
+ TEST_F(MarkBitmapTest, TestFlipEpoch){
+   marks().Mark(GetAddress(0));
+   marks().Mark(GetAddress(200));
+   ASSERT_TRUE(marks().IsCurrent());
+   MarkEpoch::Flip();
+   // the marks of the previous epoch are gone w/o touching the bits.
+   ASSERT_FALSE(marks().IsCurrent());
+   ASSERT_FALSE(marks().IsMarked(GetAddress(0)));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(0)), marks().GetEndingAddress());
+
+   // the first mark of the new epoch clears the stale bits.
+   ASSERT_TRUE(marks().TryMark(GetAddress(3)));
+   ASSERT_EQ(marks().GetEpoch(), MarkEpoch::Get());
+   ASSERT_FALSE(marks().IsMarked(GetAddress(200)));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(0)), GetAddress(3));
+   ASSERT_EQ(marks().FindNextMarked(GetAddress(4)), marks().GetEndingAddress());
+ }
+}
@@ -1,3 +1,5 @@
+#include <thread>
+
 #include "helpers.h"
 #include "helpers/assertions.h"
 #include "heap/test_new_zone.h"
@@ -56,4 +58,82 @@ namespace poseidon{
      .Times(kNumberOfMarkedPointers);
    ASSERT_NO_FATAL_FAILURE(zone()->VisitMarkedPointers(&visitor));
  }
-}
\ No newline at end of file
+ 
+ TEST_F(NewZoneTest, TestTryRefill){
+   static const constexpr word kDefaultWordValue = 42;
+   LocalAllocationBuffer buffer;
+   ASSERT_FALSE(buffer.HasOwner());
+   ASSERT_EQ(buffer.TryAllocate(kWordSize), 0);
+
+   ASSERT_TRUE(zone()->TryRefill(&buffer, kWordSize));
+   ASSERT_EQ(buffer.owner(), zone());
+   ASSERT_EQ(buffer.GetSize(), GetLocalAllocationBufferSize());
+   ASSERT_TRUE(from()->Contains(buffer.GetStartingAddress()));
+
+   auto ptr = (RawObject*)buffer.TryAllocate(kWordSize);
+   ASSERT_TRUE(IsAllocated(ptr));
+   *((word*)ptr->GetPointer()) = kDefaultWordValue;
+   ASSERT_TRUE(IsNewWord(ptr, kDefaultWordValue));
+   ASSERT_TRUE(buffer.Contains(ptr->GetAddress()));
+
+   // the zone bumps past the buffer, not the object.
+   auto next = TryAllocateNewWord(zone(), kDefaultWordValue);
+   ASSERT_TRUE(IsAllocated(next));
+   ASSERT_FALSE(buffer.Contains(next->GetAddress()));
+
+   zone()->Release(&buffer);
+   ASSERT_FALSE(buffer.HasOwner());
+   ASSERT_EQ(buffer.TryAllocate(kWordSize), 0);
+ }
+
+ TEST_F(NewZoneTest, TestSwapSpacesRetiresBuffers){
+   LocalAllocationBuffer buffer;
+   ASSERT_TRUE(zone()->TryRefill(&buffer, kWordSize));
+   ASSERT_NE(buffer.TryAllocate(kWordSize), 0);
+
+   // the buffer is emptied, the owner doesn't allocate into the evacuated space.
+   SwapSpaces();
+   ASSERT_EQ(buffer.GetSize(), 0);
+   ASSERT_EQ(buffer.TryAllocate(kWordSize), 0);
+
+   ASSERT_TRUE(zone()->TryRefill(&buffer, kWordSize));
+   auto ptr = buffer.TryAllocate(kWordSize);
+   ASSERT_NE(ptr, 0);
+   ASSERT_TRUE(to()->Contains(ptr));
+   zone()->Release(&buffer);
+ }
+
+ TEST_F(NewZoneTest, TestTryRefillTooLarge){
+   LocalAllocationBuffer buffer;
+   ASSERT_FALSE(zone()->TryRefill(&buffer, GetLocalAllocationBufferSize()));
+   ASSERT_FALSE(buffer.HasOwner());
+ }
+ 
+ TEST_F(NewZoneTest, TestReleaseToSpace){
+   static const constexpr word kDefaultWordValue = 42;
+   auto address = to()->GetStartingAddress();
+   *((word*)address) = kDefaultWordValue;
+
+   // the to-space is only released once every few scavenges, it has to be cleared otherwise.
+   for(auto idx = 1; idx < GetMemoryReleaseDelay(); idx++)
+     ASSERT_FALSE(zone()->ReleaseToSpace());
+   ASSERT_TRUE(zone()->ReleaseToSpace());
+   ASSERT_EQ(*((word*)address), 0);
+ }
+
+ TEST_F(NewZoneTest, TestClearToSpace){
+   static const constexpr word kDefaultWordValue = 42;
+   auto address = to()->GetStartingAddress();
+   *((word*)address) = kDefaultWordValue;
+
+   zone()->SetClearingToSpace();
+   ASSERT_TRUE(zone()->IsClearingToSpace());
+   std::thread clearing([this](){
+     zone()->ClearToSpace();
+   });
+   zone()->WaitForToSpace();
+   ASSERT_FALSE(zone()->IsClearingToSpace());
+   ASSERT_EQ(*((word*)address), 0);
+   clearing.join();
+ }
+}
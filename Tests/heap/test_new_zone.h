@@ -29,6 +29,10 @@ namespace poseidon{
    inline Semispace* to(){
      return &to_;
    }
+
+   inline void SwapSpaces(){
+     zone()->SwapSpaces();
+   }
   public:
    NewZoneTest():
     MemoryRegionTest(GetNewZoneSize()),
@@ -9,7 +9,7 @@ namespace poseidon{
    ASSERT_TRUE(IsAllocated(ptr));
    ASSERT_FALSE(IsNew(ptr));
    ASSERT_TRUE(IsOld(ptr));
-   ASSERT_FALSE(IsMarked(ptr));
+   ASSERT_FALSE(IsMarked(&page_, ptr));
    ASSERT_FALSE(IsRemembered(ptr));
    ASSERT_FALSE(IsForwarding(ptr));
    ASSERT_EQ(ptr->GetPointerSize(), kWordSize);
@@ -37,7 +37,7 @@ namespace poseidon{
      ASSERT_TRUE(IsAllocated(ptr));
      ASSERT_TRUE(page_.Contains(ptr->GetAddress()));
      ASSERT_TRUE(IsWord(ptr, idx));
-     ASSERT_FALSE(IsMarked(ptr));
+     ASSERT_FALSE(IsMarked(&page_, ptr));
    }
 
    for(auto idx = 0; idx < kNumberOfMarkedPointers; idx++){
@@ -45,7 +45,7 @@ namespace poseidon{
      ASSERT_TRUE(IsAllocated(ptr));
      ASSERT_TRUE(page_.Contains(ptr->GetAddress()));
      ASSERT_TRUE(IsWord(ptr, idx));
-     ASSERT_TRUE(IsMarked(ptr));
+     ASSERT_TRUE(IsMarked(&page_, ptr));
    }
 
    MockRawObjectVisitor visitor;
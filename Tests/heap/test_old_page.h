@@ -1,6 +1,7 @@
 #ifndef POSEIDON_TEST_OLD_PAGE_H
 #define POSEIDON_TEST_OLD_PAGE_H
 
+#include <vector>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -13,11 +14,13 @@ namespace poseidon{
 
  class OldPageTest : public MemoryRegionTest{
   protected:
+   std::vector<uword> marks_;
    OldPage page_;
   public:
    OldPageTest():
      MemoryRegionTest(GetOldPageSize()),
-     page_(nullptr, region()){
+     marks_(MarkBitmap::GetSizeInWords(GetOldPageSize()), 0),
+     page_(nullptr, region(), marks_.data()){
    }
    ~OldPageTest() override = default;
  };
@@ -1,3 +1,6 @@
+#include <unistd.h>
+#include <sys/mman.h>
+
 #include "helpers.h"
 #include "heap/test_old_zone.h"
 
@@ -8,7 +11,7 @@ namespace poseidon{
    ASSERT_TRUE(IsAllocated(ptr));
    ASSERT_FALSE(IsNew(ptr));
    ASSERT_TRUE(IsOld(ptr));
-   ASSERT_FALSE(IsMarked(ptr));
+   ASSERT_FALSE(IsMarked(zone(), ptr));
    ASSERT_FALSE(IsRemembered(ptr));
    ASSERT_FALSE(IsForwarding(ptr));
    ASSERT_TRUE(IsWord(ptr, kDefaultWordValue));
@@ -20,7 +23,7 @@ namespace poseidon{
    ASSERT_TRUE(IsAllocated(p1));
    ASSERT_TRUE(IsOld(p1));
    ASSERT_TRUE(IsWord(p1, kDefaultValue));
-   ASSERT_FALSE(IsMarked(p1));
+   ASSERT_FALSE(IsMarked(zone(), p1));
    ASSERT_FALSE(IsRemembered(p1));
    ASSERT_FALSE(IsForwarding(p1));
 
@@ -29,7 +32,7 @@ namespace poseidon{
    ASSERT_TRUE(IsAllocated(p2));
    ASSERT_TRUE(IsOld(p2));
    ASSERT_TRUE(IsWord(p2, kDefaultValue));
-   ASSERT_FALSE(IsMarked(p2));
+   ASSERT_FALSE(IsMarked(zone(), p2));
    ASSERT_FALSE(IsRemembered(p2));
    ASSERT_FALSE(IsForwarding(p2));
 
@@ -59,7 +62,7 @@ namespace poseidon{
      ASSERT_TRUE(IsAllocated(ptr));
      ASSERT_TRUE(zone()->Contains(ptr->GetAddress()));
      ASSERT_TRUE(IsWord(ptr, idx));
-     ASSERT_FALSE(IsMarked(ptr));
+     ASSERT_FALSE(IsMarked(zone(), ptr));
    }
 
    for(auto idx = 0; idx < kNumberOfMarkedPointers; idx++){
@@ -67,7 +70,7 @@ namespace poseidon{
      ASSERT_TRUE(IsAllocated(ptr));
      ASSERT_TRUE(zone()->Contains(ptr->GetAddress()));
      ASSERT_TRUE(IsWord(ptr, idx));
-     ASSERT_TRUE(IsMarked(ptr));
+     ASSERT_TRUE(IsMarked(zone(), ptr));
    }
 
    MockRawObjectVisitor visitor;
@@ -75,4 +78,61 @@ namespace poseidon{
      .Times(kNumberOfMarkedPointers);
    ASSERT_NO_FATAL_FAILURE(zone()->VisitMarkedPointers(&visitor));
  }
-}
\ No newline at end of file
+ 
+ TEST_F(OldZoneTest, TestGrow){
+   auto page_size = GetOldPageSize();
+   auto committed = zone()->GetCommittedSize();
+   ASSERT_EQ(committed, GetOldZoneCommittedSize());
+   ASSERT_EQ(zone()->free_list()->GetTotalBytesFree(), committed);
+
+   auto next = zone()->pages(committed / page_size);
+   ASSERT_FALSE(zone()->IsCommitted(next));
+   ASSERT_EQ(zone()->Grow(kWordSize), page_size);
+   ASSERT_TRUE(zone()->IsCommitted(next));
+   ASSERT_EQ(zone()->GetCommittedSize(), committed + page_size);
+   ASSERT_EQ(zone()->free_list()->GetTotalBytesFree(), committed + page_size);
+ }
+
+ TEST_F(OldZoneTest, TestShrink){
+   static const constexpr word kDefaultWordValue = 42;
+   auto page_size = GetOldPageSize();
+   auto ptr = TryAllocateNewWord(zone(), kDefaultWordValue);
+   ASSERT_TRUE(IsAllocated(ptr));
+   zone()->Mark(ptr);
+   ASSERT_EQ(zone()->Grow(page_size), page_size);
+
+   // only the empty pages above the committed minimum get decommitted, once they stayed empty for a while.
+   for(auto idx = 1; idx < GetMemoryReleaseDelay(); idx++)
+     ASSERT_EQ(SweepAndShrink(), 0);
+   ASSERT_EQ(SweepAndShrink(), page_size);
+   ASSERT_EQ(zone()->GetCommittedSize(), GetOldZoneCommittedSize());
+   ASSERT_EQ(zone()->free_list()->GetTotalBytesFree(), zone()->GetCommittedSize() - ptr->GetTotalSize());
+   ASSERT_TRUE(zone()->IsCommitted(zone()->pages(zone()->GetPageIndexFor(ptr->GetAddress()))));
+   ASSERT_TRUE(IsWord(ptr, kDefaultWordValue));
+ }
+
+#ifdef OS_IS_LINUX
+ static inline bool
+ IsResident(uword address){
+   static const int64_t kSystemPageSize = sysconf(_SC_PAGESIZE);
+   unsigned char resident = 0;
+   auto start = address & ~(kSystemPageSize - 1);
+   return mincore((void*)start, kSystemPageSize, &resident) == 0
+       && (resident & 1) != 0;
+ }
+
+ TEST_F(OldZoneTest, TestShrinkReleasesEmptyPages){
+   auto page = zone()->pages(0);
+   auto address = page->GetStartingAddress() + (page->GetSize() / 2);
+   *((word*)address) = 42;
+   ASSERT_TRUE(IsResident(address));
+
+   for(auto idx = 0; idx < GetMemoryReleaseDelay(); idx++)
+     ASSERT_EQ(SweepAndShrink(), 0);
+   ASSERT_EQ(page->GetIdleCount(), GetMemoryReleaseDelay());
+   ASSERT_FALSE(IsResident(address));
+   ASSERT_TRUE(zone()->IsCommitted(page));
+   ASSERT_EQ(zone()->free_list()->GetTotalBytesFree(), zone()->GetCommittedSize());
+ }
+#endif//OS_IS_LINUX
+}
@@ -6,6 +6,7 @@
 
 #include "memory_region_test.h"
 #include "poseidon/heap/old_zone.h"
+#include "poseidon/collector/sweeper.h"
 
 namespace poseidon{
  using namespace ::testing;
@@ -17,6 +18,13 @@ namespace poseidon{
    inline OldZone* zone(){
      return &zone_;
    }
+
+   // the zone only shrinks by the pages the sweeper found empty.
+   inline int64_t SweepAndShrink(){
+     SerialSweeper sweeper(zone());
+     sweeper.Sweep();
+     return zone()->Shrink();
+   }
   public:
    explicit OldZoneTest(int64_t size = GetOldZoneSize()):
      MemoryRegionTest(size),
@@ -55,4 +55,17 @@ namespace poseidon{
     .Times(kNumberOfMarkedPointers);
    ASSERT_NO_FATAL_FAILURE(semispace_.VisitMarkedObjects(&visitor));
  }
+
+ TEST_F(SemispaceTest, TestTryRetract){
+   auto p1 = TryAllocateNewWord(&semispace_, 1);
+   auto p2 = TryAllocateNewWord(&semispace_, 2);
+   ASSERT_TRUE(IsAllocated(p2));
+
+   // only the last allocation can be taken back.
+   ASSERT_FALSE(semispace_.TryRetract(p1));
+   ASSERT_TRUE(semispace_.TryRetract(p2));
+   ASSERT_EQ(semispace_.GetCurrentAddress(), p2->GetAddress());
+   ASSERT_TRUE(semispace_.TryRetract(p1));
+   ASSERT_TRUE(semispace_.IsEmpty());
+ }
 }
\ No newline at end of file
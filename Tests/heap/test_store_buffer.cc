@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "poseidon/heap/store_buffer.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class StoreBufferTest : public Test{
+  public:
+   StoreBufferTest() = default;
+   ~StoreBufferTest() override = default;
+ };
+
+ TEST_F(StoreBufferTest, TestConstructor){
+   StoreBuffer buffer(5);
+   ASSERT_EQ(buffer.capacity(), 8);
+   ASSERT_EQ(buffer.size(), 0);
+   ASSERT_TRUE(buffer.empty());
+ }
+
+ TEST_F(StoreBufferTest, TestPushAndPop){
+   StoreBuffer buffer(4);
+   ASSERT_TRUE(buffer.Push(0x1000));
+   ASSERT_TRUE(buffer.Push(0x1008));
+   ASSERT_EQ(buffer.size(), 2);
+
+   uword slot;
+   ASSERT_TRUE(buffer.Pop(&slot));
+   ASSERT_EQ(slot, 0x1000);
+   ASSERT_TRUE(buffer.Pop(&slot));
+   ASSERT_EQ(slot, 0x1008);
+   ASSERT_FALSE(buffer.Pop(&slot));
+ }
+
+ TEST_F(StoreBufferTest, TestPushRepeated){
+   StoreBuffer buffer(4);
+   ASSERT_TRUE(buffer.Push(0x1000));
+   ASSERT_TRUE(buffer.Push(0x1000));
+   ASSERT_EQ(buffer.size(), 1);
+
+   // once the field was drained, it has to be buffered again.
+   uword slot;
+   ASSERT_TRUE(buffer.Pop(&slot));
+   ASSERT_TRUE(buffer.Push(0x1000));
+   ASSERT_EQ(buffer.size(), 1);
+ }
+
+ TEST_F(StoreBufferTest, TestPushFull){
+   StoreBuffer buffer(4);
+   for(auto idx = 0; idx < buffer.capacity(); idx++)
+     ASSERT_TRUE(buffer.Push(0x1000 + (idx * kWordSize)));
+   ASSERT_FALSE(buffer.Push(0x2000));
+   ASSERT_EQ(buffer.size(), buffer.capacity());
+ }
+}
@@ -77,6 +77,23 @@ namespace poseidon{
    return val;
  }
 
+ // the old objects are marked in the mark bitmaps of their pages instead of their headers.
+ static inline RawObject*
+ TryAllocateMarkedWord(OldPage* page, word value = 0){
+   auto val = TryAllocateNewWord(page, value);
+   if(val != nullptr)
+     page->Mark(val);
+   return val;
+ }
+
+ static inline RawObject*
+ TryAllocateMarkedWord(OldZone* zone, word value = 0){
+   auto val = TryAllocateNewWord(zone, value);
+   if(val != nullptr)
+     zone->Mark(val);
+   return val;
+ }
+
  template<class S>
  static inline RawObject*
  TryAllocateNewRememberedWord(S* section, word value = 0){
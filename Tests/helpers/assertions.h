@@ -26,7 +26,7 @@ namespace poseidon{
  IsUnallocated(RawObject* val){
    if(!val)
      return AssertionSuccess();
-   if(val->GetPointerSize() != 0)
+   if(val->GetPointerSize() != 0 && !val->IsFree())
      return AssertionFailure() << val->ToString() << " is allocated.";
 
    return AssertionSuccess();
@@ -77,6 +77,21 @@ namespace poseidon{
    return IsMarked(val.raw());
  }
 
+ // the old objects are marked in the mark bitmaps of their pages.
+ template<class S>
+ static inline AssertionResult
+ IsMarked(S* section, RawObject* val){
+   if(!section->IsMarked(val))
+     return AssertionFailure() << "Expected " << val->ToString() << " to be marked.";
+   return AssertionSuccess();
+ }
+
+ template<class S, typename T>
+ static inline AssertionResult
+ IsMarked(S* section, const Local<T>& val){
+   return IsMarked(section, val.raw());
+ }
+
  static inline AssertionResult
  IsRemembered(RawObject* val){
    if(!val->IsRemembered())
@@ -174,6 +189,24 @@ namespace poseidon{
    return IsMarkedWord(ptr.raw(), value);
  }
 
+ template<class S>
+ static inline AssertionResult
+ IsMarkedWord(S* section, RawObject* ptr, word value){
+   if(!IsAllocated(ptr))
+     return IsAllocated(ptr);
+   if(!IsOld(ptr))
+     return IsOld(ptr);
+   if(!IsMarked(section, ptr))
+     return IsMarked(section, ptr);
+   return IsWord(ptr, value);
+ }
+
+ template<class S, class T>
+ static inline AssertionResult
+ IsMarkedWord(S* section, const Local<T>& ptr, word value){
+   return IsMarkedWord(section, ptr.raw(), value);
+ }
+
  static inline AssertionResult
  IsRememberedWord(RawObject* ptr, word value){
    if(!IsAllocated(ptr))
@@ -19,6 +19,9 @@ namespace poseidon{
    explicit MemoryRegionTest(int64_t size):
     Test(),
     region_(size){
+     // the region has to be usable before the fixtures create their zones, which write into it.
+     SetWriteable();
+     ClearRegion();
    }
 
    inline MemoryRegion* region(){
@@ -41,11 +44,6 @@ namespace poseidon{
    inline void ClearRegion(){
      return region()->ClearRegion();
    }
-
-   void SetUp() override{
-     SetWriteable();
-     ClearRegion();
-   }
   public:
    ~MemoryRegionTest() override = default;
  };
@@ -0,0 +1,48 @@
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gtest/gtest.h>
+
+#include "poseidon/platform/memory_region.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ TEST(HugePagesTest, TestTransparentHugePages){
+   MemoryRegion region(3 * kMB, MemoryRegion::kTransparentHugePages);
+   ASSERT_NE(region.GetStartingAddress(), 0);
+   ASSERT_TRUE(IsAligned(region.GetStartingAddress(), MemoryRegion::kHugePageSize));
+   ASSERT_EQ(region.size(), 2 * MemoryRegion::kHugePageSize);
+
+   ASSERT_TRUE(region.Commit());
+   memset(region.GetStartingAddressPointer(), 0xFF, region.size());
+   ASSERT_GE(region.GetHugePageBackedSize(), 0);
+   ASSERT_LE(region.GetHugePageBackedSize(), region.size());
+   region.FreeRegion();
+ }
+
+ TEST(HugePagesTest, TestHugeTLBPagesFallback){
+   // falls back to transparent huge pages when the system has no huge pages reserved.
+   MemoryRegion region(MemoryRegion::kHugePageSize, MemoryRegion::kHugeTLBPages);
+   ASSERT_NE(region.GetStartingAddress(), 0);
+   ASSERT_TRUE(IsAligned(region.GetStartingAddress(), MemoryRegion::kHugePageSize));
+   ASSERT_EQ(region.size(), MemoryRegion::kHugePageSize);
+   region.FreeRegion();
+ }
+
+#ifdef OS_IS_LINUX
+ TEST(MemoryRegionPopulateTest, TestPopulate){
+   static const int64_t kSystemPageSize = sysconf(_SC_PAGESIZE);
+   MemoryRegion region(16 * kSystemPageSize);
+   ASSERT_TRUE(region.Commit());
+   ASSERT_TRUE(region.Populate());
+
+   unsigned char resident[16];
+   ASSERT_EQ(mincore(region.GetStartingAddressPointer(), region.size(), resident), 0);
+   for(auto& page : resident)
+     ASSERT_NE(page & 1, 0);
+   // populating leaves the contents untouched.
+   ASSERT_EQ(*((word*)region.GetStartingAddress()), 0);
+   region.FreeRegion();
+ }
+#endif//OS_IS_LINUX
+}
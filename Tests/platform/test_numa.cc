@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "poseidon/platform/numa.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ TEST(NumaTopologyTest, TestParse){
+   NumaTopology topology;
+   ASSERT_TRUE(NumaTopology::Parse("0-3;4,6-7", &topology));
+   ASSERT_TRUE(topology.IsFake());
+   ASSERT_EQ(topology.GetNumberOfNodes(), 2);
+   ASSERT_EQ(topology.GetCpus(0), std::vector<int>({ 0, 1, 2, 3 }));
+   ASSERT_EQ(topology.GetCpus(1), std::vector<int>({ 4, 6, 7 }));
+   ASSERT_EQ(topology.GetNodeForCpu(2), 0);
+   ASSERT_EQ(topology.GetNodeForCpu(6), 1);
+   ASSERT_EQ(topology.GetNodeForCpu(5), kAnyNumaNode);
+ }
+
+ TEST(NumaTopologyTest, TestParseInvalid){
+   NumaTopology topology;
+   ASSERT_FALSE(NumaTopology::Parse("", &topology));
+   ASSERT_FALSE(NumaTopology::Parse("0-3;;4-7", &topology));
+   ASSERT_FALSE(NumaTopology::Parse("3-0", &topology));
+   ASSERT_FALSE(NumaTopology::Parse("a-b", &topology));
+   ASSERT_EQ(topology.GetNumberOfNodes(), 0);
+ }
+
+ TEST(NumaTopologyTest, TestGetNumaTopology){
+   auto& topology = GetNumaTopology();
+   ASSERT_GE(topology.GetNumberOfNodes(), 1);
+   ASSERT_GE(GetCurrentNumaNode(), 0);
+   ASSERT_LT(GetCurrentNumaNode(), topology.GetNumberOfNodes());
+ }
+}
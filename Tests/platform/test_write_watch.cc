@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "poseidon/platform/memory_region.h"
+#include "poseidon/platform/write_watch.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+#ifdef OS_IS_LINUX
+ class WriteWatchTest : public Test{
+  protected:
+   static constexpr const int64_t kNumberOfPages = 16;
+
+   MemoryRegion region_;
+   WriteWatch watch_;
+
+   WriteWatchTest():
+    Test(),
+    region_(kNumberOfPages * WriteWatch::GetPageSize()),
+    watch_(region_.GetStartingAddress(), region_.size()){
+   }
+
+   inline MemoryRegion* region(){
+     return &region_;
+   }
+
+   inline WriteWatch& watch(){
+     return watch_;
+   }
+
+   inline uword GetPageAddress(int64_t index) const{
+     return watch_.GetPageAddress(index);
+   }
+
+   void SetUp() override{
+     ASSERT_TRUE(region()->Commit());
+     ASSERT_TRUE(watch().Enable());
+   }
+
+   void TearDown() override{
+     ASSERT_TRUE(watch().Unprotect(region()->GetStartingAddress(), region()->size()));
+     watch().Disable();
+     region()->FreeRegion();
+   }
+  public:
+   ~WriteWatchTest() override = default;
+ };
+
+ TEST_F(WriteWatchTest, TestWriteFault){
+   ASSERT_TRUE(watch().Protect(region()->GetStartingAddress(), region()->size()));
+   ASSERT_EQ(watch().GetNumberOfDirtyPages(), 0);
+
+   // reads don't fault.
+   ASSERT_EQ(*((volatile uword*)GetPageAddress(5)), 0);
+   ASSERT_FALSE(watch().IsDirty((int64_t)5));
+
+   auto address = (volatile uword*)(GetPageAddress(3) + kWordSize);
+   (*address) = 42;
+   ASSERT_EQ(*address, 42);
+   ASSERT_TRUE(watch().IsDirty((int64_t)3));
+   ASSERT_EQ(watch().GetNumberOfDirtyPages(), 1);
+
+   // the page is writeable again, so the following stores are free.
+   (*(address + 1)) = 43;
+   ASSERT_EQ(watch().GetNumberOfDirtyPages(), 1);
+
+   // protecting the pages again forgets the dirty ones.
+   ASSERT_TRUE(watch().Protect(region()->GetStartingAddress(), region()->size()));
+   ASSERT_EQ(watch().GetNumberOfDirtyPages(), 0);
+   (*(volatile uword*)GetPageAddress(kNumberOfPages - 1)) = 44;
+   ASSERT_TRUE(watch().IsDirty((int64_t)(kNumberOfPages - 1)));
+   ASSERT_EQ(watch().GetNumberOfDirtyPages(), 1);
+ }
+
+ TEST_F(WriteWatchTest, TestUnprotect){
+   ASSERT_TRUE(watch().Protect(region()->GetStartingAddress(), region()->size()));
+   (*(volatile uword*)GetPageAddress(1)) = 42;
+   ASSERT_TRUE(watch().Unprotect(region()->GetStartingAddress(), region()->size()));
+
+   // writes to unprotected pages aren't recorded, the dirty pages stay dirty.
+   (*(volatile uword*)GetPageAddress(2)) = 43;
+   ASSERT_TRUE(watch().IsDirty((int64_t)1));
+   ASSERT_FALSE(watch().IsDirty((int64_t)2));
+
+   int64_t visited = 0;
+   watch().VisitDirtyPages(region()->GetStartingAddress(), region()->GetEndingAddress(), [&](uword start, uword end){
+     ASSERT_EQ(start, GetPageAddress(1));
+     ASSERT_EQ(end, GetPageAddress(2));
+     visited++;
+   });
+   ASSERT_EQ(visited, 1);
+ }
+#endif//OS_IS_LINUX
+}
@@ -1,8 +1,129 @@
+#include <thread>
+#include <algorithm>
+#include <vector>
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 
+#include "helpers.h"
+#include "memory_region_test.h"
 #include "poseidon/freelist.h"
 
 namespace poseidon{
  using namespace ::testing;
-}
\ No newline at end of file
+
+ class FreeListTest : public MemoryRegionTest{
+  protected:
+   static constexpr const int64_t kDefaultRegionSize = 1 * kMB;
+
+   FreeList free_list_;
+
+   inline FreeList* free_list(){
+     return &free_list_;
+   }
+
+   inline void Add(uword address, int64_t size){
+     return free_list()->Add(address, size);
+   }
+
+   inline bool IsEmpty(int64_t index){
+     return free_list()->bucket(index)->IsEmpty();
+   }
+  public:
+   FreeListTest():
+    MemoryRegionTest(kDefaultRegionSize),
+    free_list_(region()->GetStartingAddress(), kDefaultRegionSize){
+   }
+   ~FreeListTest() override = default;
+ };
+
+ TEST_F(FreeListTest, TestGetBucketIndexFor){
+   ASSERT_EQ(FreeList::GetBucketIndexFor(1), 0);
+   ASSERT_EQ(FreeList::GetBucketIndexFor(32), 5);
+   ASSERT_EQ(FreeList::GetBucketIndexFor(63), 5);
+   ASSERT_EQ(FreeList::GetFirstFitIndexFor(32), 5);
+   ASSERT_EQ(FreeList::GetFirstFitIndexFor(33), 6);
+ }
+
+ TEST_F(FreeListTest, TestTryAllocate){
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), kDefaultRegionSize);
+
+   int64_t allocated = 0;
+   auto address = free_list()->TryAllocate(kWordSize, &allocated);
+   ASSERT_EQ(address, region()->GetStartingAddress());
+   ASSERT_EQ(allocated, static_cast<int64_t>(sizeof(RawObject) + kWordSize));
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), kDefaultRegionSize - allocated);
+
+   auto next = free_list()->TryAllocate(kWordSize);
+   ASSERT_EQ(next, address + allocated);
+ }
+
+ TEST_F(FreeListTest, TestTryAllocateReusesFreedBlocks){
+   auto total_size = static_cast<int64_t>(sizeof(RawObject) + kWordSize);
+   auto address = free_list()->TryAllocate(kWordSize);
+   ASSERT_NE(address, 0);
+
+   Add(address, total_size);
+   ASSERT_FALSE(IsEmpty(FreeList::GetBucketIndexFor(total_size)));
+   ASSERT_EQ(free_list()->TryAllocate(kWordSize), address);
+ }
+
+ TEST_F(FreeListTest, TestAddWritesBlockInPlace){
+   auto total_size = static_cast<int64_t>(sizeof(RawObject) + kWordSize);
+   auto address = free_list()->TryAllocate(kWordSize);
+   ASSERT_NE(address, 0);
+
+   Add(address, total_size);
+   auto header = (RawObject*)address;
+   ASSERT_TRUE(header->IsFree());
+   ASSERT_EQ(header->GetTotalSize(), total_size);
+
+   auto found = false;
+   free_list()->VisitFreeList([&](FreeList::Node* node){
+     if(node->GetStartingAddress() != address)
+       return true;
+     found = node->GetSize() == total_size;
+     return false;
+   });
+   ASSERT_TRUE(found);
+ }
+
+ TEST_F(FreeListTest, TestTryAllocateExhausted){
+   ASSERT_EQ(free_list()->TryAllocate(kDefaultRegionSize), 0);
+   ASSERT_EQ(free_list()->GetTotalBytesFree(), kDefaultRegionSize);
+ }
+
+ TEST_F(FreeListTest, TestConcurrentTryAllocate){
+   static constexpr const int64_t kNumberOfThreads = 8;
+   static constexpr const int64_t kNumberOfRounds = 16;
+   // half of the region, every allocation splits the block another thread might be splitting.
+   static constexpr const int64_t kNumberOfAllocations = (kDefaultRegionSize / 2) / (kNumberOfThreads * static_cast<int64_t>(sizeof(RawObject) + kWordSize));
+
+   for(auto round = 0; round < kNumberOfRounds; round++){
+     free_list()->Clear();
+     Add(region()->GetStartingAddress(), kDefaultRegionSize);
+
+     std::vector<uword> addresses[kNumberOfThreads];
+     std::vector<std::thread> threads;
+     for(auto idx = 0; idx < kNumberOfThreads; idx++){
+       threads.emplace_back([this, &addresses, idx](){
+         for(auto count = 0; count < kNumberOfAllocations; count++){
+           // a miss can be spurious while other threads split the only block, there's enough free space to retry.
+           uword address;
+           while((address = free_list()->TryAllocate(kWordSize)) == 0)
+             std::this_thread::yield();
+           addresses[idx].push_back(address);
+         }
+       });
+     }
+     for(auto& thread : threads)
+       thread.join();
+
+     std::vector<uword> all;
+     for(auto& allocated : addresses)
+       all.insert(all.end(), allocated.begin(), allocated.end());
+     std::sort(all.begin(), all.end());
+     ASSERT_EQ(all.size(), kNumberOfThreads * kNumberOfAllocations);
+     ASSERT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end()) << "blocks were allocated twice.";
+   }
+ }
+}
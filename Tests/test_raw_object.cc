@@ -1,3 +1,4 @@
+#include <thread>
 #include <gtest/gtest.h>
 
 #include "helpers.h"
@@ -44,6 +45,22 @@ namespace poseidon{
    ASSERT_FALSE(tag.IsMarked());
  }
 
+ TEST_F(ObjectTagTest, TestMarkEpoch){
+   ObjectTag tag = ObjectTag::NewMarkedWithSize(kWordSize);
+   ASSERT_TRUE(tag.IsMarked());
+   MarkEpoch::Flip();
+   // the mark belongs to the previous epoch.
+   ASSERT_FALSE(tag.IsMarked());
+   tag.SetMarked();
+   ASSERT_TRUE(tag.IsMarked());
+   // the tags cycle, a dead object is swept long before its stale tag comes around again.
+   for(auto idx = 0; idx < MarkEpoch::kNumberOfTags; idx++){
+     MarkEpoch::Flip();
+     ASSERT_NE(MarkEpoch::GetTag(), MarkEpoch::kUnmarkedTag);
+   }
+   ASSERT_TRUE(tag.IsMarked());
+ }
+
  TEST_F(ObjectTagTest, TestRememberedBit){
    ObjectTag tag;
    ASSERT_FALSE(tag.IsRemembered());
@@ -192,4 +209,48 @@ namespace poseidon{
    ASSERT_TRUE(val.IsForwarding());
    ASSERT_EQ(val.GetForwardingAddress(), kTestForwardingAddress);
  }
-}
\ No newline at end of file
+
+ TEST_F(RawObjectTest, TestForwardingOverwritesTag){
+   static const constexpr uword kTestForwardingAddress = 0x47469920; // Warning: don't actually use this address for anything
+   ASSERT_EQ(sizeof(RawObject), kWordSize);
+
+   auto ptr = CreateNewWord(42);
+   ASSERT_TRUE(ptr->IsNew());
+   ASSERT_FALSE(ptr->IsForwarding());
+
+   ptr->SetForwardingAddress(kTestForwardingAddress);
+   ASSERT_TRUE(ptr->IsForwarding());
+   ASSERT_EQ(ptr->GetForwardingAddress(), kTestForwardingAddress);
+   ASSERT_EQ(ptr->raw_tag(), kInvalidObjectTag);
+   ASSERT_FALSE(ptr->IsNew());
+ }
+
+ TEST_F(RawObjectTest, TestSetterKeepsForwarding){
+   static const constexpr uword kTestForwardingAddress = 0x47469920; // Warning: don't actually use this address for anything
+
+   auto ptr = CreateNewWord(42);
+   ptr->SetForwardingAddress(kTestForwardingAddress);
+   ptr->SetRememberedBit();
+   ptr->SetAge(1);
+   ASSERT_TRUE(ptr->IsForwarding());
+   ASSERT_EQ(ptr->GetForwardingAddress(), kTestForwardingAddress);
+ }
+
+ TEST_F(RawObjectTest, TestConcurrentSetters){
+   static constexpr const int64_t kNumberOfRounds = 10000;
+
+   auto val = CreateNewRawObject(kWordSize);
+   for(auto round = 0; round < kNumberOfRounds; round++){
+     std::thread remember([val](){ val->SetRememberedBit(); });
+     std::thread mark([val](){ val->SetMarkedBit(); });
+     remember.join();
+     mark.join();
+     ASSERT_TRUE(val->IsRemembered());
+     ASSERT_TRUE(val->IsMarked());
+     ASSERT_TRUE(val->IsNew());
+     ASSERT_EQ(val->GetPointerSize(), kWordSize);
+     val->ClearRememberedBit();
+     val->ClearMarkedBit();
+   }
+ }
+}
@@ -0,0 +1,78 @@
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "poseidon/task_pool.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class CountingTask : public Task{
+  private:
+   TaskPool* pool_;
+   RelaxedAtomic<int64_t>* count_;
+   int64_t children_;
+  public:
+   CountingTask(TaskPool* pool, RelaxedAtomic<int64_t>* count, int64_t children = 0):
+    Task(),
+    pool_(pool),
+    count_(count),
+    children_(children){
+   }
+   ~CountingTask() override = default;
+
+   const char* name() const override{
+     return "CountingTask";
+   }
+
+   void Run() override{
+     // the children are submitted from the worker, so they go to its own queue & the other workers steal them.
+     for(auto idx = 0; idx < children_; idx++)
+       pool_->Submit(new CountingTask(pool_, count_));
+     (*count_) += 1;
+   }
+ };
+
+ static inline void
+ WaitFor(RelaxedAtomic<int64_t>& count, int64_t expected){
+   while((int64_t)count < expected)
+     std::this_thread::yield();
+ }
+
+ TEST(TaskPoolTest, TestSubmit){
+   static constexpr const int64_t kNumberOfTasks = 4096;
+   RelaxedAtomic<int64_t> count(0);
+   TaskPool pool(4);
+   pool.StartAll();
+   for(auto idx = 0; idx < kNumberOfTasks; idx++)
+     pool.Submit(new CountingTask(&pool, &count));
+   WaitFor(count, kNumberOfTasks);
+   ASSERT_EQ((int64_t)count, kNumberOfTasks);
+ }
+
+ TEST(TaskPoolTest, TestSubmitFromWorker){
+   static constexpr const int64_t kNumberOfTasks = 64;
+   static constexpr const int64_t kNumberOfChildren = 64;
+   RelaxedAtomic<int64_t> count(0);
+   TaskPool pool(4);
+   pool.StartAll();
+   for(auto idx = 0; idx < kNumberOfTasks; idx++)
+     pool.Submit(new CountingTask(&pool, &count, kNumberOfChildren));
+   WaitFor(count, kNumberOfTasks * (kNumberOfChildren + 1));
+   ASSERT_EQ((int64_t)count, kNumberOfTasks * (kNumberOfChildren + 1));
+ }
+
+ TEST(TaskPoolTest, TestParking){
+   static constexpr const int64_t kNumberOfWorkers = 2;
+   RelaxedAtomic<int64_t> count(0);
+   TaskPool pool(kNumberOfWorkers);
+   pool.StartAll();
+   // idle workers park instead of spinning, a submission wakes one of them.
+   while(pool.GetNumberOfParkedWorkers() < kNumberOfWorkers)
+     std::this_thread::yield();
+   pool.Submit(new CountingTask(&pool, &count));
+   WaitFor(count, 1);
+   while(pool.GetNumberOfParkedWorkers() < kNumberOfWorkers)
+     std::this_thread::yield();
+   ASSERT_EQ((int64_t)count, 1);
+ }
+}
@@ -0,0 +1,99 @@
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "poseidon/termination_barrier.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ TEST(TerminationBarrierTest, TestOfferTermination){
+   TerminationBarrier barrier(1);
+   ASSERT_TRUE(barrier.OfferTermination([](){ return false; }));
+   ASSERT_TRUE(barrier.IsTerminated());
+ }
+
+ TEST(TerminationBarrierTest, TestRetract){
+   TerminationBarrier barrier(2);
+   // the other thread hasn't offered, so the work it pushed is picked up again.
+   ASSERT_FALSE(barrier.OfferTermination([](){ return true; }));
+   ASSERT_EQ(barrier.GetNumberOfOffers(), 0);
+   ASSERT_FALSE(barrier.IsTerminated());
+ }
+
+ TEST(TerminationBarrierTest, TestBackoff){
+   static constexpr const int64_t kNumberOfThreads = 2;
+   TerminationBarrier barrier(kNumberOfThreads);
+   // the late thread offers once the first one went from spinning to sleeping.
+   std::thread late([&](){
+     while(barrier.sleeps() == 0)
+       std::this_thread::yield();
+     ASSERT_TRUE(barrier.OfferTermination([](){ return false; }));
+   });
+   ASSERT_TRUE(barrier.OfferTermination([](){ return false; }));
+   late.join();
+   ASSERT_EQ(barrier.spins(), TerminationBarrier::kSpinIterations);
+   ASSERT_EQ(barrier.yields(), TerminationBarrier::kYieldIterations);
+   ASSERT_GT(barrier.sleeps(), 0);
+ }
+
+ TEST(TerminationBarrierTest, TestWorkers){
+   static constexpr const int64_t kNumberOfThreads = 4;
+   static constexpr const int64_t kNumberOfItems = 4096;
+   TerminationBarrier barrier(kNumberOfThreads);
+   // every item processed creates two more until enough were created, only a working thread creates items.
+   RelaxedAtomic<int64_t> pending(1);
+   RelaxedAtomic<int64_t> created(1);
+   RelaxedAtomic<int64_t> processed(0);
+   auto take = [&](){
+     auto next = pending.load(std::memory_order_acquire);
+     while(next > 0){
+       if(pending.compare_exchange_strong(next, next - 1, std::memory_order_acq_rel, std::memory_order_acquire))
+         return true;
+     }
+     return false;
+   };
+
+   std::vector<std::thread> threads;
+   for(auto idx = 0; idx < kNumberOfThreads; idx++){
+     threads.emplace_back([&](){
+       do{
+         while(take()){
+           processed += 1;
+           if(created.fetch_add(2) < kNumberOfItems){
+             pending.fetch_add(2, std::memory_order_release);
+           } else{
+             created -= 2;
+           }
+         }
+       } while(!barrier.OfferTermination([&](){ return pending.load(std::memory_order_acquire) > 0; }));
+     });
+   }
+   for(auto& thread : threads)
+     thread.join();
+
+   ASSERT_TRUE(barrier.IsTerminated());
+   ASSERT_EQ((int64_t)pending, 0);
+   ASSERT_EQ((int64_t)processed, (int64_t)created);
+ }
+
+ TEST(TerminationBarrierTest, TestWaitForExit){
+   static constexpr const int64_t kNumberOfThreads = 4;
+   auto barrier = new TerminationBarrier(kNumberOfThreads);
+   std::vector<std::thread> threads;
+   for(auto idx = 0; idx < (kNumberOfThreads - 1); idx++){
+     threads.emplace_back([barrier](){
+       ASSERT_TRUE(barrier->OfferTermination([](){ return false; }));
+       barrier->Exit();
+     });
+   }
+   ASSERT_TRUE(barrier->OfferTermination([](){ return false; }));
+   barrier->Exit();
+   // the other threads can still be backing off, they're done w/ the barrier once they exited.
+   barrier->WaitForExit();
+   ASSERT_TRUE(barrier->HasExited());
+   delete barrier;
+   for(auto& thread : threads)
+     thread.join();
+ }
+}
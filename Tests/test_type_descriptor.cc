@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "helpers.h"
+#include "poseidon/raw_object.h"
+#include "poseidon/type_descriptor.h"
+
+namespace poseidon{
+ struct TestPair{
+   uword first;
+   word value;
+   uword second;
+ };
+}
+
+PSDN_POINTER_MAP(poseidon::TestPair, offsetof(poseidon::TestPair, first), offsetof(poseidon::TestPair, second));
+
+namespace poseidon{
+ using namespace ::testing;
+
+ class TypeDescriptorTest : public Test{
+  public:
+   TypeDescriptorTest() = default;
+   ~TypeDescriptorTest() override = default;
+ };
+
+ TEST_F(TypeDescriptorTest, TestOfWord){
+   ASSERT_EQ(TypeDescriptor::Of<word>(), nullptr);
+   ASSERT_EQ(TypeDescriptor::GetClassIdOf<word>(), kInvalidClassId);
+   ASSERT_EQ(TypeDescriptor::Get(kInvalidClassId), nullptr);
+ }
+
+ TEST_F(TypeDescriptorTest, TestOf){
+   auto type = TypeDescriptor::Of<TestPair>();
+   ASSERT_NE(type, nullptr);
+   ASSERT_NE(type->GetClassId(), kInvalidClassId);
+   ASSERT_EQ(type, TypeDescriptor::Of<TestPair>());
+   ASSERT_EQ(type, TypeDescriptor::Get(type->GetClassId()));
+   ASSERT_EQ(type->GetSize(), sizeof(TestPair));
+   ASSERT_EQ(type->GetNumberOfPointers(), 2);
+   ASSERT_EQ(type->GetPointerOffset(0), offsetof(TestPair, first));
+   ASSERT_EQ(type->GetPointerOffset(1), offsetof(TestPair, second));
+ }
+
+ TEST_F(TypeDescriptorTest, TestVisitPointers){
+   static constexpr const int64_t kTestObjectSize = sizeof(RawObject) + sizeof(TestPair);
+   uword data[kTestObjectSize / kWordSize] = {};
+   auto ptr = new (data)RawObject();
+   ptr->SetPointerSize(sizeof(TestPair));
+   // an object w/o a type has no references.
+   ASSERT_EQ(ptr->VisitPointers([](uword* slot){
+     ADD_FAILURE() << "visited " << ((void*)slot) << " of an object w/o a type.";
+     return true;
+   }), 0);
+
+   ptr->SetClassId(TypeDescriptor::GetClassIdOf<TestPair>());
+   ASSERT_EQ(ptr->GetTypeDescriptor(), TypeDescriptor::Of<TestPair>());
+   ASSERT_EQ(RawObject::FromPointer(ptr->GetObjectPointerAddress()), ptr);
+
+   auto pair = (TestPair*)ptr->GetPointer();
+   pair->value = 42;
+   pair->second = 0x1000;
+
+   // null fields are skipped.
+   std::vector<uword*> slots;
+   ASSERT_EQ(ptr->VisitPointers([&](uword* slot){
+     slots.push_back(slot);
+     return true;
+   }), 1);
+   ASSERT_EQ(slots.size(), 1);
+   ASSERT_EQ(slots[0], &pair->second);
+ }
+}
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include "poseidon/wsq.h"
+
+namespace poseidon{
+ using namespace ::testing;
+
+ TEST(PartitionedWorkStealingQueueTest, TestStealPrefersPartition){
+   PartitionedWorkStealingQueue<uword> queue(2, 16);
+   queue.Push(0, 1);
+   queue.Push(1, 2);
+   queue.Push(1, 3);
+   ASSERT_EQ(queue.size(), 3);
+
+   ASSERT_EQ(queue.Steal(1), 2);
+   ASSERT_EQ(queue.Steal(1), 3);
+   // the preferred partition is drained, so the next one is stolen from.
+   ASSERT_EQ(queue.Steal(1), 1);
+   ASSERT_EQ(queue.Steal(1), 0);
+   ASSERT_TRUE(queue.empty());
+ }
+
+ TEST(PartitionedWorkStealingQueueTest, TestAnyPartition){
+   PartitionedWorkStealingQueue<uword> queue(1, 16);
+   queue.Push(-1, 1);
+   queue.Push(3, 2);
+   ASSERT_EQ(queue.partition(0)->size(), 2);
+   ASSERT_EQ(queue.Steal(-1), 1);
+   ASSERT_EQ(queue.Steal(5), 2);
+ }
+}